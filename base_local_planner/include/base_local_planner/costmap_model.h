@@ -38,6 +38,7 @@
 #define TRAJECTORY_ROLLOUT_COSTMAP_MODEL_
 
 #include <base_local_planner/world_model.h>
+#include <base_local_planner/footprint_cost_cache.h>
 // For obstacle data access
 #include <costmap_2d/costmap_2d.h>
 
@@ -46,6 +47,8 @@ namespace base_local_planner {
    * @class CostmapModel
    * @brief A class that implements the WorldModel interface to provide grid
    * based collision checks for the trajectory controller using the costmap.
+   * Footprint costs at a pose are cached per revision of the costmap, in a cache
+   * all models of the same costmap share.
    */
   class CostmapModel : public WorldModel {
     public:
@@ -73,6 +76,13 @@ namespace base_local_planner {
       virtual double footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
           double inscribed_radius, double circumscribed_radius);
 
+      /**
+       * @brief  Checks a footprint given in the robot frame at a pose, answering from the shared
+       * cache if the pose was checked against the current revision of the costmap before
+       */
+      virtual double footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+          double inscribed_radius = 0.0, double circumscribed_radius = 0.0);
+
     private:
       /**
        * @brief  Rasterizes a line in the costmap grid and checks for collisions
@@ -93,6 +103,7 @@ namespace base_local_planner {
       double pointCost(int x, int y);
 
       const costmap_2d::Costmap2D& costmap_; ///< @brief Allows access of costmap obstacle information
+      boost::shared_ptr<FootprintCostCache> cache_; ///< @brief Footprint costs shared with the other models of the costmap
 
   };
 };
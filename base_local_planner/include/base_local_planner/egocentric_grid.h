@@ -0,0 +1,177 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef EGOCENTRIC_GRID_H_
+#define EGOCENTRIC_GRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+
+namespace base_local_planner {
+
+/**
+ * @class EgocentricGrid
+ * @brief A square window around the robot, resampled from a grid laid out like the costmap
+ * so that its axes follow the robot heading. It is resampled once per planning cycle; after
+ * that a point relative to the robot is found with a division and an integer index, instead
+ * of a transform into the world and a conversion to costmap cells.
+ *
+ * With resample each cell takes the value of the costmap cell its center falls into (nearest
+ * neighbour), so along edges a value can be off by one costmap cell compared to a direct
+ * lookup. resampleMax takes the largest value of the costmap cells a cell overlaps instead,
+ * so that under rotation no lethal cell can fall between the cell centers.
+ */
+template <typename T>
+class EgocentricGrid {
+public:
+  EgocentricGrid() : half_size_(0), size_(0), resolution_(1.0),
+      x_(0.0), y_(0.0), th_(0.0), cos_th_(1.0), sin_th_(0.0) {}
+
+  /**
+   * @brief  Resample the window around a robot pose
+   * @param costmap Gives the layout of the grid that is resampled
+   * @param x The x position of the robot in the frame of the costmap
+   * @param y The y position of the robot in the frame of the costmap
+   * @param th The heading of the robot
+   * @param reach How far the window extends from the robot along each of its axes
+   * @param value Returns the value of a cell (mx, my) of the resampled grid
+   * @param outside The value of cells that fall outside the costmap
+   */
+  template <class CellValue>
+  void resample(const costmap_2d::Costmap2D& costmap, double x, double y, double th, double reach,
+      CellValue value, T outside) {
+    walk(costmap, x, y, th, reach, value, outside, false);
+  }
+
+  /**
+   * @brief  Resample the window around a robot pose, each cell taking the largest value of
+   * the costmap cells it overlaps. Cells that overlap the outside of the costmap get outside.
+   * The parameters are the same as for resample.
+   */
+  template <class CellValue>
+  void resampleMax(const costmap_2d::Costmap2D& costmap, double x, double y, double th, double reach,
+      CellValue value, T outside) {
+    walk(costmap, x, y, th, reach, value, outside, true);
+  }
+
+  /**
+   * @brief  Express a world position relative to the robot pose the grid was resampled for
+   */
+  void worldToRobot(double wx, double wy, double& rx, double& ry) const {
+    double dx = wx - x_;
+    double dy = wy - y_;
+    rx = cos_th_ * dx + sin_th_ * dy;
+    ry = cos_th_ * dy - sin_th_ * dx;
+  }
+
+  /**
+   * @brief  The cell of a position relative to the robot
+   * @return False if the position lies outside the window
+   */
+  bool robotToCell(double rx, double ry, int& cx, int& cy) const {
+    cx = int(std::floor(rx / resolution_)) + half_size_;
+    cy = int(std::floor(ry / resolution_)) + half_size_;
+    return cx >= 0 && cy >= 0 && cx < size_ && cy < size_;
+  }
+
+  T operator()(int cx, int cy) const {
+    return cells_[cy * size_ + cx];
+  }
+
+  double getTheta() const { return th_; }
+
+  int getSize() const { return size_; }
+
+private:
+  template <class CellValue>
+  void walk(const costmap_2d::Costmap2D& costmap, double x, double y, double th, double reach,
+      CellValue value, T outside, bool take_max) {
+    x_ = x;
+    y_ = y;
+    th_ = th;
+    cos_th_ = cos(th);
+    sin_th_ = sin(th);
+    resolution_ = costmap.getResolution();
+    half_size_ = std::max(1, int(std::ceil(reach / resolution_)));
+    size_ = 2 * half_size_;
+    cells_.resize(size_ * size_);
+
+    // half the extent of a rotated cell along the costmap axes, shrunk a little so an
+    // unrotated cell does not reach into its neighbours
+    double extent = take_max ? (fabs(cos_th_) + fabs(sin_th_)) / 2 - 1e-6 : 0.0;
+
+    // walk the cell centers in costmap cells, both grids share the resolution so one step
+    // along a robot axis is a unit vector in the costmap
+    int size_x = costmap.getSizeInCellsX();
+    int size_y = costmap.getSizeInCellsY();
+    double start = 0.5 - half_size_;
+    double row_x = (x - costmap.getOriginX()) / resolution_ + (cos_th_ - sin_th_) * start;
+    double row_y = (y - costmap.getOriginY()) / resolution_ + (sin_th_ + cos_th_) * start;
+    for (int cy = 0; cy < size_; ++cy) {
+      double fx = row_x;
+      double fy = row_y;
+      T* row = &cells_[cy * size_];
+      for (int cx = 0; cx < size_; ++cx) {
+        int min_x = int(std::floor(fx - extent)), max_x = int(std::floor(fx + extent));
+        int min_y = int(std::floor(fy - extent)), max_y = int(std::floor(fy + extent));
+        if (min_x < 0 || min_y < 0 || max_x >= size_x || max_y >= size_y) {
+          row[cx] = outside;
+        } else {
+          T cell = value(min_x, min_y);
+          for (int my = min_y; my <= max_y; ++my) {
+            for (int mx = min_x; mx <= max_x; ++mx) {
+              cell = std::max(cell, T(value(mx, my)));
+            }
+          }
+          row[cx] = cell;
+        }
+        fx += cos_th_;
+        fy += sin_th_;
+      }
+      row_x -= sin_th_;
+      row_y += cos_th_;
+    }
+  }
+
+  int half_size_, size_;
+  double resolution_;
+  double x_, y_, th_, cos_th_, sin_th_;
+  std::vector<T> cells_;
+};
+
+} /* namespace base_local_planner */
+#endif /* EGOCENTRIC_GRID_H_ */
@@ -0,0 +1,130 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef FOOTPRINT_COST_CACHE_H_
+#define FOOTPRINT_COST_CACHE_H_
+
+#include <list>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <geometry_msgs/Point.h>
+#include <costmap_2d/costmap_2d.h>
+
+namespace base_local_planner {
+
+/**
+ * @class FootprintCostCache
+ * @brief Remembers footprint costs computed against one revision of a costmap, so that the
+ * same pose checked again by the local planner, a recovery behavior or the carrot planner
+ * costs a hash lookup instead of another rasterization of the footprint.
+ *
+ * Poses are quantized to xy_quantum meters and theta_quantum radians, and together with the
+ * footprint they were checked for (compared by value) form the key. All entries are dropped as soon as a query
+ * comes in for another revision of the costmap, and the least recently used entry makes room
+ * once the cache is full. All methods may be called from different threads.
+ */
+class FootprintCostCache {
+public:
+  FootprintCostCache(unsigned int capacity = 4096, double xy_quantum = 0.005, double theta_quantum = 0.002);
+
+  /**
+   * @brief  The cache shared by everyone checking footprints against the given costmap,
+   * created on first use and released with the last user
+   */
+  static boost::shared_ptr<FootprintCostCache> forCostmap(const costmap_2d::Costmap2D& costmap);
+
+  /**
+   * @brief  Look up the cost of a footprint at a pose
+   * @param  revision The revision of the costmap the cost has to be valid for
+   * @return True and the cost in cost if the pose was checked at this revision before
+   */
+  bool lookup(uint64_t revision, double x, double y, double theta,
+      const std::vector<geometry_msgs::Point>& footprint_spec, double& cost);
+
+  /**
+   * @brief  Remember the cost of a footprint at a pose, computed at the given revision
+   */
+  void insert(uint64_t revision, double x, double y, double theta,
+      const std::vector<geometry_msgs::Point>& footprint_spec, double cost);
+
+  void clear();
+
+  unsigned int size() const;
+
+  /**
+   * @brief  Number of lookups that found a cost since the cache was created
+   */
+  unsigned long getHits() const;
+
+private:
+  struct Key {
+    int64_t x, y, theta;
+    unsigned int footprint;  // index into footprints_
+
+    bool operator==(const Key& other) const {
+      return x == other.x && y == other.y && theta == other.theta && footprint == other.footprint;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  typedef std::list<std::pair<Key, double> > Entries;
+
+  // the caller holds the mutex, returns false if the footprint is unknown and add is false
+  bool makeKey(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+      bool add, Key& key);
+
+  // drops everything computed for an older revision, the caller holds the mutex
+  void setRevision(uint64_t revision);
+
+  unsigned int capacity_;
+  double xy_quantum_, theta_quantum_;
+
+  uint64_t revision_;
+  std::vector<std::vector<geometry_msgs::Point> > footprints_;  // the footprints the keys refer to
+  Entries entries_;  // most recently used first
+  boost::unordered_map<Key, Entries::iterator, KeyHash> index_;
+  unsigned long hits_;
+
+  mutable boost::mutex mutex_;
+};
+
+} /* namespace base_local_planner */
+#endif /* FOOTPRINT_COST_CACHE_H_ */
@@ -75,6 +75,8 @@ private:
   LocalPlannerLimits limits_;
   bool initialized_;
 
+  boost::shared_ptr<const nav_core::SpeedLimit> speed_limit_;
+
 public:
 
   /**
@@ -99,8 +101,18 @@ public:
 
   costmap_2d::Costmap2D* getCostmap();
 
+  /**
+   * @brief  The configured limits, with max_trans_vel and max_rot_vel capped by the speed limit if one is set
+   */
   LocalPlannerLimits getCurrentLimits();
 
+  /**
+   * @brief  Speed limit to apply on top of the configured limits, read on every getCurrentLimits() call
+   */
+  void setSpeedLimit(const boost::shared_ptr<const nav_core::SpeedLimit>& speed_limit) {
+    speed_limit_ = speed_limit;
+  }
+
   std::string getGlobalFrame(){ return global_frame_; }
 };
 
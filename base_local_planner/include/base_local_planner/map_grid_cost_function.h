@@ -42,6 +42,7 @@
 
 #include <costmap_2d/costmap_2d.h>
 #include <base_local_planner/map_grid.h>
+#include <base_local_planner/egocentric_grid.h>
 
 namespace base_local_planner {
 
@@ -82,19 +83,40 @@ public:
 
   /**
    * set line segments on the grid with distance 0, resets the grid
+   * on the next prepare unless the target positions did not change
    */
-  void setTargetPoses(std::vector<geometry_msgs::PoseStamped> target_poses);
+  void setTargetPoses(const std::vector<geometry_msgs::PoseStamped>& target_poses);
 
   void setXShift(double xshift) {xshift_ = xshift;}
   void setYShift(double yshift) {yshift_ = yshift;}
 
+  /**
+   * Look the distances up in a copy of the grid around the robot that follows the robot
+   * heading, resampled in prepare. Points further than reach from the pose given to
+   * setRobotPose are still looked up in the full grid.
+   */
+  void setEgocentric(bool egocentric, double reach = 0.0) {
+    egocentric_ = egocentric;
+    reach_ = reach;
+  }
+
+  /**
+   * The pose the trajectories of the next run start from, used by the egocentric mode
+   */
+  void setRobotPose(double x, double y, double th) {
+    robot_x_ = x;
+    robot_y_ = y;
+    robot_th_ = th;
+  }
+
   /** @brief If true, failures along the path cause the entire path to be rejected.
    *
    * Default is true. */
   void setStopOnFailure(bool stop_on_failure) {stop_on_failure_ = stop_on_failure;}
 
   /**
-   * propagate distances
+   * propagate distances, skipped when neither the target poses nor the
+   * costmap changed since the last propagation
    */
   bool prepare();
 
@@ -133,6 +155,15 @@ private:
   // if true, we look for a suitable local goal on path, else we use the full path for costs
   bool is_local_goal_function_;
   bool stop_on_failure_;
+  // whether map_ holds the distances for target_poses_ on costmap revision prepared_revision_
+  bool prepared_;
+  uint64_t prepared_revision_;
+
+  bool egocentric_;
+  double reach_;
+  double robot_x_, robot_y_, robot_th_;
+  // distances around the robot, negative outside the costmap
+  EgocentricGrid<double> egocentric_grid_;
 };
 
 } /* namespace base_local_planner */
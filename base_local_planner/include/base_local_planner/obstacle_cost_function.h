@@ -41,7 +41,9 @@
 #include <base_local_planner/trajectory_cost_function.h>
 
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/egocentric_grid.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/speed_limit_grid.h>
 
 namespace base_local_planner {
 
@@ -64,6 +66,35 @@ public:
   void setParams(double max_trans_vel, double max_scaling_factor, double scaling_speed);
   void setFootprint(std::vector<geometry_msgs::Point> footprint_spec);
 
+  /**
+   * @brief Reject trajectories that are faster than the speed limit of a cell they pass.
+   * The grid has to be laid out like the costmap, it is looked up with the same cells
+   * as the costs. Pass NULL to ignore speed limits.
+   */
+  void setSpeedLimitGrid(const costmap_2d::SpeedLimitGrid* speed_limits) { speed_limits_ = speed_limits; }
+
+  /**
+   * @brief Score footprints in a copy of the costmap around the robot that follows the robot
+   * heading, resampled in prepare, instead of in the costmap. Points further than reach from
+   * the pose given to setRobotPose are still checked in the costmap.
+   * Each grid cell holds the highest cost of the up to 3x3 costmap cells it overlaps, so the
+   * check of the footprint center is more conservative than in the costmap: a center next to
+   * an inscribed cell is rejected as a collision as well.
+   */
+  void setEgocentric(bool egocentric, double reach = 0.0) {
+    egocentric_ = egocentric;
+    reach_ = reach;
+  }
+
+  /**
+   * @brief The pose the trajectories of the next run start from, used by the egocentric mode
+   */
+  void setRobotPose(double x, double y, double th) {
+    robot_x_ = x;
+    robot_y_ = y;
+    robot_th_ = th;
+  }
+
   // helper functions, made static for easy unit testing
   static double getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor);
   static double footprintCost(
@@ -76,13 +107,26 @@ public:
       base_local_planner::WorldModel* world_model);
 
 private:
+  // cells of the egocentric grid that lie outside the costmap
+  static const int OFF_MAP = -1;
+
+  bool egocentricFootprintCost(double x, double y, double th, double& cost) const;
+
   costmap_2d::Costmap2D* costmap_;
   std::vector<geometry_msgs::Point> footprint_spec_;
   base_local_planner::WorldModel* world_model_;
+  const costmap_2d::SpeedLimitGrid* speed_limits_;
+  costmap_2d::SpeedLimitSnapshot speed_snapshot_;
+  bool check_speed_limits_;
   double max_trans_vel_;
   bool sum_scores_;
   //footprint scaling with velocity;
   double max_scaling_factor_, scaling_speed_;
+
+  bool egocentric_;
+  double reach_;
+  double robot_x_, robot_y_, robot_th_;
+  EgocentricGrid<int> egocentric_grid_;
 };
 
 } /* namespace base_local_planner */
@@ -45,6 +45,12 @@
 
 namespace base_local_planner {
 
+/** @brief The part of an Odometry message the planners use. */
+struct OdometrySnapshot {
+  double vx, vy, vth; ///< velocities of the base, in the frame of the base
+  ros::Time stamp;
+};
+
 class OdometryHelperRos {
 public:
 
@@ -61,10 +67,38 @@ public:
    */
   void odomCallback(const nav_msgs::Odometry::ConstPtr& msg);
 
+  /**
+   * @brief  Fills in the twist of base_odom with the latest odometry velocities
+   */
   void getOdom(nav_msgs::Odometry& base_odom);
 
+  /**
+   * @brief  Fills in robot_vel with the odometry velocities, averaged over the window set
+   * with setAverageWindow if there is one
+   */
   void getRobotVel(tf::Stamped<tf::Pose>& robot_vel);
 
+  /**
+   * @brief  Make getRobotVel average the odometry over a window instead of returning the
+   * latest message, which smooths noisy wheel odometry before it seeds the velocity window
+   * @param window The length of the window in seconds, 0 to use the latest message
+   */
+  void setAverageWindow(double window) { average_window_ = window; }
+
+  /**
+   * @brief  Returns the latest odometry velocities
+   * @return False if no odometry has been received yet
+   */
+  bool getSnapshot(OdometrySnapshot& snapshot) const;
+
+  /**
+   * @brief  Averages the velocities of the odometry messages received within a time window
+   * @param window The length of the window in seconds, ending at the latest message
+   * @param average Filled with the mean velocities and the stamp of the latest message
+   * @return False if no odometry has been received yet
+   */
+  bool getAverageVelocity(double window, OdometrySnapshot& average) const;
+
   /** @brief Set the odometry topic.  This overrides what was set in the constructor, if anything.
    *
    * This unsubscribes from the old topic (if any) and subscribes to the new one (if any).
@@ -76,13 +110,28 @@ public:
   std::string getOdomTopic() const { return odom_topic_; }
 
 private:
+  /** @brief Number of odometry messages kept for getAverageVelocity */
+  static const unsigned int HISTORY_SIZE = 32;
+
+  /**
+   * @brief  Copies the history under the lock
+   * @return The number of valid entries, the newest at index head
+   */
+  unsigned int readHistory(OdometrySnapshot* history, unsigned int& head) const;
+
   //odom topic
   std::string odom_topic_;
 
   // we listen on odometry on the odom topic
   ros::Subscriber odom_sub_;
-  nav_msgs::Odometry base_odom_;
-  boost::mutex odom_mutex_;
+
+  // Written only by odomCallback; readers copy the few entries they need, so the lock is short.
+  mutable boost::mutex odom_mutex_;
+  OdometrySnapshot history_[HISTORY_SIZE];
+  unsigned int history_head_, history_count_;
+
+  double average_window_;
+
   // global tf frame id
   std::string frame_id_; ///< The frame_id associated this data
 };
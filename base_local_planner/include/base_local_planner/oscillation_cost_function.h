@@ -39,10 +39,17 @@
 #define OSCILLATION_COST_FUNCTION_H_
 
 #include <base_local_planner/trajectory_cost_function.h>
+#include <base_local_planner/oscillation_history.h>
 #include <Eigen/Core>
 
 namespace base_local_planner {
 
+/**
+ * @class OscillationCostFunction
+ * @brief Rejects trajectories that reverse a direction the robot recently gave up on.
+ * The bookkeeping lives in an OscillationHistory, which trajectory generators can
+ * also use to skip such samples before rolling them out.
+ */
 class OscillationCostFunction: public base_local_planner::TrajectoryCostFunction {
 public:
   OscillationCostFunction();
@@ -62,27 +69,10 @@ public:
 
   void setOscillationResetDist(double dist, double angle);
 
-private:
-
-  void resetOscillationFlagsIfPossible(const Eigen::Vector3f& pos, const Eigen::Vector3f& prev);
-
-  /**
-   * @brief  Given a trajectory that's selected, set flags if needed to
-   * prevent the robot from oscillating
-   * @param  t The selected trajectory
-   * @return True if a flag was set, false otherwise
-   */
-  bool setOscillationFlags(base_local_planner::Trajectory* t, double min_vel_trans);
-
-  // flags
-  bool strafe_pos_only_, strafe_neg_only_, strafing_pos_, strafing_neg_;
-  bool rot_pos_only_, rot_neg_only_, rotating_pos_, rotating_neg_;
-  bool forward_pos_only_, forward_neg_only_, forward_pos_, forward_neg_;
+  const OscillationHistory& getHistory() const { return history_; }
 
-  // param
-  double oscillation_reset_dist_, oscillation_reset_angle_;
-
-  Eigen::Vector3f prev_stationary_pos_;
+private:
+  OscillationHistory history_;
 };
 
 } /* namespace base_local_planner */
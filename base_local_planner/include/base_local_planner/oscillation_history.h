@@ -0,0 +1,138 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef OSCILLATION_HISTORY_H_
+#define OSCILLATION_HISTORY_H_
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace base_local_planner {
+
+/**
+ * @class OscillationHistory
+ * @brief A fixed size ring of recently commanded velocities and the poses they were
+ * commanded at, with the per-axis statistics needed to detect oscillation kept up to
+ * date incrementally, so that every query is O(1).
+ *
+ * Whenever the commanded direction on an axis (x, y or theta) flips sign the axis gets
+ * restricted to the new direction until the robot moves oscillation_reset_dist or turns
+ * oscillation_reset_angle away from where the flip happened. Strafing and rotation are
+ * only tracked while the robot is not translating forward faster than min_vel_trans.
+ */
+class OscillationHistory {
+public:
+  OscillationHistory(unsigned int capacity = 32);
+
+  void setResetDistance(double dist, double angle);
+
+  /**
+   * @brief  Forget all samples, directions and restrictions
+   */
+  void clear();
+
+  /**
+   * @brief  Drop the current restrictions and the remembered directions they came from
+   */
+  void resetRestrictions();
+
+  /**
+   * @brief  Record a velocity command
+   * @param pos The pose of the robot when the command was chosen
+   * @param vel The commanded velocity
+   * @param min_vel_trans Forward speed at or below which strafing and rotation are tracked
+   */
+  void push(const Eigen::Vector3f& pos, const Eigen::Vector3f& vel, double min_vel_trans = 0.0);
+
+  /**
+   * @brief  Whether a velocity sample goes against a current restriction,
+   * cheap enough to call on every sample before it is rolled out
+   */
+  bool isAllowed(const Eigen::Vector3f& vel) const {
+    return restricted_axes_ == 0 ||
+        (axisAllowed(0, vel[0]) && axisAllowed(1, vel[1]) && axisAllowed(2, vel[2]));
+  }
+
+  bool hasRestrictions() const { return restricted_axes_ != 0; }
+
+  /**
+   * @brief  Number of direction flips on an axis among the samples still in the ring
+   */
+  unsigned int reversals(unsigned int axis) const { return reversal_count_[axis]; }
+
+  unsigned int size() const { return count_; }
+
+  /**
+   * @brief  Remember a pose to measure progress from, see progressDistance
+   */
+  void setProgressPose(const Eigen::Vector3f& pos) { progress_pose_ = pos; }
+
+  /**
+   * @brief  Straight line distance between pos and the pose last given to setProgressPose
+   */
+  double progressDistance(const Eigen::Vector3f& pos) const;
+
+private:
+  enum {
+    POSITIVE_ONLY = 1,
+    NEGATIVE_ONLY = 2
+  };
+
+  struct Sample {
+    Eigen::Vector3f pos;
+    Eigen::Vector3f vel;
+    unsigned char reversed;  // one bit per axis that flipped direction with this sample
+  };
+
+  bool axisAllowed(unsigned int axis, float v) const {
+    return !((restriction_[axis] & POSITIVE_ONLY) && v < 0.0) &&
+        !((restriction_[axis] & NEGATIVE_ONLY) && v > 0.0);
+  }
+
+  std::vector<Sample> samples_;
+  unsigned int head_, count_;
+  unsigned int reversal_count_[3];
+
+  int direction_[3];
+  unsigned char restriction_[3];
+  unsigned char restricted_axes_;
+  Eigen::Vector3f restriction_pose_;
+
+  double reset_dist_, reset_angle_;
+  Eigen::Vector3f progress_pose_;
+};
+
+} /* namespace base_local_planner */
+#endif /* OSCILLATION_HISTORY_H_ */
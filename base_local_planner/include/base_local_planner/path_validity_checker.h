@@ -0,0 +1,133 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef PATH_VALIDITY_CHECKER_H_
+#define PATH_VALIDITY_CHECKER_H_
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <geometry_msgs/PoseStamped.h>
+#include <costmap_2d/costmap_2d.h>
+
+namespace base_local_planner {
+
+/**
+ * @class PathValidityChecker
+ * @brief Keeps the cells of a global plan indexed against a costmap so that, after each
+ * costmap update, only the part of the plan inside the updated bounds has to be checked
+ * for new blockages.
+ *
+ * Plan poses are grouped into segments of consecutive poses with a cell bounding box each;
+ * a check skips every segment whose box misses the window, and everything behind the robot.
+ * A pose is blocked when the cost of its cell is at least the blocking cost, which by
+ * default is the inscribed cost the global planners avoid. Unknown cells never block.
+ *
+ * Only the cell under each pose is checked, not the footprint around it. That is the test the
+ * global planners apply to an inflated costmap, so it finds what would make the planner route
+ * differently, but a pose of a non-circular robot can pass while its footprint overlaps a lethal
+ * cell; the local planner still checks the footprint before moving there.
+ * All methods may be called from different threads.
+ */
+class PathValidityChecker {
+public:
+  PathValidityChecker(unsigned int segment_size = 32);
+
+  void setBlockingCost(unsigned char cost);
+
+  /**
+   * @brief  Index a new plan, its poses have to be in the frame of the costmap
+   */
+  void setPlan(const std::vector<geometry_msgs::PoseStamped>& plan, const costmap_2d::Costmap2D& costmap);
+
+  void clear();
+
+  bool hasPlan() const;
+
+  /**
+   * @brief  Stop checking the part of the plan the robot has passed, i.e. the poses before the
+   * one closest to (x, y), searching forward from the last progress
+   */
+  void updateProgress(double x, double y);
+
+  /**
+   * @brief  Re-check the poses ahead of the robot whose cells lie in [x0, xn) x [y0, yn),
+   * typically the bounds of the last update of the costmap. Hold at least a shared lock on
+   * the costmap while checking.
+   * @return The index of the first blocked pose of the plan, -1 if there is none
+   */
+  int checkWindow(const costmap_2d::Costmap2D& costmap, unsigned int x0, unsigned int xn, unsigned int y0,
+                  unsigned int yn);
+
+  /**
+   * @brief  Check every pose ahead of the robot
+   * @return The index of the first blocked pose of the plan, -1 if there is none
+   */
+  int checkAll(const costmap_2d::Costmap2D& costmap);
+
+  /**
+   * @brief  Number of plan cells whose cost the last check had to read
+   */
+  unsigned int getCheckedCells() const;
+
+private:
+  struct PlanCell {
+    double wx, wy;
+    int mx, my;  // -1 if the pose is off the map
+  };
+
+  struct Segment {
+    int min_x, min_y, max_x, max_y;
+  };
+
+  bool geometryMatches(const costmap_2d::Costmap2D& costmap) const;
+  void index(const costmap_2d::Costmap2D& costmap);
+
+  unsigned int segment_size_;
+  unsigned char blocking_cost_;
+
+  std::vector<PlanCell> cells_;
+  std::vector<Segment> segments_;
+  unsigned int first_pose_;
+  unsigned int checked_cells_;
+
+  // the costmap geometry the cells were computed for
+  unsigned int size_x_, size_y_;
+  double origin_x_, origin_y_, resolution_;
+
+  mutable boost::mutex mutex_;
+};
+
+} /* namespace base_local_planner */
+#endif /* PATH_VALIDITY_CHECKER_H_ */
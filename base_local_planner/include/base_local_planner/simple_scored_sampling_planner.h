@@ -60,7 +60,7 @@ public:
 
   ~SimpleScoredSamplingPlanner() {}
 
-  SimpleScoredSamplingPlanner() {}
+  SimpleScoredSamplingPlanner() : max_samples_(-1), auto_order_(true), scored_count_(0) {}
 
   /**
    * Takes a list of generators and critics. Critics return costs > 0, or negative costs for invalid trajectories.
@@ -76,7 +76,8 @@ public:
   /**
    * runs all scoring functions over the trajectory creating a weigthed sum
    * of positive costs, aborting as soon as a negative cost are found or costs greater
-   * than positive best_traj_cost accumulated
+   * than positive best_traj_cost accumulated. The critics run in the order given, so a
+   * rejected trajectory gets the code of the first critic that rejects it.
    */
   double scoreTrajectory(Trajectory& traj, double best_traj_cost);
 
@@ -93,12 +94,62 @@ public:
    */
   bool findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored = 0);
 
+  /**
+   * Same as above, but if max_explored is not 0, all_explored only collects that many of the
+   * cheapest valid trajectories, in no particular order, which bounds the penalty
+   */
+  bool findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored, unsigned int max_explored);
+
+  /**
+   * Running statistics for one critic, used to order the critics and for profiling.
+   * Counts are halved now and then, so they describe recent behavior.
+   */
+  struct CriticStats {
+    CriticStats() : calls(0), rejections(0), seconds(0.0) {}
+    double calls;       ///< number of times the critic scored a trajectory
+    double rejections;  ///< number of those that returned a negative cost
+    double seconds;     ///< wall time spent in scoreTrajectory, estimated from every TIMING_INTERVAL-th trajectory
+  };
+
+  /** Only every this many trajectories are timed, reading the clock costs as much as a cheap critic */
+  static const unsigned int TIMING_INTERVAL = 16;
+
+  /**
+   * Statistics per critic, in the order the critics were given to the constructor
+   */
+  const std::vector<CriticStats>& getCriticStats() const { return stats_; }
+
+  /**
+   * Replaces the statistics, e.g. to start the ordering from costs known in advance.
+   * Needs one entry per critic, in the order the critics were given to the constructor.
+   */
+  void setCriticStats(const std::vector<CriticStats>& stats);
+
+  /**
+   * If enabled (the default), every findBestTrajectory call first sorts the critics so that
+   * those that are cheap and often reject a trajectory run before expensive ones.
+   * The selected trajectory does not depend on the order, only how early a sample is discarded.
+   * The order given is kept whenever the costs of rejected trajectories are reported, i.e. when
+   * findBestTrajectory collects all explored trajectories, so they keep the same negative codes.
+   * When disabled, critics always run in the order given.
+   */
+  void setAutoOrderCritics(bool auto_order);
+
 
 private:
+  void orderCritics();
+  double scoreTrajectory(Trajectory& traj, double best_traj_cost, const std::vector<unsigned int>& order);
+
   std::vector<TrajectorySampleGenerator*> gen_list_;
   std::vector<TrajectoryCostFunction*> critics_;
 
   int max_samples_;
+
+  bool auto_order_;
+  std::vector<CriticStats> stats_;
+  std::vector<unsigned int> order_;  ///< indices into critics_, in the order they are evaluated
+  std::vector<unsigned int> given_order_;  ///< indices into critics_, in the order given
+  unsigned int scored_count_;  ///< trajectories scored so far, to pick the ones that are timed
 };
 
 
@@ -40,6 +40,8 @@
 
 #include <base_local_planner/trajectory_sample_generator.h>
 #include <base_local_planner/local_planner_limits.h>
+#include <base_local_planner/oscillation_history.h>
+#include <boost/unordered_map.hpp>
 #include <Eigen/Core>
 
 namespace base_local_planner {
@@ -63,6 +65,14 @@ public:
 
   SimpleTrajectoryGenerator() {
     limits_ = NULL;
+    oscillation_history_ = NULL;
+    use_velocity_lattice_ = false;
+    lattice_samples_valid_ = false;
+    lattice_sample_count_ = 0;
+    use_rollout_cache_ = false;
+    rollout_cache_capacity_ = 0;
+    rollout_discretize_by_time_ = false;
+    rollout_acc_lim_ = Eigen::Vector3f::Zero();
   }
 
   ~SimpleTrajectoryGenerator() {}
@@ -115,6 +125,39 @@ public:
       bool use_dwa = false,
       double sim_period = 0.0);
 
+  /**
+   * Skip velocity samples that the given history currently forbids, so they are never rolled out.
+   * Only applies with use_dwa, where a trajectory keeps the velocity of its sample.
+   * The history must outlive the generator; pass NULL to keep every sample.
+   */
+  void setOscillationHistory(const base_local_planner::OscillationHistory* history) {
+    oscillation_history_ = history;
+  }
+
+  /**
+   * Sample each dimension on a fixed lattice of velocities instead of spreading vsamples
+   * over every new window. The lattice only changes with the limits, its spacing gives
+   * vsamples over a window that is not clipped by the limits, and a window that covers
+   * the same lattice points as in the previous cycle reuses the samples of that cycle.
+   * Unlike the default sampling, the window edges are only sampled where they fall on the
+   * lattice, so e.g. the exact maximum velocity may not be tried. Off unless enabled; while
+   * off, the samples are generated from the window every cycle exactly as before.
+   */
+  void setUseVelocityLattice(bool use_velocity_lattice) {
+    use_velocity_lattice_ = use_velocity_lattice;
+    lattice_samples_valid_ = false;
+  }
+
+  /**
+   * Keep the robot frame shape of each rollout, keyed by its sample velocity. Rolling out the
+   * same sample again then only transforms the stored shape to the current pose instead of
+   * integrating it step by step. Only used with use_dwa, where the shape does not depend on the
+   * current velocity, so the result is the same as a fresh rollout; without it every rollout is
+   * simulated. Pays off when the samples repeat between cycles, e.g. on the velocity lattice.
+   * The cache is emptied when it holds more than capacity shapes.
+   */
+  void setRolloutCache(bool enabled, unsigned int capacity = 2048);
+
   /**
    * Whether this generator can create more trajectories
    */
@@ -144,6 +187,7 @@ protected:
   // to store sample params of each sample between init and generation
   std::vector<Eigen::Vector3f> sample_params_;
   base_local_planner::LocalPlannerLimits* limits_;
+  const base_local_planner::OscillationHistory* oscillation_history_;
   Eigen::Vector3f pos_;
   Eigen::Vector3f vel_;
 
@@ -154,6 +198,58 @@ protected:
   double sim_time_, sim_granularity_, angular_sim_granularity_;
   bool use_dwa_;
   double sim_period_; // only for dwa
+
+  // velocities of one dimension, sorted, covering [min, max] with the given spacing
+  struct VelocityLattice {
+    VelocityLattice() : min(0.0), max(0.0), step(0.0) {}
+    double min, max, step;
+    std::vector<double> values;
+  };
+
+  bool use_velocity_lattice_;
+  VelocityLattice lattice_[3];
+  // the lattice index ranges the current samples were generated from
+  unsigned int window_begin_[3], window_end_[3];
+  bool lattice_samples_valid_;
+  // the samples at the front of sample_params_ that came from the lattice
+  unsigned int lattice_sample_count_;
+
+  bool updateLattice(unsigned int dim, double min, double max, double step);
+
+  bool generateLatticeSamples(const Eigen::Vector3f& min_vel, const Eigen::Vector3f& max_vel,
+      const Eigen::Vector3f& limit_min_vel, const Eigen::Vector3f& limit_max_vel,
+      const Eigen::Vector3f& acc_lim, const Eigen::Vector3f& vsamples);
+
+  struct RolloutKey {
+    float sample[3];
+
+    bool operator==(const RolloutKey& other) const {
+      return sample[0] == other.sample[0] && sample[1] == other.sample[1] && sample[2] == other.sample[2];
+    }
+  };
+
+  struct RolloutKeyHash {
+    std::size_t operator()(const RolloutKey& key) const;
+  };
+
+  bool use_rollout_cache_;
+  unsigned int rollout_cache_capacity_;
+  // the settings the cached shapes were simulated with, besides the ones from setParameters
+  bool rollout_discretize_by_time_;
+  Eigen::Vector3f rollout_acc_lim_;
+  boost::unordered_map<RolloutKey, Trajectory, RolloutKeyHash> rollout_cache_;
+
+  const Trajectory& cachedRollout(const Eigen::Vector3f& sample_target_vel);
+
+  bool simulateTrajectory(
+        Eigen::Vector3f pos,
+        Eigen::Vector3f vel,
+        Eigen::Vector3f sample_target_vel,
+        base_local_planner::Trajectory& traj);
+
+  bool isPruned(const Eigen::Vector3f& sample) const {
+    return use_dwa_ && oscillation_history_ && !oscillation_history_->isAllowed(sample);
+  }
 };
 
 } /* namespace base_local_planner */
@@ -39,6 +39,7 @@
 #include <vector>
 #include <list>
 #include <cfloat>
+#include <stdint.h>
 #include <geometry_msgs/Point.h>
 #include <costmap_2d/observation.h>
 #include <base_local_planner/world_model.h>
@@ -54,6 +55,11 @@ namespace base_local_planner {
    * @class VoxelGridModel
    * @brief A class that implements the WorldModel interface to provide grid
    * based collision checks for the trajectory controller using a 3D voxel grid.
+   *
+   * Collision checks do not look at the voxel columns directly. Each updateWorld
+   * flattens the grid into a bitmap holding one bit per column that is set when
+   * the column is not free, and footprint lines are checked a row run at a time
+   * against 64 columns per word.
    */
   class VoxelGridModel : public WorldModel {
     public:
@@ -121,6 +127,20 @@ namespace base_local_planner {
        */
       double pointCost(int x, int y);
 
+      /**
+       * @brief  Checks a horizontal run of cells against the column bitmap
+       * @param y The row of the run in cell coordinates
+       * @param x0 The first cell of the run
+       * @param x1 The last cell of the run, inclusive
+       * @return True if every cell of the run is inside the grid and free
+       */
+      bool runFree(int y, int x0, int x1);
+
+      /**
+       * @brief  Rebuilds column_bits_ from the voxel grid
+       */
+      void updateColumnBits();
+
       void removePointsInScanBoundry(const PlanarLaserScan& laser_scan, double raytrace_range);
 
       inline bool worldToMap3D(double wx, double wy, double wz, unsigned int& mx, unsigned int& my, unsigned int& mz){
@@ -165,6 +185,8 @@ namespace base_local_planner {
       }
 
       voxel_grid::VoxelGrid obstacle_grid_;
+      std::vector<uint64_t> column_bits_; ///< @brief One bit per column, set if the column is not free
+      unsigned int words_per_row_;
       double xy_resolution_;
       double z_resolution_;
       double origin_x_;
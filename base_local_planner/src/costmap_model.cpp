@@ -42,7 +42,19 @@ using namespace std;
 using namespace costmap_2d;
 
 namespace base_local_planner {
-  CostmapModel::CostmapModel(const Costmap2D& ma) : costmap_(ma) {}
+  CostmapModel::CostmapModel(const Costmap2D& ma) : costmap_(ma), cache_(FootprintCostCache::forCostmap(ma)) {}
+
+  double CostmapModel::footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+      double inscribed_radius, double circumscribed_radius){
+    uint64_t revision = costmap_.getRevision();
+    double cost;
+    if(cache_->lookup(revision, x, y, theta, footprint_spec, cost))
+      return cost;
+
+    cost = WorldModel::footprintCost(x, y, theta, footprint_spec, inscribed_radius, circumscribed_radius);
+    cache_->insert(revision, x, y, theta, footprint_spec, cost);
+    return cost;
+  }
 
   double CostmapModel::footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint, 
       double inscribed_radius, double circumscribed_radius){
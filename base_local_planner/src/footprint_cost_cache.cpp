@@ -0,0 +1,187 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/footprint_cost_cache.h>
+
+#include <cmath>
+#include <map>
+#include <boost/functional/hash.hpp>
+#include <boost/weak_ptr.hpp>
+
+namespace base_local_planner {
+
+FootprintCostCache::FootprintCostCache(unsigned int capacity, double xy_quantum, double theta_quantum) :
+    capacity_(capacity), xy_quantum_(xy_quantum), theta_quantum_(theta_quantum), revision_(0), hits_(0) {
+}
+
+boost::shared_ptr<FootprintCostCache> FootprintCostCache::forCostmap(const costmap_2d::Costmap2D& costmap) {
+  static boost::mutex registry_mutex;
+  static std::map<const costmap_2d::Costmap2D*, boost::weak_ptr<FootprintCostCache> > registry;
+
+  boost::mutex::scoped_lock lock(registry_mutex);
+  // forget the maps whose caches are gone, so the registry does not grow with every map ever seen
+  for (std::map<const costmap_2d::Costmap2D*, boost::weak_ptr<FootprintCostCache> >::iterator it = registry.begin();
+      it != registry.end();) {
+    if (it->second.expired()) {
+      registry.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  // a map allocated where a destroyed one used to be is harmless: revisions are never
+  // shared between maps, so the old entries are dropped on the first lookup
+  boost::shared_ptr<FootprintCostCache> cache = registry[&costmap].lock();
+  if (!cache) {
+    cache.reset(new FootprintCostCache());
+    registry[&costmap] = cache;
+  }
+  return cache;
+}
+
+std::size_t FootprintCostCache::KeyHash::operator()(const Key& key) const {
+  std::size_t seed = key.footprint;
+  boost::hash_combine(seed, key.x);
+  boost::hash_combine(seed, key.y);
+  boost::hash_combine(seed, key.theta);
+  return seed;
+}
+
+static bool sameFootprint(const std::vector<geometry_msgs::Point>& a, const std::vector<geometry_msgs::Point>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < a.size(); ++i) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FootprintCostCache::makeKey(double x, double y, double theta,
+    const std::vector<geometry_msgs::Point>& footprint_spec, bool add, Key& key) {
+  key.x = (int64_t)floor(x / xy_quantum_ + 0.5);
+  key.y = (int64_t)floor(y / xy_quantum_ + 0.5);
+  key.theta = (int64_t)floor(theta / theta_quantum_ + 0.5);
+  // there are only a few footprints in use at a time, so a linear search is fine
+  for (key.footprint = 0; key.footprint < footprints_.size(); ++key.footprint) {
+    if (sameFootprint(footprints_[key.footprint], footprint_spec)) {
+      return true;
+    }
+  }
+  if (!add) {
+    return false;
+  }
+  if (footprints_.size() >= 16) {
+    // a footprint that keeps changing would make the search slow, start over
+    entries_.clear();
+    index_.clear();
+    footprints_.clear();
+    key.footprint = 0;
+  }
+  footprints_.push_back(footprint_spec);
+  return true;
+}
+
+void FootprintCostCache::setRevision(uint64_t revision) {
+  if (revision == revision_) {
+    return;
+  }
+  entries_.clear();
+  index_.clear();
+  revision_ = revision;
+}
+
+bool FootprintCostCache::lookup(uint64_t revision, double x, double y, double theta,
+    const std::vector<geometry_msgs::Point>& footprint_spec, double& cost) {
+  boost::mutex::scoped_lock lock(mutex_);
+  setRevision(revision);
+  Key key;
+  if (!makeKey(x, y, theta, footprint_spec, false, key)) {
+    return false;
+  }
+  boost::unordered_map<Key, Entries::iterator, KeyHash>::iterator found = index_.find(key);
+  if (found == index_.end()) {
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, found->second);
+  cost = found->second->second;
+  ++hits_;
+  return true;
+}
+
+void FootprintCostCache::insert(uint64_t revision, double x, double y, double theta,
+    const std::vector<geometry_msgs::Point>& footprint_spec, double cost) {
+  if (capacity_ == 0) {
+    return;
+  }
+  boost::mutex::scoped_lock lock(mutex_);
+  setRevision(revision);
+  Key key;
+  makeKey(x, y, theta, footprint_spec, true, key);
+  boost::unordered_map<Key, Entries::iterator, KeyHash>::iterator found = index_.find(key);
+  if (found != index_.end()) {
+    found->second->second = cost;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+
+  if (index_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.push_front(std::make_pair(key, cost));
+  index_[key] = entries_.begin();
+}
+
+void FootprintCostCache::clear() {
+  boost::mutex::scoped_lock lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  footprints_.clear();
+}
+
+unsigned int FootprintCostCache::size() const {
+  boost::mutex::scoped_lock lock(mutex_);
+  return index_.size();
+}
+
+unsigned long FootprintCostCache::getHits() const {
+  boost::mutex::scoped_lock lock(mutex_);
+  return hits_;
+}
+
+} /* namespace base_local_planner */
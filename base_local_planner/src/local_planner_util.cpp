@@ -37,6 +37,8 @@
 
 #include <base_local_planner/local_planner_util.h>
 
+#include <algorithm>
+
 #include <base_local_planner/goal_functions.h>
 
 namespace base_local_planner {
@@ -75,8 +77,18 @@ costmap_2d::Costmap2D* LocalPlannerUtil::getCostmap() {
 }
 
 LocalPlannerLimits LocalPlannerUtil::getCurrentLimits() {
-  boost::mutex::scoped_lock l(limits_configuration_mutex_);
-  return limits_;
+  LocalPlannerLimits limits;
+  {
+    boost::mutex::scoped_lock l(limits_configuration_mutex_);
+    limits = limits_;
+  }
+
+  double max_trans_vel = limits.max_trans_vel, max_rot_vel = limits.max_rot_vel;
+  if (speed_limit_ && speed_limit_->get(max_trans_vel, max_rot_vel)) {
+    limits.max_trans_vel = std::min(limits.max_trans_vel, max_trans_vel);
+    limits.max_rot_vel = std::min(limits.max_rot_vel, max_rot_vel);
+  }
+  return limits;
 }
 
 
@@ -39,6 +39,15 @@
 
 namespace base_local_planner {
 
+namespace {
+// the distance of a grid cell, for resampling the grid into the egocentric grid
+struct TargetDistValue {
+  explicit TargetDistValue(const MapGrid& map) : map_(map) {}
+  double operator()(int mx, int my) const { return map_(mx, my).target_dist; }
+  const MapGrid& map_;
+};
+}
+
 MapGridCostFunction::MapGridCostFunction(costmap_2d::Costmap2D* costmap,
     double xshift,
     double yshift,
@@ -50,19 +59,48 @@ MapGridCostFunction::MapGridCostFunction(costmap_2d::Costmap2D* costmap,
     xshift_(xshift),
     yshift_(yshift),
     is_local_goal_function_(is_local_goal_function),
-    stop_on_failure_(true) {}
+    stop_on_failure_(true),
+    prepared_(false),
+    prepared_revision_(0),
+    egocentric_(false),
+    reach_(0.0),
+    robot_x_(0.0),
+    robot_y_(0.0),
+    robot_th_(0.0) {}
 
-void MapGridCostFunction::setTargetPoses(std::vector<geometry_msgs::PoseStamped> target_poses) {
+void MapGridCostFunction::setTargetPoses(const std::vector<geometry_msgs::PoseStamped>& target_poses) {
+  // the grid only depends on the positions, so an unchanged plan keeps it valid
+  if (prepared_ && target_poses.size() == target_poses_.size()) {
+    bool same = true;
+    for (unsigned int i = 0; same && i < target_poses.size(); ++i) {
+      same = target_poses[i].pose.position.x == target_poses_[i].pose.position.x &&
+          target_poses[i].pose.position.y == target_poses_[i].pose.position.y;
+    }
+    if (same) {
+      return;
+    }
+  }
   target_poses_ = target_poses;
+  prepared_ = false;
 }
 
 bool MapGridCostFunction::prepare() {
-  map_.resetPathDist();
+  if (!prepared_ || prepared_revision_ != costmap_->getRevision()) {
+    prepared_ = true;
+    prepared_revision_ = costmap_->getRevision();
+
+    map_.resetPathDist();
 
-  if (is_local_goal_function_) {
-    map_.setLocalGoal(*costmap_, target_poses_);
-  } else {
-    map_.setTargetCells(*costmap_, target_poses_);
+    if (is_local_goal_function_) {
+      map_.setLocalGoal(*costmap_, target_poses_);
+    } else {
+      map_.setTargetCells(*costmap_, target_poses_);
+    }
+  }
+
+  // the robot moves every cycle even if the distances stay the same
+  if (egocentric_) {
+    egocentric_grid_.resample(*costmap_, robot_x_, robot_y_, robot_th_, reach_, TargetDistValue(map_), -1.0);
   }
   return true;
 }
@@ -95,13 +133,26 @@ double MapGridCostFunction::scoreTrajectory(Trajectory &traj) {
       py = py + yshift_ * sin(pth + M_PI_2);
     }
 
-    //we won't allow trajectories that go off the map... shouldn't happen that often anyways
-    if ( ! costmap_->worldToMap(px, py, cell_x, cell_y)) {
-      //we're off the map
-      ROS_WARN("Off Map %f, %f", px, py);
-      return -4.0;
+    double rx, ry;
+    int ego_x, ego_y;
+    if (egocentric_) {
+      egocentric_grid_.worldToRobot(px, py, rx, ry);
+    }
+    if (egocentric_ && egocentric_grid_.robotToCell(rx, ry, ego_x, ego_y)) {
+      grid_dist = egocentric_grid_(ego_x, ego_y);
+      if (grid_dist < 0.0) {
+        ROS_WARN("Off Map %f, %f", px, py);
+        return -4.0;
+      }
+    } else {
+      //we won't allow trajectories that go off the map... shouldn't happen that often anyways
+      if ( ! costmap_->worldToMap(px, py, cell_x, cell_y)) {
+        //we're off the map
+        ROS_WARN("Off Map %f, %f", px, py);
+        return -4.0;
+      }
+      grid_dist = getCellCosts(cell_x, cell_y);
     }
-    grid_dist = getCellCosts(cell_x, cell_y);
     //if a point on this trajectory has no clear path to the goal... it may be invalid
     if (stop_on_failure_) {
       if (grid_dist == map_.obstacleCosts()) {
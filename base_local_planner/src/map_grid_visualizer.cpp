@@ -53,6 +53,9 @@ namespace base_local_planner {
   }
 
   void MapGridVisualizer::publishCostCloud(const costmap_2d::Costmap2D* costmap_p_) {
+    if (pub_.getNumSubscribers() == 0) {
+      return;
+    }
     unsigned int x_size = costmap_p_->getSizeInCellsX();
     unsigned int y_size = costmap_p_->getSizeInCellsY();
     double z_coord = 0.0;
@@ -36,14 +36,26 @@
  *********************************************************************/
 
 #include <base_local_planner/obstacle_cost_function.h>
+#include <base_local_planner/line_iterator.h>
+#include <costmap_2d/cost_values.h>
 #include <cmath>
 #include <Eigen/Core>
 #include <ros/console.h>
 
 namespace base_local_planner {
 
+namespace {
+// the cost of a costmap cell, for resampling the costmap into the egocentric grid
+struct CostmapCellValue {
+  explicit CostmapCellValue(const costmap_2d::Costmap2D& costmap) : costmap_(costmap) {}
+  int operator()(int mx, int my) const { return costmap_.getCost(mx, my); }
+  const costmap_2d::Costmap2D& costmap_;
+};
+}
+
 ObstacleCostFunction::ObstacleCostFunction(costmap_2d::Costmap2D* costmap) 
-    : costmap_(costmap), sum_scores_(false) {
+    : costmap_(costmap), speed_limits_(NULL), check_speed_limits_(false), sum_scores_(false),
+      egocentric_(false), reach_(0.0), robot_x_(0.0), robot_y_(0.0), robot_th_(0.0) {
   if (costmap != NULL) {
     world_model_ = new base_local_planner::CostmapModel(*costmap_);
   }
@@ -68,6 +80,20 @@ void ObstacleCostFunction::setFootprint(std::vector<geometry_msgs::Point> footpr
 }
 
 bool ObstacleCostFunction::prepare() {
+  // the grid is resampled on the costmap update thread, so score against a snapshot of it;
+  // it follows the costmap, but skip it while a resize has not reached it yet
+  if (speed_limits_ != NULL) {
+    speed_snapshot_ = speed_limits_->getSpeedLimitSnapshot();
+  }
+  check_speed_limits_ = speed_limits_ != NULL &&
+      speed_snapshot_.getSizeX() == costmap_->getSizeInCellsX() &&
+      speed_snapshot_.getSizeY() == costmap_->getSizeInCellsY();
+
+  if (egocentric_) {
+    // a footprint edge may cross a lethal cell between the centers of rotated cells
+    egocentric_grid_.resampleMax(*costmap_, robot_x_, robot_y_, robot_th_, reach_,
+        CostmapCellValue(*costmap_), OFF_MAP);
+  }
   return true;
 }
 
@@ -81,16 +107,27 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
     return -9;
   }
 
+  double vmag = hypot(traj.xv_, traj.yv_);
+  unsigned int cell_x, cell_y;
   for (unsigned int i = 0; i < traj.getPointsSize(); ++i) {
     traj.getPoint(i, px, py, pth);
-    double f_cost = footprintCost(px, py, pth,
-        scale, footprint_spec_,
-        costmap_, world_model_);
+    double f_cost;
+    if (!egocentric_ || !egocentricFootprintCost(px, py, pth, f_cost)) {
+      f_cost = footprintCost(px, py, pth,
+          scale, footprint_spec_,
+          costmap_, world_model_);
+    }
 
     if(f_cost < 0){
         return f_cost;
     }
 
+    // same pass as the costs: the limit of the cell footprintCost just scored
+    if (check_speed_limits_ && costmap_->worldToMap(px, py, cell_x, cell_y) &&
+        vmag - 1e-4 > speed_snapshot_.getSpeedLimit(cell_x, cell_y)) {
+      return -8;
+    }
+
     if(sum_scores_)
         cost +=  f_cost;
     else
@@ -99,6 +136,63 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
   return cost;
 }
 
+/**
+ * Same checks as footprintCost with a CostmapModel, done in the egocentric grid.
+ * Returns false if the footprint does not fit into the grid.
+ */
+bool ObstacleCostFunction::egocentricFootprintCost(double x, double y, double th, double& cost) const {
+  double rx, ry;
+  int cx, cy;
+  egocentric_grid_.worldToRobot(x, y, rx, ry);
+  if (!egocentric_grid_.robotToCell(rx, ry, cx, cy)) {
+    return false;
+  }
+  int center_cost = egocentric_grid_(cx, cy);
+  if (center_cost == OFF_MAP) {
+    cost = -7.0;
+    return true;
+  }
+
+  double footprint_cost = 0.0;
+  if (footprint_spec_.size() < 3) {
+    if (center_cost == costmap_2d::LETHAL_OBSTACLE || center_cost == costmap_2d::INSCRIBED_INFLATED_OBSTACLE ||
+        center_cost == costmap_2d::NO_INFORMATION) {
+      cost = -6.0;
+      return true;
+    }
+    footprint_cost = center_cost;
+  } else {
+    // the corners relative to the robot, then their cells
+    double rth = th - egocentric_grid_.getTheta();
+    double cos_th = cos(rth);
+    double sin_th = sin(rth);
+    std::vector<int> corners_x(footprint_spec_.size()), corners_y(footprint_spec_.size());
+    for (unsigned int i = 0; i < footprint_spec_.size(); ++i) {
+      if (!egocentric_grid_.robotToCell(rx + footprint_spec_[i].x * cos_th - footprint_spec_[i].y * sin_th,
+          ry + footprint_spec_[i].x * sin_th + footprint_spec_[i].y * cos_th, corners_x[i], corners_y[i])) {
+        return false;
+      }
+    }
+
+    unsigned int previous = footprint_spec_.size() - 1;
+    for (unsigned int i = 0; i < footprint_spec_.size(); previous = i++) {
+      for (LineIterator line(corners_x[previous], corners_y[previous], corners_x[i], corners_y[i]);
+          line.isValid(); line.advance()) {
+        int point_cost = egocentric_grid_(line.getX(), line.getY());
+        if (point_cost == OFF_MAP || point_cost == costmap_2d::LETHAL_OBSTACLE ||
+            point_cost == costmap_2d::NO_INFORMATION) {
+          cost = -6.0;
+          return true;
+        }
+        footprint_cost = std::max(footprint_cost, double(point_cost));
+      }
+    }
+  }
+
+  cost = std::max(footprint_cost, double(center_cost));
+  return true;
+}
+
 double ObstacleCostFunction::getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor) {
   double vmag = hypot(traj.xv_, traj.yv_);
 
@@ -122,6 +216,14 @@ double ObstacleCostFunction::footprintCost (
     costmap_2d::Costmap2D* costmap,
     base_local_planner::WorldModel* world_model) {
 
+  unsigned int cell_x, cell_y;
+
+  //we won't allow trajectories that go off the map... shouldn't happen that often anyways
+  //checked first, the world model would reject an off map center as an obstacle
+  if ( ! costmap->worldToMap(x, y, cell_x, cell_y)) {
+    return -7.0;
+  }
+
   //check if the footprint is legal
   // TODO: Cache inscribed radius
   double footprint_cost = world_model->footprintCost(x, y, th, footprint_spec);
@@ -129,14 +231,8 @@ double ObstacleCostFunction::footprintCost (
   if (footprint_cost < 0) {
     return -6.0;
   }
-  unsigned int cell_x, cell_y;
-
-  //we won't allow trajectories that go off the map... shouldn't happen that often anyways
-  if ( ! costmap->worldToMap(x, y, cell_x, cell_y)) {
-    return -7.0;
-  }
 
-  double occ_cost = std::max(std::max(occ_cost, footprint_cost), double(costmap->getCost(cell_x, cell_y)));
+  double occ_cost = std::max(footprint_cost, double(costmap->getCost(cell_x, cell_y)));
 
   return occ_cost;
 }
@@ -35,10 +35,12 @@
  * Author: TKruse
  *********************************************************************/
 #include <base_local_planner/odometry_helper_ros.h>
+#include <algorithm>
 
 namespace base_local_planner {
 
-OdometryHelperRos::OdometryHelperRos(std::string odom_topic) {
+OdometryHelperRos::OdometryHelperRos(std::string odom_topic) :
+    history_head_(0), history_count_(0), average_window_(0.0) {
   setOdomTopic( odom_topic );
 }
 
@@ -47,32 +49,91 @@ void OdometryHelperRos::odomCallback(const nav_msgs::Odometry::ConstPtr& msg) {
 
   //we assume that the odometry is published in the frame of the base
   boost::mutex::scoped_lock lock(odom_mutex_);
-  base_odom_.twist.twist.linear.x = msg->twist.twist.linear.x;
-  base_odom_.twist.twist.linear.y = msg->twist.twist.linear.y;
-  base_odom_.twist.twist.angular.z = msg->twist.twist.angular.z;
+  history_head_ = (history_head_ + 1) % HISTORY_SIZE;
+  OdometrySnapshot& snapshot = history_[history_head_];
+  snapshot.vx = msg->twist.twist.linear.x;
+  snapshot.vy = msg->twist.twist.linear.y;
+  snapshot.vth = msg->twist.twist.angular.z;
+  snapshot.stamp = msg->header.stamp;
+  if (history_count_ < HISTORY_SIZE)
+    history_count_++;
 //  ROS_DEBUG_NAMED("dwa_local_planner", "In the odometry callback with velocity values: (%.2f, %.2f, %.2f)",
-//      base_odom_.twist.twist.linear.x, base_odom_.twist.twist.linear.y, base_odom_.twist.twist.angular.z);
+//      snapshot.vx, snapshot.vy, snapshot.vth);
 }
 
-//copy over the odometry information
-void OdometryHelperRos::getOdom(nav_msgs::Odometry& base_odom) {
+bool OdometryHelperRos::getSnapshot(OdometrySnapshot& snapshot) const {
+  unsigned int count;
+  {
+    boost::mutex::scoped_lock lock(odom_mutex_);
+    count = history_count_;
+    snapshot = history_[history_head_];
+  }
+
+  if (count == 0) {
+    snapshot.vx = snapshot.vy = snapshot.vth = 0.0;
+    snapshot.stamp = ros::Time();
+    return false;
+  }
+  return true;
+}
+
+unsigned int OdometryHelperRos::readHistory(OdometrySnapshot* history, unsigned int& head) const {
   boost::mutex::scoped_lock lock(odom_mutex_);
-  base_odom = base_odom_;
+  head = history_head_;
+  std::copy(history_, history_ + HISTORY_SIZE, history);
+  return history_count_;
+}
+
+bool OdometryHelperRos::getAverageVelocity(double window, OdometrySnapshot& average) const {
+  OdometrySnapshot history[HISTORY_SIZE];
+  unsigned int head;
+  unsigned int count = readHistory(history, head);
+
+  average.vx = average.vy = average.vth = 0.0;
+  average.stamp = ros::Time();
+  if (count == 0)
+    return false;
+
+  //walk back from the newest message until we leave the window
+  const OdometrySnapshot& newest = history[head];
+  unsigned int used = 0;
+  for (unsigned int i = 0; i < count; ++i) {
+    const OdometrySnapshot& sample = history[(head + HISTORY_SIZE - i) % HISTORY_SIZE];
+    if (i > 0 && (newest.stamp - sample.stamp).toSec() > window)
+      break;
+    average.vx += sample.vx;
+    average.vy += sample.vy;
+    average.vth += sample.vth;
+    used++;
+  }
+
+  average.vx /= used;
+  average.vy /= used;
+  average.vth /= used;
+  average.stamp = newest.stamp;
+  return true;
+}
+
+//copy over the odometry information, only the velocities are tracked
+void OdometryHelperRos::getOdom(nav_msgs::Odometry& base_odom) {
+  OdometrySnapshot snapshot;
+  getSnapshot(snapshot);
+  base_odom.twist.twist.linear.x = snapshot.vx;
+  base_odom.twist.twist.linear.y = snapshot.vy;
+  base_odom.twist.twist.angular.z = snapshot.vth;
 }
 
 
 void OdometryHelperRos::getRobotVel(tf::Stamped<tf::Pose>& robot_vel) {
   // Set current velocities from odometry
-  geometry_msgs::Twist global_vel;
-  {
-    boost::mutex::scoped_lock lock(odom_mutex_);
-    global_vel.linear.x = base_odom_.twist.twist.linear.x;
-    global_vel.linear.y = base_odom_.twist.twist.linear.y;
-    global_vel.angular.z = base_odom_.twist.twist.angular.z;
+  OdometrySnapshot snapshot;
+  if (average_window_ > 0.0)
+    getAverageVelocity(average_window_, snapshot);
+  else
+    getSnapshot(snapshot);
 
-    robot_vel.frame_id_ = base_odom_.child_frame_id;
-  }
-  robot_vel.setData(tf::Transform(tf::createQuaternionFromYaw(global_vel.angular.z), tf::Vector3(global_vel.linear.x, global_vel.linear.y, 0)));
+  robot_vel.frame_id_ = frame_id_;
+  robot_vel.setData(tf::Transform(tf::createQuaternionFromYaw(snapshot.vth), tf::Vector3(snapshot.vx, snapshot.vy, 0)));
   robot_vel.stamp_ = ros::Time();
 }
 
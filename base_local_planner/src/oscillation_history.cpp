@@ -0,0 +1,133 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/oscillation_history.h>
+
+#include <cmath>
+
+namespace base_local_planner {
+
+OscillationHistory::OscillationHistory(unsigned int capacity) :
+    samples_(capacity > 0 ? capacity : 1), reset_dist_(0.0), reset_angle_(0.0) {
+  clear();
+}
+
+void OscillationHistory::setResetDistance(double dist, double angle) {
+  reset_dist_ = dist;
+  reset_angle_ = angle;
+}
+
+void OscillationHistory::clear() {
+  head_ = 0;
+  count_ = 0;
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    reversal_count_[axis] = 0;
+  }
+  resetRestrictions();
+  restriction_pose_ = Eigen::Vector3f::Zero();
+  progress_pose_ = Eigen::Vector3f::Zero();
+}
+
+void OscillationHistory::resetRestrictions() {
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    direction_[axis] = 0;
+    restriction_[axis] = 0;
+  }
+  restricted_axes_ = 0;
+}
+
+void OscillationHistory::push(const Eigen::Vector3f& pos, const Eigen::Vector3f& vel, double min_vel_trans) {
+  unsigned char reversed = 0;
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    //we'll only track strafing and rotating when we're not moving forward at all
+    if (axis > 0 && fabs(vel[0]) > min_vel_trans) {
+      break;
+    }
+    int dir = vel[axis] > 0.0 ? 1 : (vel[axis] < 0.0 ? -1 : 0);
+    if (dir == 0) {
+      continue;
+    }
+    if (direction_[axis] == -dir) {
+      restriction_[axis] |= dir > 0 ? POSITIVE_ONLY : NEGATIVE_ONLY;
+      restricted_axes_ |= 1 << axis;
+      reversed |= 1 << axis;
+    }
+    direction_[axis] = dir;
+  }
+
+  //evict the oldest sample once the ring is full, keeping the counts in step
+  unsigned int capacity = samples_.size();
+  if (count_ == capacity) {
+    const Sample& oldest = samples_[head_];
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+      if (oldest.reversed & (1 << axis)) {
+        --reversal_count_[axis];
+      }
+    }
+    head_ = (head_ + 1) % capacity;
+    --count_;
+  }
+  Sample& sample = samples_[(head_ + count_) % capacity];
+  sample.pos = pos;
+  sample.vel = vel;
+  sample.reversed = reversed;
+  ++count_;
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    if (reversed & (1 << axis)) {
+      ++reversal_count_[axis];
+    }
+  }
+
+  if (reversed) {
+    restriction_pose_ = pos;
+  }
+
+  //if we've moved far enough from where we last flipped direction... we can reset the restrictions
+  if (restricted_axes_) {
+    double x_diff = pos[0] - restriction_pose_[0];
+    double y_diff = pos[1] - restriction_pose_[1];
+    double th_diff = pos[2] - restriction_pose_[2];
+    if (x_diff * x_diff + y_diff * y_diff > reset_dist_ * reset_dist_ ||
+        fabs(th_diff) > reset_angle_) {
+      resetRestrictions();
+    }
+  }
+}
+
+double OscillationHistory::progressDistance(const Eigen::Vector3f& pos) const {
+  return hypot(pos[0] - progress_pose_[0], pos[1] - progress_pose_[1]);
+}
+
+} /* namespace base_local_planner */
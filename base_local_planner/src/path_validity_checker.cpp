@@ -0,0 +1,176 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/path_validity_checker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+PathValidityChecker::PathValidityChecker(unsigned int segment_size) :
+    segment_size_(segment_size > 0 ? segment_size : 1), blocking_cost_(costmap_2d::INSCRIBED_INFLATED_OBSTACLE),
+    first_pose_(0), checked_cells_(0), size_x_(0), size_y_(0), origin_x_(0.0), origin_y_(0.0), resolution_(0.0) {
+}
+
+void PathValidityChecker::setBlockingCost(unsigned char cost) {
+  boost::mutex::scoped_lock lock(mutex_);
+  blocking_cost_ = cost;
+}
+
+void PathValidityChecker::setPlan(const std::vector<geometry_msgs::PoseStamped>& plan,
+    const costmap_2d::Costmap2D& costmap) {
+  boost::mutex::scoped_lock lock(mutex_);
+  cells_.resize(plan.size());
+  for (unsigned int i = 0; i < plan.size(); ++i) {
+    cells_[i].wx = plan[i].pose.position.x;
+    cells_[i].wy = plan[i].pose.position.y;
+  }
+  first_pose_ = 0;
+  index(costmap);
+}
+
+void PathValidityChecker::clear() {
+  boost::mutex::scoped_lock lock(mutex_);
+  cells_.clear();
+  segments_.clear();
+  first_pose_ = 0;
+}
+
+bool PathValidityChecker::hasPlan() const {
+  boost::mutex::scoped_lock lock(mutex_);
+  return !cells_.empty();
+}
+
+unsigned int PathValidityChecker::getCheckedCells() const {
+  boost::mutex::scoped_lock lock(mutex_);
+  return checked_cells_;
+}
+
+bool PathValidityChecker::geometryMatches(const costmap_2d::Costmap2D& costmap) const {
+  return size_x_ == costmap.getSizeInCellsX() && size_y_ == costmap.getSizeInCellsY() &&
+      origin_x_ == costmap.getOriginX() && origin_y_ == costmap.getOriginY() &&
+      resolution_ == costmap.getResolution();
+}
+
+void PathValidityChecker::index(const costmap_2d::Costmap2D& costmap) {
+  size_x_ = costmap.getSizeInCellsX();
+  size_y_ = costmap.getSizeInCellsY();
+  origin_x_ = costmap.getOriginX();
+  origin_y_ = costmap.getOriginY();
+  resolution_ = costmap.getResolution();
+
+  segments_.resize((cells_.size() + segment_size_ - 1) / segment_size_);
+  for (unsigned int s = 0; s < segments_.size(); ++s) {
+    Segment& segment = segments_[s];
+    // an empty box (min > max) for a segment that is entirely off the map
+    segment.min_x = segment.min_y = INT_MAX;
+    segment.max_x = segment.max_y = -1;
+    unsigned int end = std::min((s + 1) * segment_size_, (unsigned int)cells_.size());
+    for (unsigned int i = s * segment_size_; i < end; ++i) {
+      PlanCell& cell = cells_[i];
+      unsigned int mx, my;
+      if (!costmap.worldToMap(cell.wx, cell.wy, mx, my)) {
+        cell.mx = cell.my = -1;
+        continue;
+      }
+      cell.mx = mx;
+      cell.my = my;
+      segment.min_x = std::min(segment.min_x, cell.mx);
+      segment.min_y = std::min(segment.min_y, cell.my);
+      segment.max_x = std::max(segment.max_x, cell.mx);
+      segment.max_y = std::max(segment.max_y, cell.my);
+    }
+  }
+}
+
+void PathValidityChecker::updateProgress(double x, double y) {
+  boost::mutex::scoped_lock lock(mutex_);
+  if (cells_.empty()) {
+    return;
+  }
+  // walk forward as long as the plan keeps getting closer to the robot
+  double best = hypot(cells_[first_pose_].wx - x, cells_[first_pose_].wy - y);
+  while (first_pose_ + 1 < cells_.size()) {
+    double next = hypot(cells_[first_pose_ + 1].wx - x, cells_[first_pose_ + 1].wy - y);
+    if (next > best) {
+      break;
+    }
+    best = next;
+    ++first_pose_;
+  }
+}
+
+int PathValidityChecker::checkWindow(const costmap_2d::Costmap2D& costmap, unsigned int x0, unsigned int xn,
+    unsigned int y0, unsigned int yn) {
+  boost::mutex::scoped_lock lock(mutex_);
+  checked_cells_ = 0;
+  if (cells_.empty() || xn <= x0 || yn <= y0) {
+    return -1;
+  }
+  if (!geometryMatches(costmap)) {
+    index(costmap);
+  }
+
+  int wx0 = x0, wy0 = y0, wxn = xn, wyn = yn;
+  for (unsigned int s = first_pose_ / segment_size_; s < segments_.size(); ++s) {
+    const Segment& segment = segments_[s];
+    if (segment.max_x < wx0 || segment.min_x >= wxn || segment.max_y < wy0 || segment.min_y >= wyn) {
+      continue;
+    }
+
+    unsigned int end = std::min((s + 1) * segment_size_, (unsigned int)cells_.size());
+    for (unsigned int i = std::max(s * segment_size_, first_pose_); i < end; ++i) {
+      const PlanCell& cell = cells_[i];
+      if (cell.mx < wx0 || cell.mx >= wxn || cell.my < wy0 || cell.my >= wyn) {
+        continue;
+      }
+      ++checked_cells_;
+      unsigned char cost = costmap.getCost(cell.mx, cell.my);
+      if (cost >= blocking_cost_ && cost != costmap_2d::NO_INFORMATION) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+int PathValidityChecker::checkAll(const costmap_2d::Costmap2D& costmap) {
+  return checkWindow(costmap, 0, costmap.getSizeInCellsX(), 0, costmap.getSizeInCellsY());
+}
+
+} /* namespace base_local_planner */
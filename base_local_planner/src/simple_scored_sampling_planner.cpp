@@ -37,7 +37,10 @@
 
 #include <base_local_planner/simple_scored_sampling_planner.h>
 
+#include <algorithm>
+
 #include <ros/console.h>
+#include <ros/time.h>
 
 namespace base_local_planner {
   
@@ -45,19 +48,92 @@ namespace base_local_planner {
     max_samples_ = max_samples;
     gen_list_ = gen_list;
     critics_ = critics;
+    auto_order_ = true;
+    scored_count_ = 0;
+    stats_.resize(critics_.size());
+    for (unsigned int i = 0; i < critics_.size(); ++i) {
+      given_order_.push_back(i);
+    }
+    order_ = given_order_;
+  }
+
+  namespace {
+    // expected time spent per trajectory this critic discards; critics that never reject sort by their cost alone
+    double criticRank(const SimpleScoredSamplingPlanner::CriticStats& stats) {
+      if (stats.calls == 0) {
+        // run critics we know nothing about early so that they get measured
+        return 0.0;
+      }
+      return (stats.seconds / stats.calls) / (stats.rejections / stats.calls + 0.01);
+    }
+
+    struct RankLess {
+      explicit RankLess(const std::vector<SimpleScoredSamplingPlanner::CriticStats>& stats) : stats_(stats) {}
+      bool operator()(unsigned int a, unsigned int b) const {
+        return criticRank(stats_[a]) < criticRank(stats_[b]);
+      }
+      const std::vector<SimpleScoredSamplingPlanner::CriticStats>& stats_;
+    };
+
+    bool cheaperTrajectory(const Trajectory& a, const Trajectory& b) {
+      return a.cost_ < b.cost_;
+    }
+  }
+
+  void SimpleScoredSamplingPlanner::setCriticStats(const std::vector<CriticStats>& stats) {
+    if (stats.size() != critics_.size()) {
+      ROS_ERROR("Got statistics for %u critics, but the planner has %u", (unsigned int)stats.size(), (unsigned int)critics_.size());
+      return;
+    }
+    stats_ = stats;
+  }
+
+  void SimpleScoredSamplingPlanner::setAutoOrderCritics(bool auto_order) {
+    auto_order_ = auto_order;
+    if (!auto_order_) {
+      order_ = given_order_;
+    }
+  }
+
+  void SimpleScoredSamplingPlanner::orderCritics() {
+    const double max_calls = 65536;
+    for (unsigned int i = 0; i < stats_.size(); ++i) {
+      if (stats_[i].calls > max_calls) {
+        stats_[i].calls *= 0.5;
+        stats_[i].rejections *= 0.5;
+        stats_[i].seconds *= 0.5;
+      }
+    }
+    std::stable_sort(order_.begin(), order_.end(), RankLess(stats_));
   }
 
   double SimpleScoredSamplingPlanner::scoreTrajectory(Trajectory& traj, double best_traj_cost) {
+    return scoreTrajectory(traj, best_traj_cost, given_order_);
+  }
+
+  double SimpleScoredSamplingPlanner::scoreTrajectory(Trajectory& traj, double best_traj_cost,
+      const std::vector<unsigned int>& order) {
+    // time a sample of the trajectories and count each measurement for the ones in between
+    bool timed = scored_count_++ % TIMING_INTERVAL == 0;
     double traj_cost = 0;
-    int gen_id = 0;
-    for(std::vector<TrajectoryCostFunction*>::iterator score_function = critics_.begin(); score_function != critics_.end(); ++score_function) {
-      TrajectoryCostFunction* score_function_p = *score_function;
+    for (std::vector<unsigned int>::const_iterator index = order.begin(); index != order.end(); ++index) {
+      TrajectoryCostFunction* score_function_p = critics_[*index];
       if (score_function_p->getScale() == 0) {
         continue;
       }
-      double cost = score_function_p->scoreTrajectory(traj);
+      CriticStats& stats = stats_[*index];
+      double cost;
+      if (timed) {
+        ros::WallTime start = ros::WallTime::now();
+        cost = score_function_p->scoreTrajectory(traj);
+        stats.seconds += (ros::WallTime::now() - start).toSec() * TIMING_INTERVAL;
+      } else {
+        cost = score_function_p->scoreTrajectory(traj);
+      }
+      stats.calls += 1;
       if (cost < 0) {
-        ROS_DEBUG("Velocity %.3lf, %.3lf, %.3lf discarded by cost function  %d with cost: %f", traj.xv_, traj.yv_, traj.thetav_, gen_id, cost);
+        stats.rejections += 1;
+        ROS_DEBUG("Velocity %.3lf, %.3lf, %.3lf discarded by cost function  %u with cost: %f", traj.xv_, traj.yv_, traj.thetav_, *index, cost);
         traj_cost = cost;
         break;
       }
@@ -71,7 +147,6 @@ namespace base_local_planner {
           break;
         }
       }
-      gen_id ++;
     }
 
 
@@ -79,6 +154,11 @@ namespace base_local_planner {
   }
 
   bool SimpleScoredSamplingPlanner::findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored) {
+    return findBestTrajectory(traj, all_explored, 0);
+  }
+
+  bool SimpleScoredSamplingPlanner::findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored,
+      unsigned int max_explored) {
     Trajectory loop_traj;
     Trajectory best_traj;
     double loop_traj_cost, best_traj_cost = -1;
@@ -91,6 +171,11 @@ namespace base_local_planner {
         return false;
       }
     }
+    if (auto_order_) {
+      orderCritics();
+    }
+    // the explored trajectories report the codes of rejected ones, which depend on the order
+    const std::vector<unsigned int>& order = all_explored != NULL && max_explored == 0 ? given_order_ : order_;
 
     for (std::vector<TrajectorySampleGenerator*>::iterator loop_gen = gen_list_.begin(); loop_gen != gen_list_.end(); ++loop_gen) {
       count = 0;
@@ -102,10 +187,22 @@ namespace base_local_planner {
           // TODO use this for debugging
           continue;
         }
-        loop_traj_cost = scoreTrajectory(loop_traj, best_traj_cost);
+        loop_traj_cost = scoreTrajectory(loop_traj, best_traj_cost, order);
         if (all_explored != NULL) {
           loop_traj.cost_ = loop_traj_cost;
-          all_explored->push_back(loop_traj);
+          if (max_explored == 0) {
+            all_explored->push_back(loop_traj);
+          } else if (loop_traj_cost >= 0) {
+            // keep the cheapest ones in a heap with the most expensive one on top
+            if (all_explored->size() < max_explored) {
+              all_explored->push_back(loop_traj);
+              std::push_heap(all_explored->begin(), all_explored->end(), cheaperTrajectory);
+            } else if (loop_traj_cost < all_explored->front().cost_) {
+              std::pop_heap(all_explored->begin(), all_explored->end(), cheaperTrajectory);
+              all_explored->back() = loop_traj;
+              std::push_heap(all_explored->begin(), all_explored->end(), cheaperTrajectory);
+            }
+          }
         }
 
         if (loop_traj_cost >= 0) {
@@ -37,6 +37,7 @@
 
 #include <base_local_planner/simple_trajectory_generator.h>
 
+#include <algorithm>
 #include <cmath>
 
 #include <base_local_planner/velocity_iterator.h>
@@ -75,7 +76,6 @@ void SimpleTrajectoryGenerator::initialise(
   vel_ = vel;
   limits_ = limits;
   next_sample_index_ = 0;
-  sample_params_.clear();
 
   double min_vel_x = limits->min_vel_x;
   double max_vel_x = limits->max_vel_x;
@@ -114,6 +114,15 @@ void SimpleTrajectoryGenerator::initialise(
       min_vel[2] = std::max(min_vel_th, vel[2] - acc_lim[2] * sim_period_);
     }
 
+    if (use_velocity_lattice_ && generateLatticeSamples(min_vel, max_vel,
+        Eigen::Vector3f(limits->min_vel_x, limits->min_vel_y, min_vel_th),
+        Eigen::Vector3f(limits->max_vel_x, limits->max_vel_y, max_vel_th),
+        acc_lim, vsamples)) {
+      return;
+    }
+
+    lattice_samples_valid_ = false;
+    sample_params_.clear();
     Eigen::Vector3f vel_samp = Eigen::Vector3f::Zero();
     VelocityIterator x_it(min_vel[0], max_vel[0], vsamples[0]);
     VelocityIterator y_it(min_vel[1], max_vel[1], vsamples[1]);
@@ -131,7 +140,103 @@ void SimpleTrajectoryGenerator::initialise(
       }
       y_it.reset();
     }
+  } else {
+    lattice_samples_valid_ = false;
+    sample_params_.clear();
+  }
+}
+
+/**
+ * Rebuilds the lattice of one dimension if its limits or spacing changed.
+ * Returns false if the lattice cannot be used for these values.
+ */
+bool SimpleTrajectoryGenerator::updateLattice(unsigned int dim, double min, double max, double step) {
+  VelocityLattice& lattice = lattice_[dim];
+  if (!lattice.values.empty() && lattice.min == min && lattice.max == max && lattice.step == step) {
+    return true;
+  }
+  lattice.min = min;
+  lattice.max = max;
+  lattice.step = step;
+  lattice.values.clear();
+  lattice_samples_valid_ = false;
+
+  if (min > max) {
+    return false;
+  }
+  if (min == max) {
+    lattice.values.push_back(min);
+    return true;
+  }
+  // a spacing this fine means we would rather sample the window directly
+  if (!(step > 0.0) || (max - min) / step > 10000.0) {
+    return false;
+  }
+
+  // the lattice is anchored at zero so that stopping is always among the samples,
+  // the limits themselves are added as well
+  double eps = step * 1e-3;
+  lattice.values.push_back(min);
+  for (double k = std::ceil(min / step); k * step < max - eps; k += 1.0) {
+    if (k * step > min + eps) {
+      lattice.values.push_back(k * step);
+    }
   }
+  lattice.values.push_back(max);
+  return true;
+}
+
+/**
+ * Fills sample_params_ with the lattice velocities inside the window [min_vel, max_vel].
+ * Returns false if a dimension has no lattice or no lattice point in its window,
+ * in which case the window needs to be sampled directly.
+ */
+bool SimpleTrajectoryGenerator::generateLatticeSamples(
+    const Eigen::Vector3f& min_vel, const Eigen::Vector3f& max_vel,
+    const Eigen::Vector3f& limit_min_vel, const Eigen::Vector3f& limit_max_vel,
+    const Eigen::Vector3f& acc_lim, const Eigen::Vector3f& vsamples) {
+  double window_time = use_dwa_ ? sim_period_ : sim_time_;
+  unsigned int begin[3], end[3];
+  for (unsigned int dim = 0; dim < 3; ++dim) {
+    // spacing that gives vsamples over a full window, as VelocityIterator would
+    int num_samples = std::max(2, int(vsamples[dim]));
+    double step = 2.0 * acc_lim[dim] * window_time / (num_samples - 1);
+    if (!updateLattice(dim, limit_min_vel[dim], limit_max_vel[dim], step) || min_vel[dim] > max_vel[dim]) {
+      return false;
+    }
+    const std::vector<double>& values = lattice_[dim].values;
+    double eps = lattice_[dim].step * 1e-3;
+    begin[dim] = std::lower_bound(values.begin(), values.end(), min_vel[dim] - eps) - values.begin();
+    end[dim] = std::upper_bound(values.begin(), values.end(), max_vel[dim] + eps) - values.begin();
+    if (begin[dim] >= end[dim]) {
+      return false;
+    }
+  }
+
+  if (lattice_samples_valid_ &&
+      std::equal(begin, begin + 3, window_begin_) && std::equal(end, end + 3, window_end_)) {
+    // same window as before, only drop what was added after the lattice samples
+    sample_params_.resize(lattice_sample_count_);
+    return true;
+  }
+
+  sample_params_.clear();
+  Eigen::Vector3f vel_samp;
+  for (unsigned int x = begin[0]; x < end[0]; ++x) {
+    vel_samp[0] = lattice_[0].values[x];
+    for (unsigned int y = begin[1]; y < end[1]; ++y) {
+      vel_samp[1] = lattice_[1].values[y];
+      for (unsigned int th = begin[2]; th < end[2]; ++th) {
+        vel_samp[2] = lattice_[2].values[th];
+        sample_params_.push_back(vel_samp);
+      }
+    }
+  }
+  std::copy(begin, begin + 3, window_begin_);
+  std::copy(end, end + 3, window_end_);
+  lattice_sample_count_ = sample_params_.size();
+  lattice_samples_valid_ = true;
+  return true;
 }
 
 void SimpleTrajectoryGenerator::setParameters(
@@ -146,6 +251,22 @@ void SimpleTrajectoryGenerator::setParameters(
   use_dwa_ = use_dwa;
   continued_acceleration_ = ! use_dwa_;
   sim_period_ = sim_period;
+  lattice_samples_valid_ = false;
+  rollout_cache_.clear();
+}
+
+void SimpleTrajectoryGenerator::setRolloutCache(bool enabled, unsigned int capacity) {
+  use_rollout_cache_ = enabled;
+  rollout_cache_capacity_ = capacity;
+  rollout_cache_.clear();
+}
+
+std::size_t SimpleTrajectoryGenerator::RolloutKeyHash::operator()(const RolloutKey& key) const {
+  std::size_t seed = 0;
+  for (unsigned int i = 0; i < 3; ++i) {
+    boost::hash_combine(seed, key.sample[i]);
+  }
+  return seed;
 }
 
 /**
@@ -160,7 +281,7 @@ bool SimpleTrajectoryGenerator::hasMoreTrajectories() {
  */
 bool SimpleTrajectoryGenerator::nextTrajectory(Trajectory &comp_traj) {
   bool result = false;
-  if (hasMoreTrajectories()) {
+  if (hasMoreTrajectories() && !isPruned(sample_params_[next_sample_index_])) {
     if (generateTrajectory(
         pos_,
         vel_,
@@ -199,6 +320,65 @@ bool SimpleTrajectoryGenerator::generateTrajectory(
     return false;
   }
 
+  // rollouts that keep accelerating depend on the current velocity, so they are not cached
+  if (!use_rollout_cache_ || continued_acceleration_) {
+    return simulateTrajectory(pos, vel, sample_target_vel, traj);
+  }
+
+  // move the rollout from the robot frame to the current pose
+  const Trajectory& rollout = cachedRollout(sample_target_vel);
+  traj.time_delta_ = rollout.time_delta_;
+  traj.xv_ = rollout.xv_;
+  traj.yv_ = rollout.yv_;
+  traj.thetav_ = rollout.thetav_;
+  double cos_th = cos(pos[2]);
+  double sin_th = sin(pos[2]);
+  double x, y, th;
+  for (unsigned int i = 0; i < rollout.getPointsSize(); ++i) {
+    rollout.getPoint(i, x, y, th);
+    traj.addPoint(pos[0] + cos_th * x - sin_th * y, pos[1] + sin_th * x + cos_th * y, pos[2] + th);
+  }
+  return rollout.getPointsSize() > 0;
+}
+
+/**
+ * The rollout of a sample starting at the origin, simulated on first use
+ */
+const Trajectory& SimpleTrajectoryGenerator::cachedRollout(const Eigen::Vector3f& sample_target_vel) {
+  Eigen::Vector3f acc_lim = limits_->getAccLimits();
+  if (rollout_discretize_by_time_ != discretize_by_time_ || rollout_acc_lim_ != acc_lim) {
+    rollout_cache_.clear();
+    rollout_discretize_by_time_ = discretize_by_time_;
+    rollout_acc_lim_ = acc_lim;
+  }
+
+  RolloutKey key;
+  for (unsigned int i = 0; i < 3; ++i) {
+    key.sample[i] = sample_target_vel[i];
+  }
+
+  boost::unordered_map<RolloutKey, Trajectory, RolloutKeyHash>::iterator it = rollout_cache_.find(key);
+  if (it != rollout_cache_.end()) {
+    return it->second;
+  }
+  if (rollout_cache_.size() >= rollout_cache_capacity_) {
+    rollout_cache_.clear();
+  }
+  Trajectory& rollout = rollout_cache_[key];
+  // with dwa the velocity of the sample is kept from the start, whatever the current velocity
+  simulateTrajectory(Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), sample_target_vel, rollout);
+  return rollout;
+}
+
+/**
+ * Integrates the motion towards sample_target_vel step by step
+ */
+bool SimpleTrajectoryGenerator::simulateTrajectory(
+      Eigen::Vector3f pos,
+      Eigen::Vector3f vel,
+      Eigen::Vector3f sample_target_vel,
+      base_local_planner::Trajectory& traj) {
+  double vmag = hypot(sample_target_vel[0], sample_target_vel[1]);
   int num_steps;
   if (discretize_by_time_) {
     num_steps = ceil(sim_time_ / sim_granularity_);
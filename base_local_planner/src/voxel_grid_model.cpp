@@ -35,6 +35,7 @@
 * Author: Eitan Marder-Eppstein
 *********************************************************************/
 #include <base_local_planner/voxel_grid_model.h>
+#include <algorithm>
 
 using namespace std;
 using namespace costmap_2d;
@@ -44,7 +45,12 @@ namespace base_local_planner {
           double origin_x, double origin_y, double origin_z, double max_z, double obstacle_range) :
     obstacle_grid_(size_x, size_y, size_z), xy_resolution_(xy_resolution), z_resolution_(z_resolution), 
     origin_x_(origin_x), origin_y_(origin_y), origin_z_(origin_z),
-    max_z_(max_z), sq_obstacle_range_(obstacle_range * obstacle_range) {}
+    max_z_(max_z), sq_obstacle_range_(obstacle_range * obstacle_range) {
+    words_per_row_ = (obstacle_grid_.sizeX() + 63) / 64;
+    column_bits_.assign(words_per_row_ * obstacle_grid_.sizeY(), 0);
+    //the grid starts out unknown, which the bitmap has to show before the first update
+    updateColumnBits();
+  }
 
   double VoxelGridModel::footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint, 
       double inscribed_radius, double circumscribed_radius){
@@ -103,7 +109,6 @@ namespace base_local_planner {
     int den, num, numadd, numpixels;
 
     double line_cost = 0.0;
-    double point_cost = -1.0;
 
     if (x1 >= x0)                 // The x-values are increasing
     {
@@ -146,15 +151,20 @@ namespace base_local_planner {
       numpixels = deltay;         // There are more y-values than x-values
     }
 
+    //cells are collected into runs along a row and each run is checked at once
+    int run_y = y, run_min = x, run_max = x;
     for (int curpixel = 0; curpixel <= numpixels; curpixel++)
     {
-      point_cost = pointCost(x, y); //Score the current point
-
-      if(point_cost < 0)
-        return -1;
-
-      if(line_cost < point_cost)
-        line_cost = point_cost;
+      if(y != run_y){
+        if(!runFree(run_y, run_min, run_max))
+          return -1;
+        run_y = y;
+        run_min = run_max = x;
+      }
+      else{
+        run_min = std::min(run_min, x);
+        run_max = std::max(run_max, x);
+      }
 
       num += numadd;              // Increase the numerator by the top of the fraction
       if (num >= den)             // Check if numerator >= denominator
@@ -167,18 +177,62 @@ namespace base_local_planner {
       y += yinc2;                 // Change the y as appropriate
     }
 
+    if(!runFree(run_y, run_min, run_max))
+      return -1;
+
+    line_cost = 1.0;
     return line_cost;
   }
 
   double VoxelGridModel::pointCost(int x, int y){
     //if the cell is in an obstacle the path is invalid
-    if(obstacle_grid_.getVoxelColumn(x, y)){
+    if(!runFree(y, x, x)){
       return -1;
     }
 
     return 1;
   }
 
+  bool VoxelGridModel::runFree(int y, int x0, int x1){
+    //anything outside of the grid counts as an obstacle
+    if(x0 < 0 || y < 0 || x1 >= (int)obstacle_grid_.sizeX() || y >= (int)obstacle_grid_.sizeY())
+      return false;
+
+    const uint64_t* row = &column_bits_[y * words_per_row_];
+    unsigned int w0 = x0 >> 6, w1 = x1 >> 6;
+    uint64_t first_mask = ~(uint64_t)0 << (x0 & 63);
+    uint64_t last_mask = ~(uint64_t)0 >> (63 - (x1 & 63));
+
+    if(w0 == w1)
+      return (row[w0] & first_mask & last_mask) == 0;
+
+    if(row[w0] & first_mask)
+      return false;
+    for(unsigned int w = w0 + 1; w < w1; ++w){
+      if(row[w])
+        return false;
+    }
+    return (row[w1] & last_mask) == 0;
+  }
+
+  void VoxelGridModel::updateColumnBits(){
+    unsigned int size_x = obstacle_grid_.sizeX(), size_y = obstacle_grid_.sizeY();
+    const uint32_t* data = obstacle_grid_.getData();
+
+    //a column is free only if it has neither marked nor unknown voxels, which means all of its bits are clear
+    for(unsigned int y = 0; y < size_y; ++y){
+      uint64_t* row = &column_bits_[y * words_per_row_];
+      const uint32_t* col = data + y * size_x;
+      for(unsigned int w = 0; w < words_per_row_; ++w){
+        unsigned int x_end = std::min(size_x, (w + 1) * 64);
+        uint64_t word = 0;
+        for(unsigned int x = w * 64; x < x_end; ++x)
+          word |= (uint64_t)(col[x] != 0) << (x & 63);
+        row[w] = word;
+      }
+    }
+  }
+
   void VoxelGridModel::updateWorld(const std::vector<geometry_msgs::Point>& footprint, 
       const vector<Observation>& observations, const vector<PlanarLaserScan>& laser_scans){
 
@@ -210,6 +264,8 @@ namespace base_local_planner {
 
     //remove the points that are in the footprint of the robot
     //removePointsInPolygon(footprint);
+
+    updateColumnBits();
   }
 
   void VoxelGridModel::removePointsInScanBoundry(const PlanarLaserScan& laser_scan, double raytrace_range){
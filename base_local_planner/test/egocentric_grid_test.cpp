@@ -0,0 +1,156 @@
+/*
+ * egocentric_grid_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/egocentric_grid.h>
+#include <base_local_planner/obstacle_cost_function.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+struct CostValue {
+  explicit CostValue(const costmap_2d::Costmap2D& costmap) : costmap_(costmap) {}
+  int operator()(int mx, int my) const { return costmap_.getCost(mx, my); }
+  const costmap_2d::Costmap2D& costmap_;
+};
+
+// a 4m x 4m map with a different cost in every cell
+static void fillCostmap(costmap_2d::Costmap2D& costmap) {
+  for (unsigned int my = 0; my < costmap.getSizeInCellsY(); ++my) {
+    for (unsigned int mx = 0; mx < costmap.getSizeInCellsX(); ++mx) {
+      costmap.setCost(mx, my, (mx * 7 + my * 3) % 200);
+    }
+  }
+}
+
+TEST(EgocentricGrid, follows_the_robot_heading) {
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  fillCostmap(costmap);
+
+  double headings[] = {0.0, M_PI_2, -2.4};
+  for (unsigned int h = 0; h < 3; ++h) {
+    EgocentricGrid<int> grid;
+    grid.resample(costmap, 2.0, 2.0, headings[h], 1.0, CostValue(costmap), -1);
+    EXPECT_EQ(20, grid.getSize());
+
+    // cell centers of the grid land in the costmap cell below them
+    for (double rx = -0.95; rx < 1.0; rx += 0.1) {
+      for (double ry = -0.95; ry < 1.0; ry += 0.1) {
+        int cx, cy;
+        unsigned int mx, my;
+        ASSERT_TRUE(grid.robotToCell(rx, ry, cx, cy));
+        double wx = 2.0 + rx * cos(headings[h]) - ry * sin(headings[h]);
+        double wy = 2.0 + rx * sin(headings[h]) + ry * cos(headings[h]);
+        ASSERT_TRUE(costmap.worldToMap(wx, wy, mx, my));
+        EXPECT_EQ(costmap.getCost(mx, my), grid(cx, cy));
+
+        double back_x, back_y;
+        grid.worldToRobot(wx, wy, back_x, back_y);
+        EXPECT_NEAR(rx, back_x, 1e-9);
+        EXPECT_NEAR(ry, back_y, 1e-9);
+      }
+    }
+  }
+
+  int cx, cy;
+  EgocentricGrid<int> grid;
+  grid.resample(costmap, 2.0, 2.0, 0.0, 1.0, CostValue(costmap), -1);
+  EXPECT_FALSE(grid.robotToCell(1.05, 0.0, cx, cy));
+  EXPECT_FALSE(grid.robotToCell(0.0, -1.05, cx, cy));
+
+  // cells beyond the costmap get the outside value
+  grid.resample(costmap, 0.2, 0.2, 0.0, 1.0, CostValue(costmap), -1);
+  ASSERT_TRUE(grid.robotToCell(-0.5, 0.05, cx, cy));
+  EXPECT_EQ(-1, grid(cx, cy));
+}
+
+TEST(EgocentricGrid, max_resampling_keeps_a_lethal_cell_under_rotation) {
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  costmap.setCost(23, 21, costmap_2d::LETHAL_OBSTACLE);
+
+  EgocentricGrid<int> nearest, covering;
+  nearest.resample(costmap, 2.0, 2.0, M_PI_4, 1.0, CostValue(costmap), -1);
+  covering.resampleMax(costmap, 2.0, 2.0, M_PI_4, 1.0, CostValue(costmap), -1);
+
+  // every point of the lethal cell has to land on a lethal cell of the grid
+  unsigned int missed_nearest = 0, missed_covering = 0;
+  for (double wx = 2.301; wx < 2.4; wx += 0.01) {
+    for (double wy = 2.101; wy < 2.2; wy += 0.01) {
+      double rx, ry;
+      int cx, cy;
+      covering.worldToRobot(wx, wy, rx, ry);
+      ASSERT_TRUE(covering.robotToCell(rx, ry, cx, cy));
+      if (nearest(cx, cy) != costmap_2d::LETHAL_OBSTACLE)
+        missed_nearest++;
+      if (covering(cx, cy) != costmap_2d::LETHAL_OBSTACLE)
+        missed_covering++;
+    }
+  }
+  EXPECT_GT(missed_nearest, 0u);
+  EXPECT_EQ(0u, missed_covering);
+
+  // the obstacle only grows into the few grid cells around it
+  unsigned int lethal = 0;
+  for (int cy = 0; cy < covering.getSize(); ++cy) {
+    for (int cx = 0; cx < covering.getSize(); ++cx) {
+      if (covering(cx, cy) == costmap_2d::LETHAL_OBSTACLE)
+        lethal++;
+      else
+        EXPECT_EQ(0, covering(cx, cy));
+    }
+  }
+  EXPECT_LE(lethal, 9u);
+}
+
+TEST(EgocentricGrid, obstacle_costs_match_the_costmap) {
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  fillCostmap(costmap);
+  costmap.setCost(27, 21, costmap_2d::LETHAL_OBSTACLE);
+
+  std::vector<geometry_msgs::Point> footprint(4);
+  footprint[0].x = 0.25;  footprint[0].y = 0.15;
+  footprint[1].x = -0.25; footprint[1].y = 0.15;
+  footprint[2].x = -0.25; footprint[2].y = -0.15;
+  footprint[3].x = 0.25;  footprint[3].y = -0.15;
+
+  ObstacleCostFunction direct(&costmap), egocentric(&costmap);
+  direct.setParams(1.0, 0.0, 1.0);
+  direct.setFootprint(footprint);
+  direct.setSumScores(true);
+  egocentric.setParams(1.0, 0.0, 1.0);
+  egocentric.setFootprint(footprint);
+  egocentric.setSumScores(true);
+  // the robot sits on a cell corner, so both grids share their cells
+  egocentric.setEgocentric(true, 1.0);
+  egocentric.setRobotPose(2.0, 2.0, 0.0);
+  ASSERT_TRUE(direct.prepare());
+  ASSERT_TRUE(egocentric.prepare());
+
+  double headings[] = {0.0, 0.3, -1.1, 2.0};
+  for (unsigned int h = 0; h < 4; ++h) {
+    Trajectory traj(0.3, 0.0, 0.0, 0.1, 0);
+    for (unsigned int i = 0; i < 16; ++i) {
+      // the last points leave the grid and are checked in the costmap
+      traj.addPoint(2.03 + 0.07 * i * cos(headings[h]), 2.01 + 0.07 * i * sin(headings[h]), headings[h] + 0.02 * i);
+    }
+    EXPECT_DOUBLE_EQ(direct.scoreTrajectory(traj), egocentric.scoreTrajectory(traj));
+  }
+
+  // the lethal cell is found in the grid as well
+  Trajectory blocked(0.3, 0.0, 0.0, 0.1, 0);
+  blocked.addPoint(2.98, 2.13, 0.0);
+  EXPECT_EQ(-6.0, direct.scoreTrajectory(blocked));
+  EXPECT_EQ(-6.0, egocentric.scoreTrajectory(blocked));
+
+  // a center off the map is reported as such by both, with the grid reaching past the map
+  egocentric.setRobotPose(0.3, 2.0, 0.0);
+  ASSERT_TRUE(egocentric.prepare());
+  Trajectory off_map(0.3, 0.0, 0.0, 0.1, 0);
+  off_map.addPoint(-0.25, 2.05, 0.0);
+  EXPECT_EQ(-7.0, direct.scoreTrajectory(off_map));
+  EXPECT_EQ(-7.0, egocentric.scoreTrajectory(off_map));
+}
+
+}
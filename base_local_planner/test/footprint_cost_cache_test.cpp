@@ -0,0 +1,122 @@
+/*
+ * footprint_cost_cache_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_cost_cache.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+static std::vector<geometry_msgs::Point> squareFootprint(double half_size) {
+  std::vector<geometry_msgs::Point> footprint(4);
+  footprint[0].x = half_size;  footprint[0].y = half_size;
+  footprint[1].x = -half_size; footprint[1].y = half_size;
+  footprint[2].x = -half_size; footprint[2].y = -half_size;
+  footprint[3].x = half_size;  footprint[3].y = -half_size;
+  return footprint;
+}
+
+TEST(FootprintCostCache, keys_on_revision_pose_and_footprint) {
+  FootprintCostCache cache(16, 0.01, 0.01);
+  std::vector<geometry_msgs::Point> small = squareFootprint(0.2), large = squareFootprint(0.3);
+  double cost = 0.0;
+
+  EXPECT_FALSE(cache.lookup(1, 1.0, 2.0, 0.5, small, cost));
+  cache.insert(1, 1.0, 2.0, 0.5, small, 42.0);
+  EXPECT_TRUE(cache.lookup(1, 1.0, 2.0, 0.5, small, cost));
+  EXPECT_EQ(42.0, cost);
+  // poses within the same quantum share the entry
+  EXPECT_TRUE(cache.lookup(1, 1.002, 1.998, 0.501, small, cost));
+
+  EXPECT_FALSE(cache.lookup(1, 1.02, 2.0, 0.5, small, cost));
+  EXPECT_FALSE(cache.lookup(1, 1.0, 2.0, 0.52, small, cost));
+  EXPECT_FALSE(cache.lookup(1, 1.0, 2.0, 0.5, large, cost));
+  EXPECT_EQ(2u, cache.getHits());
+
+  // a new revision drops everything
+  EXPECT_FALSE(cache.lookup(2, 1.0, 2.0, 0.5, small, cost));
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST(FootprintCostCache, evicts_least_recently_used) {
+  FootprintCostCache cache(2, 0.01, 0.01);
+  std::vector<geometry_msgs::Point> footprint = squareFootprint(0.2);
+  double cost;
+
+  cache.insert(1, 0.0, 0.0, 0.0, footprint, 1.0);
+  cache.insert(1, 1.0, 0.0, 0.0, footprint, 2.0);
+  EXPECT_TRUE(cache.lookup(1, 0.0, 0.0, 0.0, footprint, cost));
+  cache.insert(1, 2.0, 0.0, 0.0, footprint, 3.0);
+
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.lookup(1, 0.0, 0.0, 0.0, footprint, cost));
+  EXPECT_FALSE(cache.lookup(1, 1.0, 0.0, 0.0, footprint, cost));
+  EXPECT_TRUE(cache.lookup(1, 2.0, 0.0, 0.0, footprint, cost));
+  EXPECT_EQ(3.0, cost);
+}
+
+TEST(FootprintCostCache, models_of_a_costmap_share_results) {
+  costmap_2d::Costmap2D costmap(100, 100, 0.05, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  CostmapModel first(costmap), second(costmap);
+  boost::shared_ptr<FootprintCostCache> cache = FootprintCostCache::forCostmap(costmap);
+  std::vector<geometry_msgs::Point> footprint = squareFootprint(0.2);
+
+  EXPECT_EQ(0.0, first.footprintCost(2.5, 2.5, 0.0, footprint));
+  unsigned long hits = cache->getHits();
+  EXPECT_EQ(0.0, second.footprintCost(2.5, 2.5, 0.0, footprint));
+  EXPECT_EQ(hits + 1, cache->getHits());
+
+  // changing the costmap invalidates what was cached for it
+  costmap.setCost(54, 50, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(-1.0, second.footprintCost(2.5, 2.5, 0.0, footprint));
+
+  // other costmaps have caches of their own
+  costmap_2d::Costmap2D other(100, 100, 0.05, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  EXPECT_NE(cache, FootprintCostCache::forCostmap(other));
+}
+
+
+TEST(FootprintCostCache, moving_the_origin_invalidates_results) {
+  costmap_2d::Costmap2D costmap(100, 100, 0.05, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  CostmapModel model(costmap);
+  std::vector<geometry_msgs::Point> footprint = squareFootprint(0.2);
+
+  // off the map at first
+  EXPECT_EQ(-1.0, model.footprintCost(5.2, 2.5, 0.0, footprint));
+  // the window follows the robot and now covers the pose
+  uint64_t revision = costmap.getRevision();
+  costmap.updateOrigin(0.5, 0.0);
+  EXPECT_NE(revision, costmap.getRevision());
+  EXPECT_EQ(0.0, model.footprintCost(5.2, 2.5, 0.0, footprint));
+}
+
+TEST(FootprintCostCache, footprints_are_compared_by_value) {
+  FootprintCostCache cache(16, 0.01, 0.01);
+  std::vector<geometry_msgs::Point> footprint = squareFootprint(0.2);
+  double cost;
+
+  cache.insert(1, 0.0, 0.0, 0.0, footprint, 5.0);
+  std::vector<geometry_msgs::Point> moved = footprint;
+  moved[2].x -= 1e-6;
+  EXPECT_FALSE(cache.lookup(1, 0.0, 0.0, 0.0, moved, cost));
+  std::vector<geometry_msgs::Point> copy = squareFootprint(0.2);
+  EXPECT_TRUE(cache.lookup(1, 0.0, 0.0, 0.0, copy, cost));
+  EXPECT_EQ(5.0, cost);
+}
+
+TEST(FootprintCostCache, released_caches_are_forgotten) {
+  costmap_2d::Costmap2D costmap(10, 10, 0.05, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  boost::shared_ptr<FootprintCostCache> cache = FootprintCostCache::forCostmap(costmap);
+  std::vector<geometry_msgs::Point> footprint = squareFootprint(0.2);
+  cache->insert(costmap.getRevision(), 0.0, 0.0, 0.0, footprint, 5.0);
+  EXPECT_EQ(cache, FootprintCostCache::forCostmap(costmap));
+
+  // once the last user is gone the next one starts from an empty cache
+  cache.reset();
+  EXPECT_EQ(0u, FootprintCostCache::forCostmap(costmap)->size());
+}
+
+}
@@ -0,0 +1,84 @@
+/*
+ * odometry_helper_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/odometry_helper_ros.h>
+
+namespace base_local_planner {
+
+static void sendOdom(OdometryHelperRos& helper, double stamp, double vx, double vy, double vth) {
+  nav_msgs::Odometry::Ptr msg(new nav_msgs::Odometry);
+  msg->header.stamp = ros::Time(stamp);
+  msg->twist.twist.linear.x = vx;
+  msg->twist.twist.linear.y = vy;
+  msg->twist.twist.angular.z = vth;
+  helper.odomCallback(msg);
+}
+
+TEST(OdometryHelperRos, nothing_received) {
+  OdometryHelperRos helper;
+  OdometrySnapshot average;
+  EXPECT_FALSE(helper.getSnapshot(average));
+  EXPECT_FALSE(helper.getAverageVelocity(1.0, average));
+  EXPECT_EQ(0.0, average.vx);
+}
+
+TEST(OdometryHelperRos, averages_within_window) {
+  OdometryHelperRos helper;
+  sendOdom(helper, 1.0, 1.0, 0.0, 0.0);
+  sendOdom(helper, 2.0, 0.2, 0.1, 0.3);
+  sendOdom(helper, 2.1, 0.4, 0.3, 0.1);
+
+  OdometrySnapshot average;
+  ASSERT_TRUE(helper.getAverageVelocity(0.5, average));
+  EXPECT_NEAR(0.3, average.vx, 1e-9);
+  EXPECT_NEAR(0.2, average.vy, 1e-9);
+  EXPECT_NEAR(0.2, average.vth, 1e-9);
+  EXPECT_NEAR(2.1, average.stamp.toSec(), 1e-9);
+
+  ASSERT_TRUE(helper.getAverageVelocity(5.0, average));
+  EXPECT_NEAR(1.6 / 3, average.vx, 1e-9);
+
+  // the newest message is always used, even if the window is shorter than the message period
+  ASSERT_TRUE(helper.getAverageVelocity(0.0, average));
+  EXPECT_NEAR(0.4, average.vx, 1e-9);
+}
+
+TEST(OdometryHelperRos, history_wraps_around) {
+  OdometryHelperRos helper;
+  // more messages than the history holds, the oldest ones have been overwritten
+  for (int i = 0; i < 100; ++i) {
+    sendOdom(helper, i * 0.1, i, 0.0, 0.0);
+  }
+
+  OdometrySnapshot latest;
+  ASSERT_TRUE(helper.getSnapshot(latest));
+  EXPECT_EQ(99.0, latest.vx);
+
+  // a window reaching past the start only averages the 32 messages still kept, 68 to 99
+  OdometrySnapshot average;
+  ASSERT_TRUE(helper.getAverageVelocity(100.0, average));
+  EXPECT_NEAR(83.5, average.vx, 1e-9);
+
+  // 94 to 99, which lie on both sides of the end of the ring
+  ASSERT_TRUE(helper.getAverageVelocity(0.55, average));
+  EXPECT_NEAR(96.5, average.vx, 1e-9);
+}
+
+TEST(OdometryHelperRos, robot_vel_uses_average_window) {
+  OdometryHelperRos helper;
+  sendOdom(helper, 1.0, 0.2, 0.0, 0.0);
+  sendOdom(helper, 1.1, 0.4, 0.0, 0.0);
+
+  tf::Stamped<tf::Pose> robot_vel;
+  helper.getRobotVel(robot_vel);
+  EXPECT_NEAR(0.4, robot_vel.getOrigin().x(), 1e-9);
+
+  helper.setAverageWindow(0.5);
+  helper.getRobotVel(robot_vel);
+  EXPECT_NEAR(0.3, robot_vel.getOrigin().x(), 1e-9);
+}
+
+}
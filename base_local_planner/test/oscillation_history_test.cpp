@@ -0,0 +1,73 @@
+/*
+ * oscillation_history_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/oscillation_history.h>
+
+namespace base_local_planner {
+
+TEST(OscillationHistory, restricts_after_reversal) {
+  OscillationHistory history;
+  history.setResetDistance(0.5, 1.0);
+  Eigen::Vector3f pos = Eigen::Vector3f::Zero();
+
+  history.push(pos, Eigen::Vector3f(0.2, 0, 0));
+  EXPECT_FALSE(history.hasRestrictions());
+  EXPECT_TRUE(history.isAllowed(Eigen::Vector3f(-0.2, 0, 0)));
+
+  history.push(pos, Eigen::Vector3f(-0.2, 0, 0));
+  EXPECT_TRUE(history.hasRestrictions());
+  EXPECT_EQ(1u, history.reversals(0));
+  EXPECT_TRUE(history.isAllowed(Eigen::Vector3f(-0.1, 0, 0.3)));
+  EXPECT_FALSE(history.isAllowed(Eigen::Vector3f(0.1, 0, 0)));
+
+  // moving away from where the reversal happened lifts the restriction
+  history.push(Eigen::Vector3f(-0.6, 0, 0), Eigen::Vector3f(-0.2, 0, 0));
+  EXPECT_FALSE(history.hasRestrictions());
+  EXPECT_TRUE(history.isAllowed(Eigen::Vector3f(0.1, 0, 0)));
+}
+
+TEST(OscillationHistory, rotation_only_tracked_when_not_translating) {
+  OscillationHistory history;
+  history.setResetDistance(0.5, 1.0);
+  Eigen::Vector3f pos = Eigen::Vector3f::Zero();
+
+  history.push(pos, Eigen::Vector3f(0.3, 0, 0.5), 0.1);
+  history.push(pos, Eigen::Vector3f(0.3, 0, -0.5), 0.1);
+  EXPECT_FALSE(history.hasRestrictions());
+
+  history.push(pos, Eigen::Vector3f(0, 0, 0.5), 0.1);
+  history.push(pos, Eigen::Vector3f(0, 0, -0.5), 0.1);
+  EXPECT_FALSE(history.isAllowed(Eigen::Vector3f(0, 0, 0.5)));
+  EXPECT_TRUE(history.isAllowed(Eigen::Vector3f(0, 0, -0.5)));
+}
+
+TEST(OscillationHistory, reversal_counts_follow_the_window) {
+  OscillationHistory history(4);
+  history.setResetDistance(100.0, 100.0);
+  Eigen::Vector3f pos = Eigen::Vector3f::Zero();
+
+  float v = 0.1;
+  for (int i = 0; i < 4; ++i, v = -v) {
+    history.push(pos, Eigen::Vector3f(v, 0, 0));
+  }
+  EXPECT_EQ(4u, history.size());
+  EXPECT_EQ(3u, history.reversals(0));
+
+  // keep going in the last direction until the reversals have left the ring
+  for (int i = 0; i < 4; ++i) {
+    history.push(pos, Eigen::Vector3f(-v, 0, 0));
+  }
+  EXPECT_EQ(4u, history.size());
+  EXPECT_EQ(0u, history.reversals(0));
+}
+
+TEST(OscillationHistory, progress_distance) {
+  OscillationHistory history;
+  history.setProgressPose(Eigen::Vector3f(1, 1, 0));
+  EXPECT_NEAR(5.0, history.progressDistance(Eigen::Vector3f(4, 5, 2)), 1e-6);
+}
+
+}
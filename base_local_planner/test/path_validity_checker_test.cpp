@@ -0,0 +1,76 @@
+/*
+ * path_validity_checker_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/path_validity_checker.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+static std::vector<geometry_msgs::PoseStamped> straightPlan(double y, unsigned int poses) {
+  std::vector<geometry_msgs::PoseStamped> plan(poses);
+  for (unsigned int i = 0; i < poses; ++i) {
+    plan[i].pose.position.x = 0.05 + 0.1 * i;
+    plan[i].pose.position.y = y;
+  }
+  return plan;
+}
+
+TEST(PathValidityChecker, finds_blockage_inside_window_only) {
+  costmap_2d::Costmap2D costmap(100, 100, 0.1, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  PathValidityChecker checker(8);
+  checker.setPlan(straightPlan(5.05, 100), costmap);
+  EXPECT_EQ(-1, checker.checkAll(costmap));
+  EXPECT_EQ(100u, checker.getCheckedCells());
+
+  costmap.setCost(60, 50, costmap_2d::LETHAL_OBSTACLE);
+  // a window away from the plan does not read any cell
+  EXPECT_EQ(-1, checker.checkWindow(costmap, 0, 100, 0, 40));
+  EXPECT_EQ(0u, checker.getCheckedCells());
+  // a window around the obstacle only reads the plan cells inside it
+  EXPECT_EQ(60, checker.checkWindow(costmap, 55, 65, 45, 55));
+  EXPECT_EQ(6u, checker.getCheckedCells());
+  // a window that misses the obstacle does not see it
+  EXPECT_EQ(-1, checker.checkWindow(costmap, 0, 50, 0, 100));
+}
+
+TEST(PathValidityChecker, ignores_low_unknown_and_passed_cells) {
+  costmap_2d::Costmap2D costmap(100, 100, 0.1, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  PathValidityChecker checker;
+  checker.setPlan(straightPlan(5.05, 100), costmap);
+
+  costmap.setCost(20, 50, costmap_2d::NO_INFORMATION);
+  costmap.setCost(30, 50, costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1);
+  EXPECT_EQ(-1, checker.checkAll(costmap));
+
+  costmap.setCost(40, 50, costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  EXPECT_EQ(40, checker.checkAll(costmap));
+
+  // once the robot is past the blockage it no longer counts
+  checker.updateProgress(4.5, 5.2);
+  EXPECT_EQ(-1, checker.checkAll(costmap));
+  EXPECT_EQ(55u, checker.getCheckedCells());
+
+  checker.setBlockingCost(costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1);
+  checker.setPlan(straightPlan(5.05, 100), costmap);
+  EXPECT_EQ(30, checker.checkAll(costmap));
+}
+
+TEST(PathValidityChecker, reindexes_when_costmap_moves) {
+  costmap_2d::Costmap2D costmap(100, 100, 0.1, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  PathValidityChecker checker;
+  checker.setPlan(straightPlan(5.05, 100), costmap);
+
+  costmap.updateOrigin(2.0, 0.0);
+  costmap.setCost(10, 50, costmap_2d::LETHAL_OBSTACLE);
+  // cell 10 is now at x = 3.05, the 31st pose; poses before x = 2 are off the map
+  EXPECT_EQ(30, checker.checkAll(costmap));
+
+  checker.clear();
+  EXPECT_FALSE(checker.hasPlan());
+  EXPECT_EQ(-1, checker.checkAll(costmap));
+}
+
+}
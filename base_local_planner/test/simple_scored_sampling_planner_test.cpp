@@ -0,0 +1,200 @@
+/*
+ * simple_scored_sampling_planner_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <base_local_planner/simple_scored_sampling_planner.h>
+
+namespace base_local_planner {
+
+namespace {
+
+// prefers slow trajectories
+class SpeedCost : public TrajectoryCostFunction {
+public:
+  SpeedCost() : calls(0) {}
+  bool prepare() { return true; }
+  double scoreTrajectory(Trajectory& traj) {
+    ++calls;
+    return traj.xv_;
+  }
+  int calls;
+};
+
+// rejects everything faster than a limit
+class SpeedLimit : public TrajectoryCostFunction {
+public:
+  SpeedLimit() : calls(0) {}
+  bool prepare() { return true; }
+  double scoreTrajectory(Trajectory& traj) {
+    ++calls;
+    return traj.xv_ > 5 ? -1.0 : 0.0;
+  }
+  int calls;
+};
+
+// rejects everything faster than a limit with its own code
+class CodedSpeedLimit : public TrajectoryCostFunction {
+public:
+  CodedSpeedLimit(double limit, double code) : limit(limit), code(code) {}
+  bool prepare() { return true; }
+  double scoreTrajectory(Trajectory& traj) {
+    return traj.xv_ > limit ? code : 0.0;
+  }
+  double limit, code;
+};
+
+class CountingGenerator : public TrajectorySampleGenerator {
+public:
+  CountingGenerator() : next(0) {}
+  bool hasMoreTrajectories() { return next < 10; }
+  bool nextTrajectory(Trajectory& traj) {
+    traj.resetPoints();
+    traj.xv_ = next++;
+    traj.yv_ = 0;
+    traj.thetav_ = 0;
+    return true;
+  }
+  int next;
+};
+
+}
+
+static SimpleScoredSamplingPlanner::CriticStats criticStats(double calls, double rejections, double seconds) {
+  SimpleScoredSamplingPlanner::CriticStats stats;
+  stats.calls = calls;
+  stats.rejections = rejections;
+  stats.seconds = seconds;
+  return stats;
+}
+
+TEST(SimpleScoredSamplingPlanner, cheap_rejecting_critic_runs_first) {
+  SpeedCost speed_cost;
+  SpeedLimit speed_limit;
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&speed_cost);
+  critics.push_back(&speed_limit);
+  CountingGenerator gen;
+  std::vector<TrajectorySampleGenerator*> gen_list(1, &gen);
+  SimpleScoredSamplingPlanner planner(gen_list, critics);
+
+  // the cost critic is known to be expensive, the limit to be cheap and to reject half of the samples;
+  // the time measured while planning is far too small to change that
+  std::vector<SimpleScoredSamplingPlanner::CriticStats> stats;
+  stats.push_back(criticStats(10, 0, 10.0));
+  stats.push_back(criticStats(10, 5, 0.001));
+  planner.setCriticStats(stats);
+
+  // so the limit gets to discard the fast samples first
+  Trajectory traj;
+  ASSERT_TRUE(planner.findBestTrajectory(traj));
+  EXPECT_EQ(0, traj.xv_);
+  EXPECT_EQ(6, speed_cost.calls);
+  EXPECT_EQ(10, speed_limit.calls);
+
+  const std::vector<SimpleScoredSamplingPlanner::CriticStats>& updated = planner.getCriticStats();
+  ASSERT_EQ(2u, updated.size());
+  EXPECT_EQ(16, updated[0].calls);
+  EXPECT_EQ(20, updated[1].calls);
+  EXPECT_EQ(9, updated[1].rejections);
+
+  // in configured order the expensive critic sees every sample
+  planner.setAutoOrderCritics(false);
+  gen.next = 0;
+  ASSERT_TRUE(planner.findBestTrajectory(traj));
+  EXPECT_EQ(0, traj.xv_);
+  EXPECT_EQ(16, speed_cost.calls);
+}
+
+TEST(SimpleScoredSamplingPlanner, unmeasured_critics_run_first) {
+  SpeedCost speed_cost;
+  SpeedLimit speed_limit;
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&speed_cost);
+  critics.push_back(&speed_limit);
+  CountingGenerator gen;
+  std::vector<TrajectorySampleGenerator*> gen_list(1, &gen);
+  SimpleScoredSamplingPlanner planner(gen_list, critics);
+
+  // nothing is known about the limit yet, so it is measured before the cost critic
+  std::vector<SimpleScoredSamplingPlanner::CriticStats> stats;
+  stats.push_back(criticStats(10, 0, 0.001));
+  stats.push_back(SimpleScoredSamplingPlanner::CriticStats());
+  planner.setCriticStats(stats);
+
+  Trajectory traj;
+  ASSERT_TRUE(planner.findBestTrajectory(traj));
+  EXPECT_EQ(6, speed_cost.calls);
+}
+
+TEST(SimpleScoredSamplingPlanner, explored_can_be_limited_to_the_cheapest) {
+  SpeedCost speed_cost;
+  SpeedLimit speed_limit;
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&speed_limit);
+  critics.push_back(&speed_cost);
+  CountingGenerator gen;
+  std::vector<TrajectorySampleGenerator*> gen_list(1, &gen);
+  SimpleScoredSamplingPlanner planner(gen_list, critics);
+  planner.setAutoOrderCritics(false);
+
+  Trajectory traj;
+  std::vector<Trajectory> explored;
+  ASSERT_TRUE(planner.findBestTrajectory(traj, &explored));
+  EXPECT_EQ(10u, explored.size());
+
+  explored.clear();
+  gen.next = 0;
+  ASSERT_TRUE(planner.findBestTrajectory(traj, &explored, 3));
+  ASSERT_EQ(3u, explored.size());
+  std::vector<double> speeds;
+  for (unsigned int i = 0; i < explored.size(); ++i) {
+    speeds.push_back(explored[i].xv_);
+  }
+  std::sort(speeds.begin(), speeds.end());
+  EXPECT_EQ(0, speeds[0]);
+  EXPECT_EQ(1, speeds[1]);
+  EXPECT_EQ(2, speeds[2]);
+  EXPECT_EQ(0, traj.xv_);
+}
+
+TEST(SimpleScoredSamplingPlanner, reported_codes_do_not_depend_on_the_order) {
+  CodedSpeedLimit loose(7, -2.0), tight(5, -3.0);
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&loose);
+  critics.push_back(&tight);
+  CountingGenerator gen;
+  std::vector<TrajectorySampleGenerator*> gen_list(1, &gen);
+  SimpleScoredSamplingPlanner planner(gen_list, critics);
+
+  // the tight limit rejects more samples for the same time, so it is ordered first
+  std::vector<SimpleScoredSamplingPlanner::CriticStats> stats;
+  stats.push_back(criticStats(10, 2, 1.0));
+  stats.push_back(criticStats(10, 4, 1.0));
+  planner.setCriticStats(stats);
+
+  Trajectory traj;
+  ASSERT_TRUE(planner.findBestTrajectory(traj));
+  // the loose limit only sees the samples the tight one let through
+  EXPECT_EQ(16, planner.getCriticStats()[0].calls);
+  EXPECT_EQ(20, planner.getCriticStats()[1].calls);
+
+  // but the explored trajectories carry the code of the first critic given that rejects them
+  std::vector<Trajectory> explored;
+  gen.next = 0;
+  ASSERT_TRUE(planner.findBestTrajectory(traj, &explored));
+  ASSERT_EQ(10u, explored.size());
+  EXPECT_EQ(0.0, explored[5].cost_);
+  EXPECT_EQ(-3.0, explored[6].cost_);
+  EXPECT_EQ(-2.0, explored[8].cost_);
+
+  // and so do single trajectories
+  traj.xv_ = 9;
+  EXPECT_EQ(-2.0, planner.scoreTrajectory(traj, -1));
+}
+
+}
@@ -22,5 +22,138 @@ public:
 
   virtual void TestBody(){}
 };
-  
+
+// exposes the samples generated by initialise
+class LatticeTrajectoryGenerator : public SimpleTrajectoryGenerator {
+public:
+  const std::vector<Eigen::Vector3f>& samples() const { return sample_params_; }
+};
+
+static std::vector<double> xSamples(const LatticeTrajectoryGenerator& tg) {
+  std::vector<double> result;
+  for (unsigned int i = 0; i < tg.samples().size(); ++i) {
+    result.push_back(tg.samples()[i][0]);
+  }
+  return result;
+}
+
+TEST(TrajectoryGeneratorTest, lattice_samples_follow_the_window) {
+  LatticeTrajectoryGenerator tg;
+  LocalPlannerLimits limits(0.5, 0.0, 0.5, 0.0, 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 1.0, 1.0, 0.1, 0.1);
+  tg.setParameters(1.0, 0.025, 0.1, true, 0.1);
+  tg.setUseVelocityLattice(true);
+  Eigen::Vector3f pos = Eigen::Vector3f::Zero();
+  Eigen::Vector3f goal(5.0, 0.0, 0.0);
+
+  // window [0.1, 0.3] with a lattice spacing of 0.05
+  tg.initialise(pos, Eigen::Vector3f(0.2, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1));
+  std::vector<double> xs = xSamples(tg);
+  ASSERT_EQ(5u, xs.size());
+  for (unsigned int i = 0; i < xs.size(); ++i) {
+    EXPECT_NEAR(0.1 + 0.05 * i, xs[i], 1e-6);
+  }
+
+  // a window between lattice points only keeps the ones inside it
+  tg.initialise(pos, Eigen::Vector3f(0.21, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1));
+  xs = xSamples(tg);
+  ASSERT_EQ(4u, xs.size());
+  EXPECT_NEAR(0.15, xs.front(), 1e-6);
+  EXPECT_NEAR(0.3, xs.back(), 1e-6);
+
+  // the limit is always part of the lattice
+  tg.initialise(pos, Eigen::Vector3f(0.47, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1));
+  xs = xSamples(tg);
+  ASSERT_EQ(3u, xs.size());
+  EXPECT_NEAR(0.4, xs.front(), 1e-6);
+  EXPECT_NEAR(0.5, xs.back(), 1e-6);
+}
+
+TEST(TrajectoryGeneratorTest, lattice_samples_are_reused_without_additional_samples) {
+  LatticeTrajectoryGenerator tg;
+  LocalPlannerLimits limits(0.5, 0.0, 0.5, 0.0, 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 1.0, 1.0, 0.1, 0.1);
+  tg.setParameters(1.0, 0.025, 0.1, true, 0.1);
+  tg.setUseVelocityLattice(true);
+  Eigen::Vector3f pos = Eigen::Vector3f::Zero();
+  Eigen::Vector3f goal(5.0, 0.0, 0.0);
+  std::vector<Eigen::Vector3f> additional(1, Eigen::Vector3f(0.0, 0.0, 0.5));
+
+  tg.initialise(pos, Eigen::Vector3f(0.2, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1), additional);
+  ASSERT_EQ(6u, tg.samples().size());
+  EXPECT_FLOAT_EQ(0.5, tg.samples().back()[2]);
+
+  // same window again, the additional sample is not added twice
+  tg.initialise(pos, Eigen::Vector3f(0.2, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1), additional);
+  EXPECT_EQ(6u, tg.samples().size());
+  tg.initialise(pos, Eigen::Vector3f(0.2, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1));
+  EXPECT_EQ(5u, tg.samples().size());
+
+  // without the lattice the window is sampled directly, theta gets -0.1, 0 and 0.1
+  tg.setUseVelocityLattice(false);
+  tg.initialise(pos, Eigen::Vector3f(0.21, 0.0, 0.0), goal, &limits, Eigen::Vector3f(5, 1, 1));
+  std::vector<double> xs = xSamples(tg);
+  ASSERT_EQ(15u, xs.size());
+  EXPECT_NEAR(0.11, xs.front(), 1e-6);
+  EXPECT_NEAR(0.31, xs.back(), 1e-6);
+}
+
+static void expectSameTrajectory(const Trajectory& expected, const Trajectory& actual) {
+  ASSERT_EQ(expected.getPointsSize(), actual.getPointsSize());
+  EXPECT_DOUBLE_EQ(expected.xv_, actual.xv_);
+  EXPECT_DOUBLE_EQ(expected.thetav_, actual.thetav_);
+  EXPECT_DOUBLE_EQ(expected.time_delta_, actual.time_delta_);
+  double ex, ey, eth, ax, ay, ath;
+  for (unsigned int i = 0; i < expected.getPointsSize(); ++i) {
+    expected.getPoint(i, ex, ey, eth);
+    actual.getPoint(i, ax, ay, ath);
+    EXPECT_NEAR(ex, ax, 1e-4);
+    EXPECT_NEAR(ey, ay, 1e-4);
+    EXPECT_NEAR(eth, ath, 1e-4);
+  }
+}
+
+TEST(TrajectoryGeneratorTest, cached_rollouts_match_simulated_ones) {
+  SimpleTrajectoryGenerator simulated, cached;
+  LocalPlannerLimits limits(0.5, 0.0, 0.5, 0.0, 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 1.0, 1.0, 0.1, 0.1);
+  simulated.setParameters(1.5, 0.025, 0.1, true, 0.1);
+  cached.setParameters(1.5, 0.025, 0.1, true, 0.1);
+  cached.setRolloutCache(true);
+  Eigen::Vector3f goal(5.0, 0.0, 0.0);
+  Eigen::Vector3f sample(0.3, 0.0, 0.4);
+
+  // the first rollout fills the cache, the others are hits from other poses and velocities
+  Eigen::Vector3f poses[] = {
+      Eigen::Vector3f(0.0, 0.0, 0.0),
+      Eigen::Vector3f(1.5, -2.0, 0.7),
+      Eigen::Vector3f(-3.0, 0.5, -2.5)};
+  for (unsigned int i = 0; i < 3; ++i) {
+    Eigen::Vector3f vel(0.25, 0.0, 0.1 * i);
+    simulated.initialise(poses[i], vel, goal, &limits, Eigen::Vector3f(3, 1, 3));
+    cached.initialise(poses[i], vel, goal, &limits, Eigen::Vector3f(3, 1, 3));
+    Trajectory expected, actual;
+    ASSERT_TRUE(simulated.generateTrajectory(poses[i], vel, sample, expected));
+    ASSERT_TRUE(cached.generateTrajectory(poses[i], vel, sample, actual));
+    expectSameTrajectory(expected, actual);
+  }
+
+  // the same sample again, after the cache was filled from several other samples
+  Eigen::Vector3f other(0.1, 0.0, -0.4);
+  Trajectory expected, actual;
+  ASSERT_TRUE(cached.generateTrajectory(poses[0], Eigen::Vector3f::Zero(), other, actual));
+  ASSERT_TRUE(simulated.generateTrajectory(poses[2], Eigen::Vector3f(0.05, 0.0, 0.3), sample, expected));
+  ASSERT_TRUE(cached.generateTrajectory(poses[2], Eigen::Vector3f(0.05, 0.0, 0.3), sample, actual));
+  expectSameTrajectory(expected, actual);
+
+  // rollouts that keep accelerating start from the exact current velocity, never a cached one
+  simulated.setParameters(1.5, 0.025, 0.1, false);
+  cached.setParameters(1.5, 0.025, 0.1, false);
+  for (unsigned int i = 0; i < 2; ++i) {
+    Eigen::Vector3f vel(0.2037 + 0.0013 * i, 0.0, -0.3041);
+    simulated.initialise(poses[1], vel, goal, &limits, Eigen::Vector3f(3, 1, 3));
+    cached.initialise(poses[1], vel, goal, &limits, Eigen::Vector3f(3, 1, 3));
+    ASSERT_TRUE(simulated.generateTrajectory(poses[1], vel, sample, expected));
+    ASSERT_TRUE(cached.generateTrajectory(poses[1], vel, sample, actual));
+    expectSameTrajectory(expected, actual);
+  }
+}
+
 }
@@ -0,0 +1,93 @@
+/*
+ * voxel_grid_model_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/voxel_grid_model.h>
+
+namespace base_local_planner {
+
+// 100 x 20 columns of 16 voxels, 0.1m each way
+static const unsigned int SIZE_X = 100, SIZE_Y = 20, SIZE_Z = 16;
+
+static std::vector<geometry_msgs::Point> box(double x0, double y0, double x1, double y1) {
+  std::vector<geometry_msgs::Point> footprint(4);
+  footprint[0].x = x0; footprint[0].y = y0;
+  footprint[1].x = x1; footprint[1].y = y0;
+  footprint[2].x = x1; footprint[2].y = y1;
+  footprint[3].x = x0; footprint[3].y = y1;
+  return footprint;
+}
+
+// one scan per row and height, clearing all but the last column
+static std::vector<PlanarLaserScan> clearingScans() {
+  std::vector<PlanarLaserScan> scans;
+  for (unsigned int z = 0; z < SIZE_Z; ++z) {
+    for (unsigned int y = 0; y < SIZE_Y; ++y) {
+      PlanarLaserScan scan;
+      scan.origin.x = 0.05;
+      scan.origin.y = y * 0.1 + 0.05;
+      scan.origin.z = z * 0.1 + 0.05;
+      geometry_msgs::Point32 point = scan.origin;
+      point.x = (SIZE_X - 2) * 0.1 + 0.05;
+      scan.cloud.points.push_back(point);
+      scans.push_back(scan);
+    }
+  }
+  return scans;
+}
+
+static costmap_2d::Observation obstacles(const std::vector<std::pair<double, double> >& points) {
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (unsigned int i = 0; i < points.size(); ++i)
+    cloud.points.push_back(pcl::PointXYZ(points[i].first, points[i].second, 0.55));
+  geometry_msgs::Point origin;
+  return costmap_2d::Observation(origin, cloud, 100.0, 100.0);
+}
+
+TEST(VoxelGridModel, unknown_columns_are_obstacles) {
+  VoxelGridModel model(SIZE_X, SIZE_Y, SIZE_Z, 0.1, 0.1, 0.0, 0.0, 0.0, 2.0, 100.0);
+  std::vector<geometry_msgs::Point> footprint = box(2.05, 0.55, 3.05, 1.55);
+  geometry_msgs::Point position;
+
+  // nothing has been cleared yet
+  EXPECT_LT(model.footprintCost(position, footprint, 0.5, 0.7), 0.0);
+
+  model.updateWorld(footprint, std::vector<costmap_2d::Observation>(), clearingScans());
+  EXPECT_EQ(0.0, model.footprintCost(position, footprint, 0.5, 0.7));
+
+  // the last column was never cleared, and anything past the grid counts as an obstacle
+  EXPECT_LT(model.footprintCost(position, box(9.05, 0.55, 9.95, 1.55), 0.5, 0.7), 0.0);
+  EXPECT_LT(model.footprintCost(position, box(9.05, 0.55, 10.5, 1.55), 0.5, 0.7), 0.0);
+  EXPECT_LT(model.footprintCost(position, box(2.05, 0.55, 3.05, 2.5), 0.5, 0.7), 0.0);
+}
+
+TEST(VoxelGridModel, runs_find_marked_columns) {
+  VoxelGridModel model(SIZE_X, SIZE_Y, SIZE_Z, 0.1, 0.1, 0.0, 0.0, 0.0, 2.0, 100.0);
+  geometry_msgs::Point position;
+  std::vector<geometry_msgs::Point> footprint;
+  model.updateWorld(footprint, std::vector<costmap_2d::Observation>(), clearingScans());
+
+  // column 50 of row 10, and column 64 of row 3, the first of the second word of its row
+  std::vector<std::pair<double, double> > points;
+  points.push_back(std::make_pair(5.05, 1.05));
+  points.push_back(std::make_pair(6.45, 0.35));
+  std::vector<costmap_2d::Observation> observations(1, obstacles(points));
+  model.updateWorld(footprint, observations, std::vector<PlanarLaserScan>());
+
+  // edges along row 10 over columns 45 to 55, and the same box one row higher
+  EXPECT_LT(model.footprintCost(position, box(4.55, 1.05, 5.55, 1.75), 0.5, 0.7), 0.0);
+  EXPECT_EQ(0.0, model.footprintCost(position, box(4.55, 1.15, 5.55, 1.75), 0.5, 0.7));
+
+  // a run over columns 60 to 70 crosses from the first word of the row into the second
+  EXPECT_LT(model.footprintCost(position, box(6.05, 0.35, 7.05, 1.05), 0.5, 0.7), 0.0);
+  EXPECT_EQ(0.0, model.footprintCost(position, box(6.05, 0.45, 7.05, 1.05), 0.5, 0.7));
+
+  // runs that end right before or start right after the marked column
+  EXPECT_EQ(0.0, model.footprintCost(position, box(5.85, 0.35, 6.35, 0.95), 0.5, 0.7));
+  EXPECT_EQ(0.0, model.footprintCost(position, box(6.55, 0.35, 7.05, 0.95), 0.5, 0.7));
+  EXPECT_LT(model.footprintCost(position, box(6.45, 0.35, 7.05, 0.95), 0.5, 0.7), 0.0);
+}
+
+}
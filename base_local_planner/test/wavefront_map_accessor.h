@@ -36,6 +36,7 @@ class WavefrontMapAccessor : public costmap_2d::Costmap2D {
           }
         }
       }
+      incrementRevision();
     }
 
   private:
@@ -68,13 +68,16 @@ namespace clear_costmap_recovery{
       /**
        * @brief  Run the ClearCostmapRecovery recovery behavior. Reverts the
        * costmap to the static map outside of a user-specified window and
-       * clears unknown space around the robot.
+       * clears unknown space around the robot. The layers are cleared by the
+       * update thread of each costmap at its next update, this only queues that.
        */
       void runBehavior();
 
     private:
-      void clear(costmap_2d::Costmap2DROS* costmap);      
-      void clearMap(boost::shared_ptr<costmap_2d::ObstacleLayer> costmap, double pose_x, double pose_y);
+      void clear(costmap_2d::Costmap2DROS* costmap);
+      void clearLayers(costmap_2d::Costmap2DROS* costmap, double x, double y);
+      void clearMap(boost::shared_ptr<costmap_2d::ObstacleLayer> costmap, double pose_x, double pose_y,
+          double padding);
       costmap_2d::Costmap2DROS* global_costmap_, *local_costmap_;
       std::string name_;
       tf::TransformListener* tf_;
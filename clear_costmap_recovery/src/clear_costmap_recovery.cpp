@@ -35,8 +35,11 @@
 * Author: Eitan Marder-Eppstein
 *********************************************************************/
 #include <clear_costmap_recovery/clear_costmap_recovery.h>
+#include <costmap_2d/inflation_layer.h>
 #include <pluginlib/class_list_macros.h>
 #include <vector>
+#include <algorithm>
+#include <boost/bind.hpp>
 
 //register this planner as a RecoveryBehavior plugin
 PLUGINLIB_DECLARE_CLASS(clear_costmap_recovery, ClearCostmapRecovery, clear_costmap_recovery::ClearCostmapRecovery, nav_core::RecoveryBehavior)
@@ -79,13 +82,12 @@ void ClearCostmapRecovery::runBehavior(){
     return;
   }
   ROS_WARN("Clearing costmap to unstuck robot.");
+  //each costmap clears its layers on its own update thread, so both are cleared at the same time
   clear(global_costmap_);
   clear(local_costmap_);
 }
 
 void ClearCostmapRecovery::clear(costmap_2d::Costmap2DROS* costmap){
-  std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap->getLayeredCostmap()->getPlugins();
-
   tf::Stamped<tf::Pose> pose;
 
   if(!costmap->getRobotPose(pose)){
@@ -93,22 +95,35 @@ void ClearCostmapRecovery::clear(costmap_2d::Costmap2DROS* costmap){
     return;
   }
 
-  double x = pose.getOrigin().x();
-  double y = pose.getOrigin().y();
+  //the layers may only be changed by the update thread of the costmap
+  costmap->queueLayerJob(boost::bind(&ClearCostmapRecovery::clearLayers, this, costmap,
+        pose.getOrigin().x(), pose.getOrigin().y()));
+}
+
+void ClearCostmapRecovery::clearLayers(costmap_2d::Costmap2DROS* costmap, double x, double y){
+  std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap->getLayeredCostmap()->getPlugins();
+
+  //cleared cells change the inflated costs up to the inflation radius around them
+  double padding = 0.0;
+  for (std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator pluginp = plugins->begin(); pluginp != plugins->end(); ++pluginp) {
+    boost::shared_ptr<costmap_2d::InflationLayer> inflation = boost::dynamic_pointer_cast<costmap_2d::InflationLayer>(*pluginp);
+    if(inflation)
+      padding = std::max(padding, inflation->getInflationRadius());
+  }
 
   for (std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator pluginp = plugins->begin(); pluginp != plugins->end(); ++pluginp) {
     boost::shared_ptr<costmap_2d::Layer> plugin = *pluginp;
     if(plugin->getName().find(layer_search_string_)!=std::string::npos){
       boost::shared_ptr<costmap_2d::ObstacleLayer> costmap;
       costmap = boost::static_pointer_cast<costmap_2d::ObstacleLayer>(plugin);
-      clearMap(costmap, x, y);
+      clearMap(costmap, x, y, padding);
     }
   }
 }
 
 
 void ClearCostmapRecovery::clearMap(boost::shared_ptr<costmap_2d::ObstacleLayer> costmap, 
-                                        double pose_x, double pose_y){
+                                        double pose_x, double pose_y, double padding){
   boost::unique_lock< boost::shared_mutex > lock(*(costmap->getLock()));
  
   double start_point_x = pose_x - reset_distance_ / 2;
@@ -120,23 +135,37 @@ void ClearCostmapRecovery::clearMap(boost::shared_ptr<costmap_2d::ObstacleLayer>
   costmap->worldToMapNoBounds(start_point_x, start_point_y, start_x, start_y);
   costmap->worldToMapNoBounds(end_point_x, end_point_y, end_x, end_y);
 
+  //everything outside the window around the robot is cleared; only the cells that actually
+  //change go into the reset bounds, so a mostly unknown map is not re-inflated as a whole
+  int size_x = costmap->getSizeInCellsX(), size_y = costmap->getSizeInCellsY();
+  int min_x = size_x, min_y = size_y, max_x = -1, max_y = -1;
   unsigned char* grid = costmap->getCharMap();
-  for(int x=0; x<(int)costmap->getSizeInCellsX(); x++){
-    bool xrange = x>start_x && x<end_x;
-                   
-    for(int y=0; y<(int)costmap->getSizeInCellsY(); y++){
-      if(xrange && y>start_y && y<end_y)
+  for(int y=0; y<size_y; y++){
+    bool yrange = y>start_y && y<end_y;
+    unsigned char* row = grid + y * size_x;
+    for(int x=0; x<size_x; x++){
+      if(yrange && x>start_x && x<end_x){
+        x = end_x - 1;
         continue;
-      int index = costmap->getIndex(x,y);
-      if(grid[index]!=NO_INFORMATION){
-        grid[index] = NO_INFORMATION;
+      }
+      if(row[x]!=NO_INFORMATION){
+        row[x] = NO_INFORMATION;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
       }
     }
   }
 
-  double ox = costmap->getOriginX(), oy = costmap->getOriginY();
-  double width = costmap->getSizeInMetersX(), height = costmap->getSizeInMetersY();
-  costmap->setResetBounds(ox, ox + width, oy, oy + height);
+  if(max_x < 0)
+    return;
+
+  double wx0, wy0, wx1, wy1;
+  costmap->mapToWorld(min_x, min_y, wx0, wy0);
+  costmap->mapToWorld(max_x, max_y, wx1, wy1);
+  double pad = costmap->getResolution() / 2 + padding;
+  costmap->setResetBounds(wx0 - pad, wx1 + pad, wy0 - pad, wy1 + pad);
   return;
 }
 
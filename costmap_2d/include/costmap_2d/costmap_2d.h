@@ -40,6 +40,7 @@
 
 #include <vector>
 #include <queue>
+#include <stdint.h>
 #include <geometry_msgs/Point.h>
 #include <boost/thread.hpp>
 
@@ -278,6 +279,24 @@ public:
    */
   bool saveMap(std::string file_name);
 
+  /**
+   * @brief  Dump the costmap to a binary file that loadBinary can read back
+   *
+   * The file holds a small header (size, resolution, origin and default value)
+   * followed by the raw cost bytes, or by (run length, cost) pairs when compress is set.
+   * @param file_name The name of the file to save
+   * @param compress Whether to run-length encode the cost bytes
+   * @return True if the file was written completely
+   */
+  bool saveBinary(const std::string& file_name, bool compress = false);
+
+  /**
+   * @brief  Load a costmap written by saveBinary, resizing this map to match
+   * @param file_name The name of the file to load
+   * @return True if the file was valid and read completely
+   */
+  bool loadBinary(const std::string& file_name);
+
   void resizeMap(unsigned int size_x, unsigned int size_y, double resolution, double origin_x,
                  double origin_y);
 
@@ -295,6 +314,25 @@ public:
     return access_;
   }
 
+  /**
+   * @brief  A number that changes whenever the costs of the map may have changed, so results
+   * computed from the map can be cached against it. No two maps ever share a revision.
+   * @return The current revision of the map
+   */
+  uint64_t getRevision() const
+  {
+    return revision_;
+  }
+
+  /**
+   * @brief  Moves the map to a new revision; code writing costs through getCharMap() has to
+   * call this once it is done
+   */
+  void incrementRevision()
+  {
+    ++revision_;
+  }
+
 protected:
   /**
    * @brief  Copy a region of a source map into a destination map
@@ -424,6 +462,7 @@ protected:
   double origin_y_;
   unsigned char* costmap_;
   unsigned char default_value_;
+  uint64_t revision_;
 
   class MarkCell
   {
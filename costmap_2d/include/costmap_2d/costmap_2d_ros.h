@@ -43,9 +43,12 @@
 #include <costmap_2d/costmap_2d_publisher.h>
 #include <costmap_2d/Costmap2DConfig.h>
 #include <costmap_2d/footprint.h>
+#include <costmap_2d/robot_pose_cache.h>
 #include <geometry_msgs/Polygon.h>
 #include <dynamic_reconfigure/server.h>
 #include <pluginlib/class_loader.h>
+#include <boost/function.hpp>
+#include <boost/signals2/connection.hpp>
 
 class SuperValue : public XmlRpc::XmlRpcValue
 {
@@ -103,11 +106,52 @@ public:
 
   void updateMap();
 
+  /** @brief Called after every update with the cell bounds x0, xn, y0, yn of what was recomputed. */
+  typedef boost::function<void(unsigned int, unsigned int, unsigned int, unsigned int)> UpdateCallback;
+
+  /**
+   * @brief Set a function to call on the update thread after each update, without the
+   * costmap lock held. Pass an empty function to stop.
+   */
+  void setUpdateCallback(const UpdateCallback& callback);
+
   /**
    * @brief Reset each individual layer
    */
   void resetLayers();
 
+  /**
+   * @brief Clear a window centered on the robot in every layer that supports it, and mark
+   * it free in the master costmap until the next update recomputes just that window
+   *
+   * This drops what the layers remember about the window, so it is meant for recovery
+   * behaviors. The layers are cleared through queueLayerJob.
+   * @param size_x The width of the window in meters
+   * @param size_y The height of the window in meters
+   * @return false if the robot pose could not be retrieved
+   */
+  bool clearWindow(double size_x, double size_y);
+
+  /**
+   * @brief Mark a window centered on the robot free in the master costmap only; the layers
+   * keep their data, so the next update that covers the window restores it
+   * @param size_x The width of the window in meters
+   * @param size_y The height of the window in meters
+   * @return false if the robot pose could not be retrieved
+   */
+  bool clearMasterWindow(double size_x, double size_y);
+
+  /** @brief A change to the layers, see queueLayerJob. */
+  typedef boost::function<void()> LayerJob;
+
+  /**
+   * @brief Run a job on the update thread at the start of the next update
+   *
+   * Layers are only touched by the update thread, so any other thread that has to change
+   * them queues the change here. Jobs run in the order they were queued.
+   */
+  void queueLayerJob(const LayerJob& job);
+
   /** @brief Same as getLayeredCostmap()->isCurrent(). */
   bool isCurrent()
     {
@@ -116,6 +160,9 @@ public:
 
   /**
    * @brief Get the pose of the robot in the global frame of the costmap
+   *
+   * Unless the cache_robot_pose parameter is false, the pose is only looked up in tf again
+   * once tf has received new transforms.
    * @param global_pose Will be set to the pose of the robot in the global frame of the costmap
    * @return True if the pose was set successfully, false otherwise
    */
@@ -287,6 +334,26 @@ private:
 
   boost::recursive_mutex configuration_mutex_;
 
+  boost::mutex update_callback_mutex_;
+  UpdateCallback update_callback_;
+
+  /** @brief Run the jobs queued by queueLayerJob, on the update thread. */
+  void runLayerJobs();
+
+  /** @brief Clear a window in every layer, the job clearWindow queues. */
+  void clearLayerWindows(double min_x, double min_y, double max_x, double max_y);
+
+  /** @brief Mark a window free in the master grid, and get the window around the robot. */
+  bool clearMasterWindow(double size_x, double size_y, double* min_x, double* min_y, double* max_x,
+                         double* max_y);
+
+  boost::mutex layer_jobs_mutex_;  ///< @brief Guards layer_jobs_
+  std::vector<LayerJob> layer_jobs_;
+
+  bool cache_robot_pose_;
+  mutable RobotPoseCache robot_pose_cache_;
+  boost::signals2::connection transforms_changed_connection_;
+
   ros::Subscriber footprint_sub_;
   bool got_footprint_;
   std::vector<geometry_msgs::Point> unpadded_footprint_;
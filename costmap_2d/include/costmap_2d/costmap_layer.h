@@ -53,6 +53,28 @@ public:
 
   virtual void matchSize();
 
+  /** @brief How the layer's own grid goes into the master grid, for LayeredCostmap's fused composition. */
+  enum CombineRule
+  {
+    COMBINE_CUSTOM,          ///< not a plain per-cell combine; LayeredCostmap calls updateCosts()
+    COMBINE_NOTHING,         ///< the layer leaves the master grid alone this cycle
+    COMBINE_TRUE_OVERWRITE,  ///< as updateWithTrueOverwrite()
+    COMBINE_OVERWRITE,       ///< as updateWithOverwrite()
+    COMBINE_MAX,             ///< as updateWithMax()
+    COMBINE_ADDITION         ///< as updateWithAddition()
+  };
+
+  /**
+   * @brief  Used instead of updateCosts() when the parent composes layers in a single pass.
+   * Do whatever updateCosts() would do to the layer's own grid, then return the rule that
+   * combines that grid into the master. The default keeps calling updateCosts(), and the
+   * built-in layers fall back to it for any subclass, which may override updateCosts().
+   */
+  virtual CombineRule prepareCombine(int min_i, int min_j, int max_i, int max_j)
+  {
+    return COMBINE_CUSTOM;
+  }
+
 protected:
   void updateWithTrueOverwrite(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
   void updateWithOverwrite    (costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
@@ -40,6 +40,7 @@
 #include <ros/ros.h>
 #include <costmap_2d/layer.h>
 #include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/tile_grid.h>
 #include <costmap_2d/InflationPluginConfig.h>
 #include <dynamic_reconfigure/server.h>
 #include <queue>
@@ -104,6 +105,12 @@ public:
 
   virtual void reset() { onInitialize(); }
 
+  /** @brief  The distance in meters up to which an obstacle raises the costs around it */
+  double getInflationRadius() const
+  {
+    return inflation_radius_;
+  }
+
   /** @brief  Given a distance, compute a cost.
    * @param  distance The distance from an obstacle in cells
    * @return A cost value for the distance */
@@ -178,7 +185,7 @@ private:
 
   double resolution_;
 
-  bool* seen_;
+  TileGrid<bool> seen_;  ///< cells already inflated this cycle; sparse, so clearing it is cheap
 
   unsigned char** cached_costs_;
   double** cached_distances_;
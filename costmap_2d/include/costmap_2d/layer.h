@@ -62,6 +62,17 @@ public:
 
   virtual void reset() {}
 
+  /**
+   * @brief Forget what the layer knows inside an axis-aligned window, given in world coordinates,
+   * and include the window in the next bounds so only it gets recomputed. Called on the
+   * update thread between two updates, see Costmap2DROS::clearWindow.
+   * @return false if the layer does not clear windows, e.g. because it holds a static map
+   */
+  virtual bool clearWindow(double min_x, double min_y, double max_x, double max_y)
+  {
+    return false;
+  }
+
   virtual ~Layer() {}
 
   bool isCurrent() const
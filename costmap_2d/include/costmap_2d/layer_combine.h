@@ -0,0 +1,72 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_LAYER_COMBINE_H_
+#define COSTMAP_2D_LAYER_COMBINE_H_
+
+#include <cstddef>
+
+namespace costmap_2d
+{
+
+/**
+ * Row kernels used by CostmapLayer to combine a layer into the master grid.
+ * Each one combines n cells of layer into master in place. The default versions
+ * use SSE2/AVX2 where the compiler targets them and produce exactly the same
+ * bytes as the *Scalar versions, which are kept as a reference.
+ */
+
+/**
+ * @brief  Keep the larger cost, where a cell that is NO_INFORMATION in the layer
+ * leaves the master untouched and a NO_INFORMATION master cell takes the layer's cost
+ */
+void combineMax(unsigned char* master, const unsigned char* layer, size_t n);
+void combineMaxScalar(unsigned char* master, const unsigned char* layer, size_t n);
+
+/**
+ * @brief  Take the layer's cost wherever it is not NO_INFORMATION
+ */
+void combineOverwrite(unsigned char* master, const unsigned char* layer, size_t n);
+void combineOverwriteScalar(unsigned char* master, const unsigned char* layer, size_t n);
+
+/**
+ * @brief  Add the layer's cost to the master, capped below INSCRIBED_INFLATED_OBSTACLE,
+ * with NO_INFORMATION cells handled as in combineMax
+ */
+void combineAddition(unsigned char* master, const unsigned char* layer, size_t n);
+void combineAdditionScalar(unsigned char* master, const unsigned char* layer, size_t n);
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_LAYER_COMBINE_H_
@@ -89,6 +89,25 @@ public:
 
   bool isCurrent();
 
+  /**
+   * @brief  Compose layers that only combine their own grid cell by cell (see CostmapLayer::prepareCombine)
+   * in one blocked pass over the master grid, instead of one pass per layer. Other layers, such as
+   * inflation, still get their own updateCosts() call at their place in the layer order.
+   */
+  void setFusedComposition(bool fused)
+  {
+    fused_composition_ = fused;
+  }
+
+  /**
+   * @brief  Dump the master grid and every layer that keeps its own grid with Costmap2D::saveBinary
+   *
+   * The master grid goes to <prefix>master.bin and each layer to <prefix><layer name>.bin,
+   * with '/' in layer names replaced by '_'.
+   * @return True if every file was written
+   */
+  bool dumpLayers(const std::string& prefix, bool compress = false);
+
   Costmap2D* getCostmap()
   {
     return &costmap_;
@@ -157,6 +176,15 @@ public:
 private:
   void updateUsingPlugins(std::vector<boost::shared_ptr<Layer> > &plugins);
 
+  struct FusedLayer
+  {
+    const unsigned char* costs;
+    int rule;
+  };
+
+  void composeFused(int x0, int y0, int xn, int yn);
+  void composeRun(int x0, int y0, int xn, int yn, bool reset);
+
   Costmap2D costmap_;
   std::string global_frame_;
 
@@ -170,6 +198,8 @@ private:
 
   bool initialized_;
   bool size_locked_;
+  bool fused_composition_;
+  std::vector<FusedLayer> fused_run_;
   double circumscribed_radius_, inscribed_radius_;
   std::vector<geometry_msgs::Point> footprint_;
 };
@@ -35,14 +35,16 @@
 #include <geometry_msgs/Point.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
+#include <boost/shared_ptr.hpp>
 
 namespace costmap_2d
 {
 
 /**
  * @brief Stores an observation in terms of a point cloud and the origin of the source
- * @note Tried to make members and constructor arguments const but the compiler would not accept the default
- * assignment operator for vector insertion!
+ * @note Copies of an observation share its point cloud, so handing observations out of an
+ * ObservationBuffer does not copy any points. Code that modifies a cloud which may be shared
+ * should check cloud_.unique() and copy it first.
  */
 class Observation
 {
@@ -57,7 +59,6 @@ public:
 
   virtual ~Observation()
   {
-    delete cloud_;
   }
 
   /**
@@ -74,11 +75,11 @@ public:
   }
 
   /**
-   * @brief  Copy constructor
+   * @brief  Copy constructor, the copy shares the point cloud of the original
    * @param obs The observation to copy
    */
   Observation(const Observation& obs) :
-      origin_(obs.origin_), cloud_(new pcl::PointCloud<pcl::PointXYZ>(*(obs.cloud_))), obstacle_range_(obs.obstacle_range_), raytrace_range_(
+      origin_(obs.origin_), cloud_(obs.cloud_), obstacle_range_(obs.obstacle_range_), raytrace_range_(
           obs.raytrace_range_)
   {
   }
@@ -94,7 +95,7 @@ public:
   }
 
   geometry_msgs::Point origin_;
-  pcl::PointCloud<pcl::PointXYZ>* cloud_;
+  boost::shared_ptr<pcl::PointCloud<pcl::PointXYZ> > cloud_;
   double obstacle_range_, raytrace_range_;
 };
 
@@ -38,8 +38,8 @@
 #define COSTMAP_OBSERVATION_BUFFER_H_
 
 #include <vector>
-#include <list>
 #include <string>
+#include <stdint.h>
 #include <ros/time.h>
 #include <costmap_2d/observation.h>
 #include <tf/transform_listener.h>
@@ -57,6 +57,9 @@ namespace costmap_2d
 /**
  * @class ObservationBuffer
  * @brief Takes in point clouds from sensors, transforms them to the desired frame, and stores them
+ *
+ * Observations are kept newest first in a ring of slots. A purged slot keeps its point cloud so the
+ * next message is filled into storage that has already been allocated.
  */
 class ObservationBuffer
 {
@@ -109,8 +112,21 @@ public:
   void bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud);
 
   /**
-   * @brief  Pushes copies of all current observations onto the end of the vector passed in
-   * @param  observations The vector to be filled
+   * @brief  Reduces every buffered cloud to one point per grid cell and height band
+   *
+   * Of all points falling into the same cell and band only the one farthest from the sensor origin is
+   * kept, so clearing still raytraces as far as the original cloud did. Points with a NaN or infinite
+   * coordinate are dropped.
+   * @param  resolution The size of a cell in the xy plane, 0 disables downsampling
+   * @param  z_resolution The height of a band above min_obstacle_height, 0 uses a single band
+   * @param  origin_x The x coordinate of a cell corner, to align the cells with the costmap
+   * @param  origin_y The y coordinate of a cell corner, to align the cells with the costmap
+   */
+  void setDownsampling(double resolution, double z_resolution, double origin_x, double origin_y);
+
+  /**
+   * @brief  Pushes all current observations onto the end of the vector passed in
+   * @param  observations The vector to be filled, the observations share their clouds with the buffer
    */
   void getObservations(std::vector<Observation>& observations);
 
@@ -147,18 +163,41 @@ private:
    */
   void purgeStaleObservations();
 
+  /**
+   * @brief  Keeps one point per cell and height band, the one farthest from origin
+   */
+  void downsampleCloud(pcl::PointCloud<pcl::PointXYZ>& cloud, const geometry_msgs::Point& origin);
+
+  /**
+   * @brief  Doubles the number of slots, keeping the current observations in order
+   */
+  void growObservations();
+
+  /**
+   * @brief  Returns the i-th newest observation
+   */
+  inline Observation& observationAt(unsigned int i)
+  {
+    return observations_[(observation_head_ + i) % observations_.size()];
+  }
+
   tf::TransformListener& tf_;
   const ros::Duration observation_keep_time_;
   const ros::Duration expected_update_rate_;
   ros::Time last_updated_;
   std::string global_frame_;
   std::string sensor_frame_;
-  std::list<Observation> observation_list_;
+  std::vector<Observation> observations_; ///< @brief Ring of observation slots, newest first starting at observation_head_
+  unsigned int observation_head_, observation_count_;
+  pcl::PointCloud<pcl::PointXYZ> input_cloud_, global_frame_cloud_; ///< @brief Reused conversion buffers
   std::string topic_name_;
   double min_obstacle_height_, max_obstacle_height_;
   boost::recursive_mutex lock_; ///< @brief A lock for accessing data in callbacks safely
   double obstacle_range_, raytrace_range_;
   double tf_tolerance_;
+  double downsample_resolution_, downsample_z_resolution_, downsample_origin_x_, downsample_origin_y_;
+  std::vector<uint64_t> downsample_keys_; ///< @brief Open addressing table of occupied cells, reused between clouds
+  std::vector<unsigned int> downsample_points_; ///< @brief Index of the point kept for each entry of downsample_keys_
 };
 }
 #endif
@@ -69,10 +69,12 @@ public:
   virtual void updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x, double* min_y, double* max_x,
                              double* max_y);
   virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+  virtual CombineRule prepareCombine(int min_i, int min_j, int max_i, int max_j);
 
   virtual void activate();
   virtual void deactivate();
   virtual void reset();
+  virtual bool clearWindow(double min_x, double min_y, double max_x, double max_y);
 
   /**
    * @brief  A callback to handle buffering LaserScan messages
@@ -117,11 +119,15 @@ public:
 
   // for testing purposes
   void addStaticObservation(costmap_2d::Observation& obs, bool marking, bool clearing);
+  void clearStaticObservations(bool marking, bool clearing);
 
 protected:
 
   virtual void setupDynamicReconfigure(ros::NodeHandle& nh);
 
+  /** @brief  prepareCombine() for a layer whose updateCosts() is ObstacleLayer's. */
+  CombineRule prepareObstacleCombine(int min_i, int min_j, int max_i, int max_j);
+
   /**
    * @brief  Get the observations used to mark space
    * @param marking_observations A reference to a vector that will be populated with the observations
@@ -0,0 +1,101 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_ROBOT_POSE_CACHE_H_
+#define COSTMAP_2D_ROBOT_POSE_CACHE_H_
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <tf/transform_datatypes.h>
+
+namespace costmap_2d
+{
+
+/**
+ * @class RobotPoseCache
+ * @brief The last robot pose looked up in tf, valid until tf receives new transforms.
+ *
+ * A lookup of the latest transform gives the same result until new transforms arrive, so
+ * Costmap2DROS looks the pose up once per tf update and serves it to the planners, recovery
+ * behaviors and its own update loop from here. Tf's transforms-changed callback calls
+ * invalidate(). Any number of threads may read and store concurrently without locking; a
+ * store that races another one is dropped.
+ */
+class RobotPoseCache
+{
+public:
+  RobotPoseCache();
+
+  /**
+   * @brief  Mark the stored pose as outdated
+   */
+  void invalidate();
+
+  /**
+   * @brief  The generation to store a pose for; read it before looking the pose up, so that
+   * an invalidation during the lookup is not lost
+   */
+  boost::uint32_t getGeneration() const;
+
+  /**
+   * @brief  Store a pose looked up during the given generation
+   */
+  void store(boost::uint32_t generation, const tf::Stamped<tf::Pose>& pose);
+
+  /**
+   * @brief  Get the stored pose if it is still current; the frame id is left alone
+   * @return False if there is no pose for the current generation
+   */
+  bool load(tf::Stamped<tf::Pose>& pose) const;
+
+private:
+  enum Field
+  {
+    X, Y, Z, QX, QY, QZ, QW, NUM_FIELDS
+  };
+
+  RobotPoseCache(const RobotPoseCache&);
+  RobotPoseCache& operator=(const RobotPoseCache&);
+
+  boost::atomic<boost::uint32_t> generation_;
+  // odd while a store is in progress
+  boost::atomic<boost::uint32_t> sequence_;
+  boost::atomic<boost::uint32_t> stored_generation_;
+  boost::atomic<boost::uint64_t> fields_[NUM_FIELDS];
+  boost::atomic<boost::uint64_t> stamp_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_ROBOT_POSE_CACHE_H_
@@ -0,0 +1,181 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_SPEED_LIMIT_GRID_H_
+#define COSTMAP_2D_SPEED_LIMIT_GRID_H_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace costmap_2d
+{
+
+/**
+ * @class SpeedLimitSnapshot
+ * @brief An immutable copy of a SpeedLimitGrid, safe to read while the grid is being
+ * resampled or resized on the costmap update thread.
+ */
+class SpeedLimitSnapshot
+{
+public:
+  SpeedLimitSnapshot() :
+      size_x_(0), size_y_(0)
+  {
+  }
+
+  unsigned int getSizeX() const
+  {
+    return size_x_;
+  }
+
+  unsigned int getSizeY() const
+  {
+    return size_y_;
+  }
+
+  /**
+   * @brief  Get the limit of a cell, which must be inside the snapshot
+   */
+  float getSpeedLimit(unsigned int mx, unsigned int my) const
+  {
+    return (*limits_)[my * size_x_ + mx];
+  }
+
+private:
+  friend class SpeedLimitGrid;
+  boost::shared_ptr<const std::vector<float> > limits_;
+  unsigned int size_x_, size_y_;
+};
+
+/**
+ * @class SpeedLimitGrid
+ * @brief A grid of translational speed limits in m/s, laid out cell for cell like the
+ * master costmap it belongs to.
+ *
+ * Layers that provide speed zones derive from this next to Layer, the same way CostmapLayer
+ * adds a Costmap2D, so planners can find it among the plugins of a LayeredCostmap with a
+ * dynamic_cast and read limits using the cell coordinates they already compute for costs.
+ * Cells without a zone hold NO_SPEED_LIMIT.
+ *
+ * The grid itself belongs to the thread that updates it. Every call that changes it publishes
+ * a copy once the change is complete, and readers on other threads, such as local planners,
+ * take that copy with getSpeedLimitSnapshot, so they never see a grid that is being
+ * reallocated or refilled.
+ */
+class SpeedLimitGrid
+{
+public:
+  static const float NO_SPEED_LIMIT;
+
+  SpeedLimitGrid();
+  virtual ~SpeedLimitGrid();
+
+  /**
+   * @brief  Resize the grid and reset every cell to NO_SPEED_LIMIT
+   */
+  void resizeSpeedGrid(unsigned int size_x, unsigned int size_y);
+
+  /**
+   * @brief  Fill the grid from a raster of limits with its own resolution and origin
+   *
+   * Each cell takes the value of the source cell its center falls in, cells outside the
+   * source get NO_SPEED_LIMIT.
+   * @param resolution The resolution of this grid
+   * @param origin_x The x origin of this grid in world coordinates
+   * @param origin_y The y origin of this grid in world coordinates
+   * @param src The source limits, row major
+   * @param src_size_x The width of the source in cells
+   * @param src_size_y The height of the source in cells
+   * @param src_resolution The resolution of the source
+   * @param src_origin_x The x origin of the source in world coordinates
+   * @param src_origin_y The y origin of the source in world coordinates
+   */
+  void sampleSpeedLimits(double resolution, double origin_x, double origin_y, const std::vector<float>& src,
+                         unsigned int src_size_x, unsigned int src_size_y, double src_resolution,
+                         double src_origin_x, double src_origin_y);
+
+  /**
+   * @brief  Reset every cell to NO_SPEED_LIMIT
+   */
+  void clearSpeedLimits();
+
+  unsigned int getSpeedGridSizeX() const
+  {
+    return speed_size_x_;
+  }
+
+  unsigned int getSpeedGridSizeY() const
+  {
+    return speed_size_y_;
+  }
+
+  /**
+   * @brief  Get the limit of a cell, which must be inside the grid
+   */
+  float getSpeedLimit(unsigned int mx, unsigned int my) const
+  {
+    return speed_limits_[my * speed_size_x_ + mx];
+  }
+
+  /**
+   * @brief  Get the smallest limit inside a window of cells, clamped to the grid
+   * @return NO_SPEED_LIMIT if no cell in the window carries a limit
+   */
+  float getMinSpeedLimit(int min_i, int min_j, int max_i, int max_j) const;
+
+  const float* getSpeedLimits() const
+  {
+    return speed_limits_.empty() ? 0 : &speed_limits_[0];
+  }
+
+  /**
+   * @brief  Get the limits as of the last completed change, may be called from any thread
+   */
+  SpeedLimitSnapshot getSpeedLimitSnapshot() const;
+
+protected:
+  std::vector<float> speed_limits_;
+  unsigned int speed_size_x_, speed_size_y_;
+
+private:
+  void publishSpeedLimits();
+
+  mutable boost::mutex snapshot_mutex_;  ///< @brief Guards snapshot_
+  SpeedLimitSnapshot snapshot_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_SPEED_LIMIT_GRID_H_
@@ -0,0 +1,94 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_SPEED_ZONE_LAYER_H_
+#define COSTMAP_2D_SPEED_ZONE_LAYER_H_
+#include <ros/ros.h>
+#include <costmap_2d/layer.h>
+#include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/speed_limit_grid.h>
+#include <costmap_2d/GenericPluginConfig.h>
+#include <dynamic_reconfigure/server.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <boost/thread/mutex.hpp>
+
+namespace costmap_2d
+{
+/**
+ * @class SpeedZoneLayer
+ * @brief Keeps a per-cell translational speed limit grid next to the costmap, read from an
+ * OccupancyGrid such as one served by map_server from a speed zone map file.
+ *
+ * A cell value v in [0, 100] becomes a limit of speed_offset + speed_multiplier * v m/s,
+ * unknown cells (-1) carry no limit. The layer does not touch the master costs; local
+ * planners read the limits through the SpeedLimitGrid base, which is kept aligned with the
+ * master costmap, also when it rolls.
+ */
+class SpeedZoneLayer : public Layer, public SpeedLimitGrid
+{
+public:
+  SpeedZoneLayer();
+  virtual ~SpeedZoneLayer();
+  virtual void onInitialize();
+  virtual void activate();
+  virtual void deactivate();
+  virtual void reset();
+
+  virtual void updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x, double* min_y, double* max_x,
+                             double* max_y);
+
+  virtual void matchSize();
+
+private:
+  void incomingMap(const nav_msgs::OccupancyGridConstPtr& new_map);
+  void reconfigureCB(costmap_2d::GenericPluginConfig &config, uint32_t level);
+
+  std::string map_topic_;
+  double speed_offset_, speed_multiplier_;
+  ros::Subscriber map_sub_;
+
+  boost::mutex zone_mutex_;  ///< @brief Guards the zone map, enabled_ and the resample flags
+  std::vector<float> zone_limits_;
+  unsigned int zone_size_x_, zone_size_y_;
+  double zone_resolution_, zone_origin_x_, zone_origin_y_;
+  bool has_new_zones_;
+
+  // the master geometry the grid was last sampled for
+  double sampled_origin_x_, sampled_origin_y_, sampled_resolution_;
+  bool needs_resample_;
+
+  dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig> *dsrv_;
+};
+}  // namespace costmap_2d
+#endif  // COSTMAP_2D_SPEED_ZONE_LAYER_H_
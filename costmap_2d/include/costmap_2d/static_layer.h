@@ -60,6 +60,7 @@ public:
   virtual void updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x, double* min_y, double* max_x,
                              double* max_y);
   virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+  virtual CombineRule prepareCombine(int min_i, int min_j, int max_i, int max_j);
 
   virtual void matchSize();
 
@@ -0,0 +1,199 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_TILE_GRID_H_
+#define COSTMAP_2D_TILE_GRID_H_
+
+#include <algorithm>
+#include <vector>
+
+namespace costmap_2d
+{
+
+/**
+ * @class TileGrid
+ * @brief A 2D grid stored as square tiles that are only allocated once a cell in them is
+ * written with something other than the background value.
+ *
+ * Unallocated tiles read as the background value, so a large grid that is mostly untouched
+ * costs little memory, and reset() only has to clear the tiles that were written since the
+ * last reset. Cleared tiles are kept for reuse. getTile() exposes a tile's cells row by row
+ * (TILE_SIZE cells per row) for loops that want to skip background tiles wholesale.
+ *
+ * Only InflationLayer's scratch buffer of inflated cells is stored this way. Costmap2D and the
+ * layers that derive from it keep their dense arrays, since getCharMap() hands the raw array to
+ * the planners and the publisher, which index it directly.
+ */
+template<typename T>
+class TileGrid
+{
+public:
+  static const unsigned int TILE_SHIFT = 6;
+  static const unsigned int TILE_SIZE = 1 << TILE_SHIFT;
+  static const unsigned int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+  TileGrid() :
+      size_x_(0), size_y_(0), tiles_x_(0), tiles_y_(0), background_()
+  {
+  }
+
+  ~TileGrid()
+  {
+    release();
+  }
+
+  /**
+   * @brief  Resize the grid, dropping all tiles
+   * @param size_x The width in cells
+   * @param size_y The height in cells
+   * @param background The value of every cell that has not been written
+   */
+  void resize(unsigned int size_x, unsigned int size_y, T background)
+  {
+    release();
+    size_x_ = size_x;
+    size_y_ = size_y;
+    tiles_x_ = (size_x + TILE_SIZE - 1) >> TILE_SHIFT;
+    tiles_y_ = (size_y + TILE_SIZE - 1) >> TILE_SHIFT;
+    background_ = background;
+    tiles_.assign(tiles_x_ * tiles_y_, static_cast<T*>(NULL));
+  }
+
+  /**
+   * @brief  Set every cell back to the background value, in time proportional to the written tiles
+   */
+  void reset()
+  {
+    for (unsigned int i = 0; i < used_.size(); ++i)
+    {
+      pool_.push_back(tiles_[used_[i]]);
+      tiles_[used_[i]] = NULL;
+    }
+    used_.clear();
+  }
+
+  T get(unsigned int x, unsigned int y) const
+  {
+    const T* tile = tiles_[tileIndex(x, y)];
+    return tile ? tile[cellIndex(x, y)] : background_;
+  }
+
+  void set(unsigned int x, unsigned int y, T value)
+  {
+    unsigned int index = tileIndex(x, y);
+    T* tile = tiles_[index];
+    if (!tile)
+    {
+      if (value == background_)
+        return;
+      tile = allocateTile(index);
+    }
+    tile[cellIndex(x, y)] = value;
+  }
+
+  /**
+   * @brief  The cells of tile (tx, ty), or NULL if all of them hold the background value
+   */
+  const T* getTile(unsigned int tx, unsigned int ty) const
+  {
+    return tiles_[ty * tiles_x_ + tx];
+  }
+
+  unsigned int getSizeInTilesX() const { return tiles_x_; }
+  unsigned int getSizeInTilesY() const { return tiles_y_; }
+  unsigned int getSizeInCellsX() const { return size_x_; }
+  unsigned int getSizeInCellsY() const { return size_y_; }
+  T getBackground() const { return background_; }
+
+  /**
+   * @brief  Number of tiles currently holding cells, for memory accounting
+   */
+  unsigned int getAllocatedTiles() const { return used_.size(); }
+
+private:
+  // tiles own raw arrays
+  TileGrid(const TileGrid&);
+  TileGrid& operator=(const TileGrid&);
+
+  unsigned int tileIndex(unsigned int x, unsigned int y) const
+  {
+    return (y >> TILE_SHIFT) * tiles_x_ + (x >> TILE_SHIFT);
+  }
+
+  static unsigned int cellIndex(unsigned int x, unsigned int y)
+  {
+    return ((y & (TILE_SIZE - 1)) << TILE_SHIFT) + (x & (TILE_SIZE - 1));
+  }
+
+  T* allocateTile(unsigned int index)
+  {
+    T* tile;
+    if (pool_.empty())
+    {
+      tile = new T[TILE_CELLS];
+    }
+    else
+    {
+      tile = pool_.back();
+      pool_.pop_back();
+    }
+    std::fill(tile, tile + TILE_CELLS, background_);
+    tiles_[index] = tile;
+    used_.push_back(index);
+    return tile;
+  }
+
+  void release()
+  {
+    reset();
+    for (unsigned int i = 0; i < pool_.size(); ++i)
+      delete[] pool_[i];
+    pool_.clear();
+  }
+
+  unsigned int size_x_, size_y_;
+  unsigned int tiles_x_, tiles_y_;
+  T background_;
+  std::vector<T*> tiles_;
+  std::vector<unsigned int> used_;  ///< indices of the allocated tiles
+  std::vector<T*> pool_;            ///< cleared tiles waiting to be reused
+};
+
+template<typename T> const unsigned int TileGrid<T>::TILE_SHIFT;
+template<typename T> const unsigned int TileGrid<T>::TILE_SIZE;
+template<typename T> const unsigned int TileGrid<T>::TILE_CELLS;
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_TILE_GRID_H_
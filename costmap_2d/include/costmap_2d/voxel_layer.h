@@ -53,6 +53,7 @@
 #include <dynamic_reconfigure/server.h>
 #include <costmap_2d/VoxelPluginConfig.h>
 #include <costmap_2d/obstacle_layer.h>
+#include <costmap_2d/worker_pool.h>
 #include <voxel_grid/voxel_grid.h>
 namespace costmap_2d
 {
@@ -61,7 +62,7 @@ class VoxelLayer : public ObstacleLayer
 {
 public:
   VoxelLayer() :
-      voxel_grid_(0, 0, 0)
+      voxel_grid_(0, 0, 0), marking_threads_(1)
   {
     costmap_ = NULL; // this is the unsigned char* member of parent class's parent class Costmap2D.
   }
@@ -69,6 +70,7 @@ public:
   virtual void onInitialize();
   virtual void updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x, double* min_y, double* max_x,
                              double* max_y);
+  virtual CombineRule prepareCombine(int min_i, int min_j, int max_i, int max_j);
 
   void updateOrigin(double new_origin_x, double new_origin_y);
   bool isDiscretized()
@@ -77,6 +79,7 @@ public:
   }
   virtual void matchSize();
   virtual void reset();
+  virtual bool clearWindow(double min_x, double min_y, double max_x, double max_y);
 
 
 protected:
@@ -85,6 +88,31 @@ protected:
 private:
   void reconfigureCB(costmap_2d::VoxelPluginConfig &config, uint32_t level);
   void clearNonLethal(double wx, double wy, double w_size_x, double w_size_y, bool clear_no_info);
+
+  /**
+   * @brief The columns one marking thread raised to lethal, bucketed by the band of rows they
+   * lie in, and the bounds of their points.
+   */
+  struct MarkedColumns
+  {
+    std::vector<std::vector<unsigned int> > bands;
+    double min_x, min_y, max_x, max_y;
+  };
+
+  void markObservations(const std::vector<costmap_2d::Observation>& observations, double* min_x, double* min_y,
+                        double* max_x, double* max_y);
+  void markObservationsParallel(const std::vector<costmap_2d::Observation>& observations, double* min_x,
+                                double* min_y, double* max_x, double* max_y);
+  /** @brief Marks the slice-th share of every cloud, collecting the raised columns in marked_columns_[slice] */
+  void markSlice(const std::vector<costmap_2d::Observation>* observations, unsigned int slice);
+  /** @brief Writes the columns every marking thread collected for the band-th share of the rows */
+  void projectRows(unsigned int band);
+
+  /**
+   * @brief  Writes the cost of every column flagged in dirty_columns_ into the costmap and clears
+   * the flags, growing the bounds only around cells whose cost changed
+   */
+  void projectDirtyColumns(double* min_x, double* min_y, double* max_x, double* max_y);
   virtual void raytraceFreespace(const costmap_2d::Observation& clearing_observation, double* min_x, double* min_y,
                                  double* max_x, double* max_y);
 
@@ -95,6 +123,10 @@ private:
   voxel_grid::VoxelGrid voxel_grid_;
   double z_resolution_, origin_z_;
   unsigned int unknown_threshold_, mark_threshold_, size_z_;
+  unsigned int marking_threads_;
+  boost::shared_ptr<WorkerPool> marking_pool_;  ///< @brief Runs the marking threads, only if there is more than one
+  std::vector<MarkedColumns> marked_columns_;
+  std::vector<uint32_t> dirty_columns_;  ///< @brief One bit per cell, set for the columns cleared this cycle
   ros::Publisher clearing_endpoints_pub_;
   sensor_msgs::PointCloud clearing_endpoints_;
 
@@ -111,6 +143,30 @@ private:
     return false;
   }
 
+  /**
+   * @brief  The voxel a marking point goes into, false if the point is too high, too far
+   * from the sensor or off the grid. Points below the grid are marked at its bottom.
+   */
+  inline bool markingVoxel(const costmap_2d::Observation& obs, double sq_obstacle_range, const pcl::PointXYZ& point,
+                           unsigned int& mx, unsigned int& my, unsigned int& mz)
+  {
+    //if the obstacle is too high or too far away from the robot we won't add it
+    if (point.z > max_obstacle_height_)
+      return false;
+
+    //compute the squared distance from the hitpoint to the pointcloud's origin
+    double sq_dist = (point.x - obs.origin_.x) * (point.x - obs.origin_.x)
+        + (point.y - obs.origin_.y) * (point.y - obs.origin_.y)
+        + (point.z - obs.origin_.z) * (point.z - obs.origin_.z);
+
+    //if the point is far enough away... we won't consider it
+    if (sq_dist >= sq_obstacle_range)
+      return false;
+
+    //now we need to compute the map coordinates for the observation
+    return worldToMap3D(point.x, point.y, std::max(double(point.z), origin_z_), mx, my, mz);
+  }
+
   inline bool worldToMap3D(double wx, double wy, double wz, unsigned int& mx, unsigned int& my, unsigned int& mz)
   {
     if (wx < origin_x_ || wy < origin_y_ || wz < origin_z_)
@@ -0,0 +1,97 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_WORKER_POOL_H_
+#define COSTMAP_2D_WORKER_POOL_H_
+
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace costmap_2d
+{
+
+/**
+ * @class WorkerPool
+ * @brief A fixed set of threads that run the parts of one job at a time.
+ *
+ * For code that splits the same work into parts over and over, e.g. once per update cycle,
+ * so the threads are started once instead of for every split. run() hands out the parts to
+ * the workers and the calling thread and returns when all of them are done. Only one thread
+ * may call run() at a time.
+ */
+class WorkerPool
+{
+public:
+  typedef boost::function<void(unsigned int)> Job;
+
+  /**
+   * @param threads The number of threads working on a job, including the one calling run()
+   */
+  explicit WorkerPool(unsigned int threads);
+  ~WorkerPool();
+
+  unsigned int getThreads() const
+  {
+    return workers_.size() + 1;
+  }
+
+  /**
+   * @brief  Call job(i) for every i in [0, parts) and wait until all calls returned
+   */
+  void run(unsigned int parts, const Job& job);
+
+private:
+  void workerLoop();
+
+  /**
+   * @brief  Runs parts of the current job until none are left, lock is held on return
+   */
+  void runParts(boost::unique_lock<boost::mutex>& lock);
+
+  boost::thread_group workers_;
+
+  boost::mutex mutex_;
+  boost::condition_variable work_ready_, work_done_;
+  Job job_;
+  unsigned int parts_, next_part_;
+  unsigned int generation_;  ///< @brief Counts the jobs, workers wait for it to change
+  unsigned int busy_;  ///< @brief Workers that have not finished the current job yet
+  bool shutdown_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_WORKER_POOL_H_
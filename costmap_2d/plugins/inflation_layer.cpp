@@ -27,7 +27,6 @@ void InflationLayer::onInitialize()
     boost::unique_lock < boost::shared_mutex > lock(*access_);
     ros::NodeHandle nh("~/" + name_), g_nh;
     current_ = true;
-    seen_ = NULL;
     need_reinflation_ = false;
 
     dynamic_reconfigure::Server<costmap_2d::InflationPluginConfig>::CallbackType cb = boost::bind(
@@ -73,10 +72,7 @@ void InflationLayer::matchSize()
   cell_inflation_radius_ = cellDistance(inflation_radius_);
   computeCaches();
 
-  unsigned int size_x = costmap->getSizeInCellsX(), size_y = costmap->getSizeInCellsY();
-  if (seen_)
-    delete seen_;
-  seen_ = new bool[size_x * size_y];
+  seen_.resize(costmap->getSizeInCellsX(), costmap->getSizeInCellsY(), false);
 }
 
 void InflationLayer::updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x,
@@ -93,6 +89,15 @@ void InflationLayer::updateBounds(double robot_x, double robot_y, double robot_y
     *max_y = std::numeric_limits<float>::max();
     need_reinflation_ = false;
   }
+  else
+  {
+    // a cell that changed affects the inflated costs up to inflation_radius_ away,
+    // those have to be reset in the master grid as well or a cleared obstacle leaves its ring behind
+    *min_x -= inflation_radius_;
+    *min_y -= inflation_radius_;
+    *max_x += inflation_radius_;
+    *max_y += inflation_radius_;
+  }
 }
 
 void InflationLayer::onFootprintChanged()
@@ -119,7 +124,7 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
   unsigned char* master_array = master_grid.getCharMap();
   unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
 
-  memset(seen_, false, size_x * size_y * sizeof(bool));
+  seen_.reset();
 
   // We need to include in the inflation cells outside the bounding
   // box min_i...max_j, by the amount cell_inflation_radius_.  Cells
@@ -188,7 +193,7 @@ inline void InflationLayer::enqueue(unsigned char* grid, unsigned int index, uns
 {
 
   //set the cost of the cell being inserted
-  if (!seen_[index])
+  if (!seen_.get(mx, my))
   {
     //we compute our distance table one cell further than the inflation radius dictates so we can make the check below
     double distance = distanceLookup(mx, my, src_x, src_y);
@@ -206,7 +211,7 @@ inline void InflationLayer::enqueue(unsigned char* grid, unsigned int index, uns
     else
       grid[index] = std::max(old_cost, cost);
     //push the cell data onto the queue and mark
-    seen_[index] = true;
+    seen_.set(mx, my, true);
     CellData data(distance, index, mx, my, src_x, src_y);
     inflation_queue_.push(data);
   }
@@ -2,6 +2,7 @@
 #include<costmap_2d/costmap_math.h>
 
 #include <pluginlib/class_list_macros.h>
+#include <typeinfo>
 PLUGINLIB_EXPORT_CLASS(costmap_2d::ObstacleLayer, costmap_2d::Layer)
 
 using costmap_2d::NO_INFORMATION;
@@ -49,8 +50,9 @@ void ObstacleLayer::onInitialize()
 
     //get the parameters for the specific topic
     double observation_keep_time, expected_update_rate, min_obstacle_height, max_obstacle_height;
+    double downsample_resolution, downsample_z_resolution;
     std::string topic, sensor_frame, data_type;
-    bool inf_is_valid, clearing, marking;
+    bool inf_is_valid, clearing, marking, downsample;
 
     source_node.param("topic", topic, source);
     source_node.param("sensor_frame", sensor_frame, std::string(""));
@@ -62,6 +64,9 @@ void ObstacleLayer::onInitialize()
     source_node.param("inf_is_valid", inf_is_valid, false);
     source_node.param("clearing", clearing, false);
     source_node.param("marking", marking, true);
+    source_node.param("downsample", downsample, false);
+    source_node.param("downsample_resolution", downsample_resolution, layered_costmap_->getCostmap()->getResolution());
+    source_node.param("downsample_z_resolution", downsample_z_resolution, 0.0);
 
     if (!(data_type == "PointCloud2" || data_type == "PointCloud" || data_type == "LaserScan"))
     {
@@ -95,6 +100,14 @@ void ObstacleLayer::onInitialize()
                                      max_obstacle_height, obstacle_range, raytrace_range, *tf_, global_frame_,
                                      sensor_frame, transform_tolerance)));
 
+    //reduce the clouds of this source to one point per costmap cell (and height band) as they come in
+    if (downsample)
+    {
+      Costmap2D* master = layered_costmap_->getCostmap();
+      observation_buffers_.back()->setDownsampling(downsample_resolution, downsample_z_resolution,
+                                                   master->getOriginX(), master->getOriginY());
+    }
+
     //check if we'll add this buffer to our marking observation buffers
     if (marking)
       marking_buffers_.push_back(observation_buffers_.back());
@@ -385,6 +398,23 @@ void ObstacleLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, i
     updateWithMax(master_grid, min_i, min_j, max_i, max_j);
 }
 
+CostmapLayer::CombineRule ObstacleLayer::prepareCombine(int min_i, int min_j, int max_i, int max_j)
+{
+  // a subclass that overrides updateCosts() has to be composed through it
+  if (typeid(*this) != typeid(ObstacleLayer))
+    return COMBINE_CUSTOM;
+  return prepareObstacleCombine(min_i, min_j, max_i, max_j);
+}
+
+CostmapLayer::CombineRule ObstacleLayer::prepareObstacleCombine(int min_i, int min_j, int max_i, int max_j)
+{
+  if (!enabled_)
+    return COMBINE_NOTHING;
+
+  footprint_layer_.updateCosts(*this, min_i, min_j, max_i, max_j);
+  return combination_method_ == 0 ? COMBINE_OVERWRITE : COMBINE_MAX;
+}
+
 void ObstacleLayer::addStaticObservation(costmap_2d::Observation& obs, bool marking, bool clearing)
 {
   if(marking)
@@ -393,6 +423,14 @@ void ObstacleLayer::addStaticObservation(costmap_2d::Observation& obs, bool mark
     static_clearing_observations_.push_back(obs);
 }
 
+void ObstacleLayer::clearStaticObservations(bool marking, bool clearing)
+{
+  if(marking)
+    static_marking_observations_.clear();
+  if(clearing)
+    static_clearing_observations_.clear();
+}
+
 bool ObstacleLayer::getMarkingObservations(std::vector<Observation>& marking_observations) const
 {
   bool current = true;
@@ -430,7 +468,7 @@ void ObstacleLayer::raytraceFreespace(const Observation& clearing_observation, d
 {
   double ox = clearing_observation.origin_.x;
   double oy = clearing_observation.origin_.y;
-  pcl::PointCloud < pcl::PointXYZ > cloud = *(clearing_observation.cloud_);
+  const pcl::PointCloud<pcl::PointXYZ>& cloud = *(clearing_observation.cloud_);
 
   //get the map coordinates of the origin of the sensor
   unsigned int x0, y0;
@@ -548,6 +586,19 @@ void ObstacleLayer::reset()
     activate();
 }
 
+bool ObstacleLayer::clearWindow(double min_x, double min_y, double max_x, double max_y)
+{
+  int x0, y0, xn, yn;
+  worldToMapEnforceBounds(min_x, min_y, x0, y0);
+  worldToMapEnforceBounds(max_x, max_y, xn, yn);
+  if (xn < x0 || yn < y0)
+    return true;
+
+  resetMap(x0, y0, xn + 1, yn + 1);
+  setResetBounds(min_x, max_x, min_y, max_y);
+  return true;
+}
+
 void ObstacleLayer::onFootprintChanged()
 {
   footprint_layer_.onFootprintChanged();
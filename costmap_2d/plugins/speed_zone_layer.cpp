@@ -0,0 +1,134 @@
+#include <costmap_2d/speed_zone_layer.h>
+#include <pluginlib/class_list_macros.h>
+
+PLUGINLIB_EXPORT_CLASS(costmap_2d::SpeedZoneLayer, costmap_2d::Layer)
+
+namespace costmap_2d
+{
+
+SpeedZoneLayer::SpeedZoneLayer() :
+    speed_offset_(0.0), speed_multiplier_(0.01), zone_size_x_(0), zone_size_y_(0), zone_resolution_(0.0),
+    zone_origin_x_(0.0), zone_origin_y_(0.0), has_new_zones_(false), sampled_origin_x_(0.0),
+    sampled_origin_y_(0.0), sampled_resolution_(0.0), needs_resample_(true), dsrv_(NULL)
+{
+}
+
+SpeedZoneLayer::~SpeedZoneLayer()
+{
+  if (dsrv_)
+    delete dsrv_;
+}
+
+void SpeedZoneLayer::onInitialize()
+{
+  ros::NodeHandle nh("~/" + name_), g_nh;
+  current_ = true;
+  enabled_ = true;
+
+  nh.param("map_topic", map_topic_, std::string("speed_zones"));
+  nh.param("speed_offset", speed_offset_, 0.0);
+  nh.param("speed_multiplier", speed_multiplier_, 0.01);
+
+  // unlike the static layer we do not wait for the map, without one there are simply no limits
+  map_sub_ = g_nh.subscribe(map_topic_, 1, &SpeedZoneLayer::incomingMap, this);
+  matchSize();
+
+  if (dsrv_)
+  {
+    delete dsrv_;
+  }
+
+  dsrv_ = new dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig>(nh);
+  dynamic_reconfigure::Server<costmap_2d::GenericPluginConfig>::CallbackType cb = boost::bind(
+      &SpeedZoneLayer::reconfigureCB, this, _1, _2);
+  dsrv_->setCallback(cb);
+}
+
+void SpeedZoneLayer::reconfigureCB(costmap_2d::GenericPluginConfig &config, uint32_t level)
+{
+  boost::mutex::scoped_lock lock(zone_mutex_);
+  if (config.enabled != enabled_)
+  {
+    enabled_ = config.enabled;
+    needs_resample_ = true;
+  }
+}
+
+void SpeedZoneLayer::matchSize()
+{
+  Costmap2D* master = layered_costmap_->getCostmap();
+  boost::mutex::scoped_lock zone_lock(zone_mutex_);
+  boost::unique_lock < boost::shared_mutex > lock(*(master->getLock()));
+  resizeSpeedGrid(master->getSizeInCellsX(), master->getSizeInCellsY());
+  needs_resample_ = true;
+}
+
+void SpeedZoneLayer::incomingMap(const nav_msgs::OccupancyGridConstPtr& new_map)
+{
+  unsigned int size_x = new_map->info.width, size_y = new_map->info.height;
+  ROS_INFO("Received a %d X %d speed zone map at %f m/pix", size_x, size_y, new_map->info.resolution);
+
+  // convert once here so that resampling for a moving window is a plain copy
+  std::vector<float> limits(size_x * size_y);
+  for (unsigned int i = 0; i < limits.size(); ++i)
+  {
+    int value = new_map->data[i];
+    limits[i] = value < 0 ? NO_SPEED_LIMIT : float(speed_offset_ + speed_multiplier_ * value);
+  }
+
+  boost::mutex::scoped_lock lock(zone_mutex_);
+  zone_limits_.swap(limits);
+  zone_size_x_ = size_x;
+  zone_size_y_ = size_y;
+  zone_resolution_ = new_map->info.resolution;
+  zone_origin_x_ = new_map->info.origin.position.x;
+  zone_origin_y_ = new_map->info.origin.position.y;
+  has_new_zones_ = true;
+}
+
+void SpeedZoneLayer::activate()
+{
+  map_sub_ = ros::NodeHandle().subscribe(map_topic_, 1, &SpeedZoneLayer::incomingMap, this);
+}
+
+void SpeedZoneLayer::deactivate()
+{
+  map_sub_.shutdown();
+}
+
+void SpeedZoneLayer::reset()
+{
+  deactivate();
+  activate();
+}
+
+void SpeedZoneLayer::updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x,
+                                  double* min_y, double* max_x, double* max_y)
+{
+  // the limits do not change any costs, so the bounds are left alone; the grid is only
+  // resampled when new zones arrived or the master moved, which for a rolling window is
+  // at most once per update
+  Costmap2D* master = layered_costmap_->getCostmap();
+  boost::mutex::scoped_lock zone_lock(zone_mutex_);
+  if (!needs_resample_ && !has_new_zones_ && sampled_origin_x_ == master->getOriginX()
+      && sampled_origin_y_ == master->getOriginY() && sampled_resolution_ == master->getResolution())
+    return;
+
+  boost::unique_lock < boost::shared_mutex > lock(*(master->getLock()));
+  if (getSpeedGridSizeX() != master->getSizeInCellsX() || getSpeedGridSizeY() != master->getSizeInCellsY())
+    resizeSpeedGrid(master->getSizeInCellsX(), master->getSizeInCellsY());
+
+  if (enabled_)
+    sampleSpeedLimits(master->getResolution(), master->getOriginX(), master->getOriginY(), zone_limits_,
+                      zone_size_x_, zone_size_y_, zone_resolution_, zone_origin_x_, zone_origin_y_);
+  else
+    clearSpeedLimits();
+
+  sampled_origin_x_ = master->getOriginX();
+  sampled_origin_y_ = master->getOriginY();
+  sampled_resolution_ = master->getResolution();
+  has_new_zones_ = false;
+  needs_resample_ = false;
+}
+
+}  // namespace costmap_2d
@@ -1,6 +1,7 @@
 #include<costmap_2d/static_layer.h>
 #include<costmap_2d/costmap_math.h>
 #include <pluginlib/class_list_macros.h>
+#include <typeinfo>
 
 PLUGINLIB_EXPORT_CLASS(costmap_2d::StaticLayer, costmap_2d::Layer)
 
@@ -202,7 +203,7 @@ void StaticLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
 
 void StaticLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
 {
-  if (!map_received_)
+  if (!map_received_ || !enabled_)
     return;
   if(!use_maximum_)
       updateWithTrueOverwrite(master_grid, min_i, min_j, max_i, max_j);
@@ -210,4 +211,14 @@ void StaticLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int
       updateWithMax(master_grid, min_i, min_j, max_i, max_j);
 }
 
+CostmapLayer::CombineRule StaticLayer::prepareCombine(int min_i, int min_j, int max_i, int max_j)
+{
+  // a subclass that overrides updateCosts() has to be composed through it
+  if (typeid(*this) != typeid(StaticLayer))
+    return COMBINE_CUSTOM;
+  if (!map_received_ || !enabled_)
+    return COMBINE_NOTHING;
+  return use_maximum_ ? COMBINE_MAX : COMBINE_TRUE_OVERWRITE;
+}
+
 }
@@ -1,6 +1,8 @@
 #include <costmap_2d/voxel_layer.h>
 #include <pluginlib/class_list_macros.h>
 #include <pcl_conversions/pcl_conversions.h>
+#include <limits>
+#include <typeinfo>
 
 #define VOXEL_BITS 16
 PLUGINLIB_EXPORT_CLASS(costmap_2d::VoxelLayer, costmap_2d::Layer)
@@ -25,6 +27,13 @@ void VoxelLayer::onInitialize()
     voxel_pub_ = private_nh.advertise < costmap_2d::VoxelGrid > ("voxel_grid", 1);
 
   clearing_endpoints_pub_ = private_nh.advertise<sensor_msgs::PointCloud>( "clearing_endpoints", 1 );
+
+  //marking is split over this many threads, 0 for one per core
+  int marking_threads;
+  private_nh.param("marking_threads", marking_threads, 1);
+  marking_threads_ = marking_threads > 0 ? marking_threads : std::max(1u, boost::thread::hardware_concurrency());
+  if (marking_threads_ > 1)
+    marking_pool_.reset(new WorkerPool(marking_threads_));
 }
 
 void VoxelLayer::setupDynamicReconfigure(ros::NodeHandle& nh)
@@ -53,6 +62,7 @@ void VoxelLayer::matchSize()
   ObstacleLayer::matchSize();
   voxel_grid_.resize(size_x_, size_y_, size_z_);
   ROS_ASSERT(voxel_grid_.sizeX() == size_x_ && voxel_grid_.sizeY() == size_y_);
+  dirty_columns_.assign((size_x_ * size_y_ + 31) / 32, 0);
 }
 
 void VoxelLayer::reset()
@@ -63,6 +73,32 @@ void VoxelLayer::reset()
   activate();
 }
 
+bool VoxelLayer::clearWindow(double min_x, double min_y, double max_x, double max_y)
+{
+  int x0, y0, xn, yn;
+  worldToMapEnforceBounds(min_x, min_y, x0, y0);
+  worldToMapEnforceBounds(max_x, max_y, xn, yn);
+  if (xn < x0 || yn < y0)
+    return true;
+
+  ObstacleLayer::clearWindow(min_x, min_y, max_x, max_y);
+
+  for (int y = y0; y <= yn; ++y)
+  {
+    for (int x = x0; x <= xn; ++x)
+      voxel_grid_.resetVoxelColumn(getIndex(x, y));
+  }
+  return true;
+}
+
+CostmapLayer::CombineRule VoxelLayer::prepareCombine(int min_i, int min_j, int max_i, int max_j)
+{
+  // a subclass that overrides updateCosts() has to be composed through it
+  if (typeid(*this) != typeid(VoxelLayer))
+    return COMBINE_CUSTOM;
+  return prepareObstacleCombine(min_i, min_j, max_i, max_j);
+}
+
 void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x,
                                        double* min_y, double* max_x, double* max_y)
 {
@@ -101,7 +137,43 @@ void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
     raytraceFreespace(clearing_observations[i], min_x, min_y, max_x, max_y);
   }
 
-  //place the new obstacles into a priority queue... each with a priority of zero to begin with
+  //bring the costmap up to date with the columns the rays went through
+  projectDirtyColumns(min_x, min_y, max_x, max_y);
+
+  //place the new obstacles into the voxel grid and the costmap
+  if (marking_threads_ > 1)
+    markObservationsParallel(observations, min_x, min_y, max_x, max_y);
+  else
+    markObservations(observations, min_x, min_y, max_x, max_y);
+
+  if (publish_voxel_)
+  {
+    costmap_2d::VoxelGrid grid_msg;
+    unsigned int size = voxel_grid_.sizeX() * voxel_grid_.sizeY();
+    grid_msg.size_x = voxel_grid_.sizeX();
+    grid_msg.size_y = voxel_grid_.sizeY();
+    grid_msg.size_z = voxel_grid_.sizeZ();
+    grid_msg.data.resize(size);
+    memcpy(&grid_msg.data[0], voxel_grid_.getData(), size * sizeof(unsigned int));
+
+    grid_msg.origin.x = origin_x_;
+    grid_msg.origin.y = origin_y_;
+    grid_msg.origin.z = origin_z_;
+
+    grid_msg.resolutions.x = resolution_;
+    grid_msg.resolutions.y = resolution_;
+    grid_msg.resolutions.z = z_resolution_;
+    grid_msg.header.frame_id = global_frame_;
+    grid_msg.header.stamp = ros::Time::now();
+    voxel_pub_.publish(grid_msg);
+  }
+
+  footprint_layer_.updateBounds(robot_x, robot_y, robot_yaw, min_x, min_y, max_x, max_y);
+}
+
+void VoxelLayer::markObservations(const std::vector<Observation>& observations, double* min_x, double* min_y,
+                                  double* max_x, double* max_y)
+{
   for (std::vector<Observation>::const_iterator it = observations.begin(); it != observations.end(); ++it)
   {
     const Observation& obs = *it;
@@ -112,30 +184,9 @@ void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
 
     for (unsigned int i = 0; i < cloud.points.size(); ++i)
     {
-      //if the obstacle is too high or too far away from the robot we won't add it
-      if (cloud.points[i].z > max_obstacle_height_)
-        continue;
-
-      //compute the squared distance from the hitpoint to the pointcloud's origin
-      double sq_dist = (cloud.points[i].x - obs.origin_.x) * (cloud.points[i].x - obs.origin_.x)
-          + (cloud.points[i].y - obs.origin_.y) * (cloud.points[i].y - obs.origin_.y)
-          + (cloud.points[i].z - obs.origin_.z) * (cloud.points[i].z - obs.origin_.z);
-
-      //if the point is far enough away... we won't consider it
-      if (sq_dist >= sq_obstacle_range)
-        continue;
-
-      //now we need to compute the map coordinates for the observation
       unsigned int mx, my, mz;
-      if (cloud.points[i].z < origin_z_)
-      {
-        if (!worldToMap3D(cloud.points[i].x, cloud.points[i].y, origin_z_, mx, my, mz))
-          continue;
-      }
-      else if (!worldToMap3D(cloud.points[i].x, cloud.points[i].y, cloud.points[i].z, mx, my, mz))
-      {
+      if (!markingVoxel(obs, sq_obstacle_range, cloud.points[i], mx, my, mz))
         continue;
-      }
 
       //mark the cell in the voxel grid and check if we should also mark it in the costmap
       if (voxel_grid_.markVoxelInMap(mx, my, mz, mark_threshold_))
@@ -147,30 +198,125 @@ void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
       }
     }
   }
+}
 
-  if (publish_voxel_)
+void VoxelLayer::markObservationsParallel(const std::vector<Observation>& observations, double* min_x,
+                                          double* min_y, double* max_x, double* max_y)
+{
+  //marks only ever set bits in the column words, so the threads can share the voxel grid as
+  //long as they or atomically; each collects the columns it pushed over the threshold
+  marked_columns_.resize(marking_threads_);
+  marking_pool_->run(marking_threads_, boost::bind(&VoxelLayer::markSlice, this, &observations, _1));
+
+  //then every thread writes the costmap rows of its band, so no cell is written by two threads
+  marking_pool_->run(marking_threads_, boost::bind(&VoxelLayer::projectRows, this, _1));
+
+  for (unsigned int t = 0; t < marking_threads_; ++t)
   {
-    costmap_2d::VoxelGrid grid_msg;
-    unsigned int size = voxel_grid_.sizeX() * voxel_grid_.sizeY();
-    grid_msg.size_x = voxel_grid_.sizeX();
-    grid_msg.size_y = voxel_grid_.sizeY();
-    grid_msg.size_z = voxel_grid_.sizeZ();
-    grid_msg.data.resize(size);
-    memcpy(&grid_msg.data[0], voxel_grid_.getData(), size * sizeof(unsigned int));
+    const MarkedColumns& marked = marked_columns_[t];
+    if (marked.min_x > marked.max_x)
+      continue;
+    *min_x = std::min(*min_x, marked.min_x);
+    *min_y = std::min(*min_y, marked.min_y);
+    *max_x = std::max(*max_x, marked.max_x);
+    *max_y = std::max(*max_y, marked.max_y);
+  }
+}
 
-    grid_msg.origin.x = origin_x_;
-    grid_msg.origin.y = origin_y_;
-    grid_msg.origin.z = origin_z_;
+void VoxelLayer::markSlice(const std::vector<Observation>* observations, unsigned int slice)
+{
+  unsigned int slices = marking_threads_;
+  MarkedColumns* marked = &marked_columns_[slice];
+  marked->bands.resize(slices);
+  for (unsigned int band = 0; band < slices; ++band)
+    marked->bands[band].clear();
+  marked->min_x = marked->min_y = std::numeric_limits<double>::max();
+  marked->max_x = marked->max_y = -std::numeric_limits<double>::max();
+
+  for (std::vector<Observation>::const_iterator it = observations->begin(); it != observations->end(); ++it)
+  {
+    const Observation& obs = *it;
 
-    grid_msg.resolutions.x = resolution_;
-    grid_msg.resolutions.y = resolution_;
-    grid_msg.resolutions.z = z_resolution_;
-    grid_msg.header.frame_id = global_frame_;
-    grid_msg.header.stamp = ros::Time::now();
-    voxel_pub_.publish(grid_msg);
+    const pcl::PointCloud<pcl::PointXYZ>& cloud = *(obs.cloud_);
+
+    double sq_obstacle_range = obs.obstacle_range_ * obs.obstacle_range_;
+
+    //every thread takes its share of each cloud, so a single large cloud is split as well
+    unsigned int begin = cloud.points.size() * slice / slices;
+    unsigned int end = cloud.points.size() * (slice + 1) / slices;
+    for (unsigned int i = begin; i < end; ++i)
+    {
+      unsigned int mx, my, mz;
+      if (!markingVoxel(obs, sq_obstacle_range, cloud.points[i], mx, my, mz))
+        continue;
+
+      if (voxel_grid_.markVoxelInMapAtomic(mx, my, mz, mark_threshold_))
+      {
+        //the bands split the rows as evenly as the slices split the points
+        marked->bands[my * slices / size_y_].push_back(getIndex(mx, my));
+        touch((double)cloud.points[i].x, (double)cloud.points[i].y, &marked->min_x, &marked->min_y, &marked->max_x,
+              &marked->max_y);
+      }
+    }
   }
+}
 
-  footprint_layer_.updateBounds(robot_x, robot_y, robot_yaw, min_x, min_y, max_x, max_y);
+void VoxelLayer::projectRows(unsigned int band)
+{
+  for (std::vector<MarkedColumns>::const_iterator it = marked_columns_.begin(); it != marked_columns_.end(); ++it)
+  {
+    const std::vector<unsigned int>& indices = it->bands[band];
+    for (std::vector<unsigned int>::const_iterator index = indices.begin(); index != indices.end(); ++index)
+      costmap_[*index] = LETHAL_OBSTACLE;
+  }
+}
+
+void VoxelLayer::projectDirtyColumns(double* min_x, double* min_y, double* max_x, double* max_y)
+{
+  unsigned int min_mx = size_x_, min_my = size_y_, max_mx = 0, max_my = 0;
+  for (unsigned int w = 0; w < dirty_columns_.size(); ++w)
+  {
+    uint32_t word = dirty_columns_[w];
+    if (word == 0)
+      continue;
+    dirty_columns_[w] = 0;
+
+    do
+    {
+      unsigned int index = (w << 5) + __builtin_ctz(word);
+      word &= word - 1;
+
+      unsigned char cost;
+      switch (voxel_grid_.getColumnStatus(index, unknown_threshold_, mark_threshold_))
+      {
+        case voxel_grid::MARKED:
+          cost = LETHAL_OBSTACLE;
+          break;
+        case voxel_grid::UNKNOWN:
+          cost = NO_INFORMATION;
+          break;
+        default:
+          cost = FREE_SPACE;
+      }
+      if (costmap_[index] == cost)
+        continue;
+      costmap_[index] = cost;
+
+      //the bounds only need to grow for the cells whose cost really changed
+      unsigned int mx, my;
+      indexToCells(index, mx, my);
+      min_mx = std::min(min_mx, mx);
+      min_my = std::min(min_my, my);
+      max_mx = std::max(max_mx, mx);
+      max_my = std::max(max_my, my);
+    } while (word);
+  }
+
+  if (min_mx > max_mx || min_my > max_my)
+    return;
+
+  touch(origin_x_ + min_mx * resolution_, origin_y_ + min_my * resolution_, min_x, min_y, max_x, max_y);
+  touch(origin_x_ + (max_mx + 1) * resolution_, origin_y_ + (max_my + 1) * resolution_, min_x, min_y, max_x, max_y);
 }
 
 void VoxelLayer::clearNonLethal(double wx, double wy, double w_size_x, double w_size_y, bool clear_no_info)
@@ -315,12 +461,9 @@ void VoxelLayer::raytraceFreespace(const Observation& clearing_observation, doub
     {
       unsigned int cell_raytrace_range = cellDistance(clearing_observation.raytrace_range_);
 
-      //voxel_grid_.markVoxelLine(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z);
-      voxel_grid_.clearVoxelLineInMap(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z, costmap_,
-                                      unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION,
-                                      cell_raytrace_range);
-
-      updateRaytraceBounds(ox, oy, wpx, wpy, clearing_observation.raytrace_range_, min_x, min_y, max_x, max_y);
+      //only flag the columns here, they get projected once all the rays are in
+      voxel_grid_.clearVoxelLineInMask(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z, &dirty_columns_[0],
+                                       cell_raytrace_range);
 
       if( publish_clearing_points )
       {
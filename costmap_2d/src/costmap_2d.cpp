@@ -37,15 +37,47 @@
  *********************************************************************/
 #include <costmap_2d/costmap_2d.h>
 #include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
 
 using namespace std;
 
 namespace costmap_2d
 {
+namespace
+{
+// layout of the saveBinary header; values are stored in host byte order
+const char BINARY_MAGIC[4] = {'C', 'M', 'A', 'P'};
+const uint32_t BINARY_VERSION = 1;
+const size_t BINARY_HEADER_SIZE = 4 + 3 * sizeof(uint32_t) + 3 * sizeof(double) + 4;
+
+// every map takes its revisions from a range of its own, so a revision is never seen on two maps
+uint64_t firstRevision()
+{
+  static uint32_t maps_created = 0;
+  return (uint64_t)__sync_add_and_fetch(&maps_created, 1) << 32;
+}
+
+template<typename T>
+void putField(unsigned char*& out, const T& value)
+{
+  memcpy(out, &value, sizeof(T));
+  out += sizeof(T);
+}
+
+template<typename T>
+void getField(const unsigned char*& in, T& value)
+{
+  memcpy(&value, in, sizeof(T));
+  in += sizeof(T);
+}
+}  // namespace
+
 Costmap2D::Costmap2D(unsigned int cells_size_x, unsigned int cells_size_y, double resolution,
                      double origin_x, double origin_y, unsigned char default_value) :
     size_x_(cells_size_x), size_y_(cells_size_y), resolution_(resolution), origin_x_(origin_x), 
-    origin_y_(origin_y), costmap_(NULL), default_value_(default_value)
+    origin_y_(origin_y), costmap_(NULL), default_value_(default_value), revision_(firstRevision())
 {
   access_ = new boost::shared_mutex();
 
@@ -65,6 +97,7 @@ void Costmap2D::initMaps(unsigned int size_x, unsigned int size_y)
 {
   boost::unique_lock < boost::shared_mutex > lock(*access_);
   costmap_ = new unsigned char[size_x * size_y];
+  ++revision_;
 }
 
 void Costmap2D::resizeMap(unsigned int size_x, unsigned int size_y, double resolution,
@@ -86,6 +119,7 @@ void Costmap2D::resetMaps()
 {
   boost::unique_lock < boost::shared_mutex > lock(*access_);
   memset(costmap_, default_value_, size_x_ * size_y_ * sizeof(unsigned char));
+  ++revision_;
 }
 
 void Costmap2D::resetMap(unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
@@ -94,6 +128,7 @@ void Costmap2D::resetMap(unsigned int x0, unsigned int y0, unsigned int xn, unsi
   unsigned int len = xn - x0;
   for (unsigned int y = y0 * size_x_ + x0; y < yn * size_x_ + x0; y += size_x_)
     memset(costmap_ + y, default_value_, len * sizeof(unsigned char));
+  ++revision_;
 }
 
 bool Costmap2D::copyCostmapWindow(const Costmap2D& map, double win_origin_x, double win_origin_y, double win_size_x,
@@ -158,14 +193,15 @@ Costmap2D& Costmap2D::operator=(const Costmap2D& map)
 }
 
 Costmap2D::Costmap2D(const Costmap2D& map) :
-    costmap_(NULL)
+    costmap_(NULL), revision_(firstRevision())
 {
   *this = map;
 }
 
 //just initialize everything to NULL by default
 Costmap2D::Costmap2D() :
-    size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0), costmap_(NULL)
+    size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0), costmap_(NULL),
+    revision_(firstRevision())
 {
   access_ = new boost::shared_mutex();
 }
@@ -194,6 +230,7 @@ unsigned char Costmap2D::getCost(unsigned int mx, unsigned int my) const
 void Costmap2D::setCost(unsigned int mx, unsigned int my, unsigned char cost)
 {
   costmap_[getIndex(mx, my)] = cost;
+  ++revision_;
 }
 
 void Costmap2D::mapToWorld(unsigned int mx, unsigned int my, double& wx, double& wy) const
@@ -301,6 +338,9 @@ void Costmap2D::updateOrigin(double new_origin_x, double new_origin_y)
   //now we want to copy the overlapping information back into the map, but in its new location
   copyMapRegion(local_map, 0, 0, cell_size_x, costmap_, start_x, start_y, size_x_, cell_size_x, cell_size_y);
 
+  //every cell now stands for another place in the world
+  ++revision_;
+
   //make sure to clean up
   delete[] local_map;
 }
@@ -331,6 +371,7 @@ bool Costmap2D::setConvexPolygonCost(const std::vector<geometry_msgs::Point>& po
     unsigned int index = getIndex(polygon_cells[i].x, polygon_cells[i].y);
     costmap_[index] = cost_value;
   }
+  ++revision_;
   return true;
 }
 
@@ -466,16 +507,159 @@ bool Costmap2D::saveMap(std::string file_name)
   }
 
   fprintf(fp, "P2\n%u\n%u\n%u\n", size_x_, size_y_, 0xff);
-  for (unsigned int iy = 0; iy < size_y_; iy++)
+
+  // format each row into a buffer and write it at once rather than calling fprintf per cell
+  std::vector<char> row(size_x_ * 4 + 1);
+  bool ok = true;
+  for (unsigned int iy = 0; iy < size_y_ && ok; iy++)
   {
+    const unsigned char* costs = costmap_ + getIndex(0, iy);
+    char* out = &row[0];
     for (unsigned int ix = 0; ix < size_x_; ix++)
     {
-      unsigned char cost = getCost(ix, iy);
-      fprintf(fp, "%d ", cost);
+      unsigned char cost = costs[ix];
+      if (cost >= 100)
+        *out++ = '0' + cost / 100;
+      if (cost >= 10)
+        *out++ = '0' + (cost / 10) % 10;
+      *out++ = '0' + cost % 10;
+      *out++ = ' ';
+    }
+    *out++ = '\n';
+    ok = fwrite(&row[0], 1, out - &row[0], fp) == static_cast<size_t>(out - &row[0]);
+  }
+  fclose(fp);
+  return ok;
+}
+
+bool Costmap2D::saveBinary(const std::string& file_name, bool compress)
+{
+  FILE *fp = fopen(file_name.c_str(), "wb");
+
+  if (!fp)
+  {
+    return false;
+  }
+
+  size_t cells = static_cast<size_t>(size_x_) * size_y_;
+  std::vector<unsigned char> buffer(BINARY_HEADER_SIZE);
+  unsigned char* out = &buffer[0];
+  memcpy(out, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  out += sizeof(BINARY_MAGIC);
+  putField(out, BINARY_VERSION);
+  putField(out, static_cast<uint32_t>(size_x_));
+  putField(out, static_cast<uint32_t>(size_y_));
+  putField(out, resolution_);
+  putField(out, origin_x_);
+  putField(out, origin_y_);
+  putField(out, default_value_);
+  putField(out, static_cast<unsigned char>(compress ? 1 : 0));
+  putField(out, static_cast<uint16_t>(0));
+
+  if (compress)
+  {
+    // (count, cost) pairs with runs capped at 255 cells
+    size_t i = 0;
+    while (i < cells)
+    {
+      unsigned char cost = costmap_[i];
+      size_t run = 1;
+      while (run < 255 && i + run < cells && costmap_[i + run] == cost)
+        ++run;
+      buffer.push_back(static_cast<unsigned char>(run));
+      buffer.push_back(cost);
+      i += run;
+    }
+  }
+
+  bool ok = fwrite(&buffer[0], 1, buffer.size(), fp) == buffer.size();
+  if (ok && !compress && cells > 0)
+    ok = fwrite(costmap_, 1, cells, fp) == cells;
+
+  ok = fclose(fp) == 0 && ok;
+  return ok;
+}
+
+bool Costmap2D::loadBinary(const std::string& file_name)
+{
+  FILE *fp = fopen(file_name.c_str(), "rb");
+
+  if (!fp)
+  {
+    return false;
+  }
+
+  unsigned char header[BINARY_HEADER_SIZE];
+  if (fread(header, 1, BINARY_HEADER_SIZE, fp) != BINARY_HEADER_SIZE
+      || memcmp(header, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+  {
+    fclose(fp);
+    return false;
+  }
+
+  const unsigned char* in = header + sizeof(BINARY_MAGIC);
+  uint32_t version, size_x, size_y;
+  double resolution, origin_x, origin_y;
+  unsigned char default_value, compressed;
+  getField(in, version);
+  getField(in, size_x);
+  getField(in, size_y);
+  getField(in, resolution);
+  getField(in, origin_x);
+  getField(in, origin_y);
+  getField(in, default_value);
+  getField(in, compressed);
+
+  if (version != BINARY_VERSION)
+  {
+    fclose(fp);
+    return false;
+  }
+
+  size_t cells = static_cast<size_t>(size_x) * size_y;
+  std::vector<unsigned char> data;
+  if (compressed)
+  {
+    std::vector<unsigned char> runs;
+    unsigned char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+      runs.insert(runs.end(), chunk, chunk + n);
+    if (runs.size() % 2 != 0)
+    {
+      fclose(fp);
+      return false;
+    }
+
+    data.reserve(cells);
+    for (size_t i = 0; i < runs.size(); i += 2)
+    {
+      if (runs[i] == 0 || data.size() + runs[i] > cells)
+      {
+        fclose(fp);
+        return false;
+      }
+      data.insert(data.end(), runs[i], runs[i + 1]);
     }
-    fprintf(fp, "\n");
+  }
+  else
+  {
+    data.resize(cells);
+    if (cells > 0 && fread(&data[0], 1, cells, fp) != cells)
+      data.clear();
   }
   fclose(fp);
+
+  if (data.size() != cells)
+  {
+    return false;
+  }
+
+  default_value_ = default_value;
+  resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+  if (cells > 0)
+    memcpy(costmap_, &data[0], cells);
+  ++revision_;
   return true;
 }
 
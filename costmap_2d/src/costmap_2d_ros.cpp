@@ -39,6 +39,7 @@
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/costmap_2d_ros.h>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <algorithm>
 #include <vector>
@@ -97,6 +98,11 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
     }
   }
 
+  private_nh.param("cache_robot_pose", cache_robot_pose_, true);
+  if (cache_robot_pose_)
+    transforms_changed_connection_ = tf_.addTransformsChangedListener(
+        boost::bind(&RobotPoseCache::invalidate, &robot_pose_cache_));
+
   // check if we want a rolling window version of the costmap
   bool rolling_window, track_unknown_space, always_send_full_costmap;
   private_nh.param("rolling_window", rolling_window, false);
@@ -105,6 +111,10 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
 
   layered_costmap_ = new LayeredCostmap(global_frame_, rolling_window, track_unknown_space);
 
+  bool fused_composition;
+  private_nh.param("fused_composition", fused_composition, false);
+  layered_costmap_->setFusedComposition(fused_composition);
+
   if (!private_nh.hasParam("plugins"))
   {
     resetOldParameters(private_nh);
@@ -162,6 +172,9 @@ void Costmap2DROS::setUnpaddedRobotFootprintPolygon( const geometry_msgs::Polygo
 
 Costmap2DROS::~Costmap2DROS()
 {
+  if (cache_robot_pose_)
+    tf_.removeTransformsChangedListener(transforms_changed_connection_);
+
   map_update_thread_shutdown_ = true;
   if (map_update_thread_ != NULL)
   {
@@ -574,16 +587,32 @@ void Costmap2DROS::updateMap()
 {
   if (!stop_updates_)
   {
+    runLayerJobs();
+
     //get global pose
     tf::Stamped < tf::Pose > pose;
     if (getRobotPose (pose))
     {
       layered_costmap_->updateMap(pose.getOrigin().x(), pose.getOrigin().y(), tf::getYaw(pose.getRotation()));
       initialized_ = true;
+
+      boost::mutex::scoped_lock lock(update_callback_mutex_);
+      if (update_callback_)
+      {
+        unsigned int x0, y0, xn, yn;
+        layered_costmap_->getBounds(&x0, &xn, &y0, &yn);
+        update_callback_(x0, xn, y0, yn);
+      }
     }
   }
 }
 
+void Costmap2DROS::setUpdateCallback(const UpdateCallback& callback)
+{
+  boost::mutex::scoped_lock lock(update_callback_mutex_);
+  update_callback_ = callback;
+}
+
 void Costmap2DROS::start()
 {
   std::vector < boost::shared_ptr<Layer> > *plugins = layered_costmap_->getPlugins();
@@ -647,6 +676,77 @@ void Costmap2DROS::resetLayers()
   }
 }
 
+bool Costmap2DROS::clearWindow(double size_x, double size_y)
+{
+  double min_x, min_y, max_x, max_y;
+  if (!clearMasterWindow(size_x, size_y, &min_x, &min_y, &max_x, &max_y))
+    return false;
+
+  queueLayerJob(boost::bind(&Costmap2DROS::clearLayerWindows, this, min_x, min_y, max_x, max_y));
+  return true;
+}
+
+bool Costmap2DROS::clearMasterWindow(double size_x, double size_y)
+{
+  double min_x, min_y, max_x, max_y;
+  return clearMasterWindow(size_x, size_y, &min_x, &min_y, &max_x, &max_y);
+}
+
+bool Costmap2DROS::clearMasterWindow(double size_x, double size_y, double* min_x, double* min_y, double* max_x,
+                                     double* max_y)
+{
+  tf::Stamped < tf::Pose > pose;
+  if (!getRobotPose(pose))
+    return false;
+
+  *min_x = pose.getOrigin().x() - size_x / 2;
+  *max_x = *min_x + size_x;
+  *min_y = pose.getOrigin().y() - size_y / 2;
+  *max_y = *min_y + size_y;
+
+  Costmap2D* master = layered_costmap_->getCostmap();
+  int x0, y0, xn, yn;
+  master->worldToMapEnforceBounds(*min_x, *min_y, x0, y0);
+  master->worldToMapEnforceBounds(*max_x, *max_y, xn, yn);
+  if (xn < x0 || yn < y0)
+    return true;
+
+  boost::unique_lock < boost::shared_mutex > lock(*(master->getLock()));
+  unsigned char* costs = master->getCharMap();
+  unsigned int size = master->getSizeInCellsX();
+  for (int y = y0; y <= yn; ++y)
+    memset(costs + y * size + x0, FREE_SPACE, xn - x0 + 1);
+  master->incrementRevision();
+  return true;
+}
+
+void Costmap2DROS::queueLayerJob(const LayerJob& job)
+{
+  boost::mutex::scoped_lock lock(layer_jobs_mutex_);
+  layer_jobs_.push_back(job);
+}
+
+void Costmap2DROS::runLayerJobs()
+{
+  std::vector<LayerJob> jobs;
+  {
+    boost::mutex::scoped_lock lock(layer_jobs_mutex_);
+    jobs.swap(layer_jobs_);
+  }
+
+  for (unsigned int i = 0; i < jobs.size(); ++i)
+    jobs[i]();
+}
+
+void Costmap2DROS::clearLayerWindows(double min_x, double min_y, double max_x, double max_y)
+{
+  std::vector < boost::shared_ptr<Layer> > *plugins = layered_costmap_->getPlugins();
+  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end(); ++plugin)
+  {
+    (*plugin)->clearWindow(min_x, min_y, max_x, max_y);
+  }
+}
+
 bool Costmap2DROS::getRobotPose(tf::Stamped<tf::Pose>& global_pose) const
 {
 
@@ -657,25 +757,36 @@ bool Costmap2DROS::getRobotPose(tf::Stamped<tf::Pose>& global_pose) const
   robot_pose.stamp_ = ros::Time();
   ros::Time current_time = ros::Time::now(); // save time for checking tf delay later
 
-  //get the global pose of the robot
-  try
+  //the latest transform only changes when tf receives new ones, until then the last lookup is still good
+  boost::uint32_t generation = robot_pose_cache_.getGeneration();
+  if (cache_robot_pose_ && robot_pose_cache_.load(global_pose))
   {
-    tf_.transformPose(global_frame_, robot_pose, global_pose);
+    global_pose.frame_id_ = global_frame_;
   }
-  catch (tf::LookupException& ex)
-  {
-    ROS_ERROR_THROTTLE(1.0, "No Transform available Error looking up robot pose: %s\n", ex.what());
-    return false;
-  }
-  catch (tf::ConnectivityException& ex)
-  {
-    ROS_ERROR_THROTTLE(1.0, "Connectivity Error looking up robot pose: %s\n", ex.what());
-    return false;
-  }
-  catch (tf::ExtrapolationException& ex)
+  else
   {
-    ROS_ERROR_THROTTLE(1.0, "Extrapolation Error looking up robot pose: %s\n", ex.what());
-    return false;
+    //get the global pose of the robot
+    try
+    {
+      tf_.transformPose(global_frame_, robot_pose, global_pose);
+    }
+    catch (tf::LookupException& ex)
+    {
+      ROS_ERROR_THROTTLE(1.0, "No Transform available Error looking up robot pose: %s\n", ex.what());
+      return false;
+    }
+    catch (tf::ConnectivityException& ex)
+    {
+      ROS_ERROR_THROTTLE(1.0, "Connectivity Error looking up robot pose: %s\n", ex.what());
+      return false;
+    }
+    catch (tf::ExtrapolationException& ex)
+    {
+      ROS_ERROR_THROTTLE(1.0, "Extrapolation Error looking up robot pose: %s\n", ex.what());
+      return false;
+    }
+    if (cache_robot_pose_)
+      robot_pose_cache_.store(generation, global_pose);
   }
   // check global_pose timeout
   if (current_time.toSec() - global_pose.stamp_.toSec() > transform_tolerance_)
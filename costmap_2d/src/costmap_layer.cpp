@@ -1,4 +1,6 @@
 #include<costmap_2d/costmap_layer.h>
+#include<costmap_2d/layer_combine.h>
+#include<cstring>
 
 namespace costmap_2d
 {
@@ -20,7 +22,7 @@ void CostmapLayer::matchSize()
 
 void CostmapLayer::updateWithMax(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
 {
-  if (!enabled_)
+  if (!enabled_ || max_i <= min_i)
     return;
 
   unsigned char* master_array = master_grid.getCharMap();
@@ -29,24 +31,13 @@ void CostmapLayer::updateWithMax(costmap_2d::Costmap2D& master_grid, int min_i,
   for (int j = min_j; j < max_j; j++)
   {
     unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++)
-    {
-      if (costmap_[it] == NO_INFORMATION){
-        it++;
-        continue;
-      }
-
-      unsigned char old_cost = master_array[it];
-      if (old_cost == NO_INFORMATION || old_cost < costmap_[it])
-        master_array[it] = costmap_[it];
-      it++;
-    }
+    combineMax(master_array + it, costmap_ + it, max_i - min_i);
   }
 }
 
 void CostmapLayer::updateWithTrueOverwrite(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
 {
-  if (!enabled_)
+  if (!enabled_ || max_i <= min_i)
     return;
   unsigned char* master = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
@@ -54,17 +45,13 @@ void CostmapLayer::updateWithTrueOverwrite(costmap_2d::Costmap2D& master_grid, i
   for (int j = min_j; j < max_j; j++)
   {
     unsigned int it = span*j+min_i;
-    for (int i = min_i; i < max_i; i++)
-    {
-      master[it] = costmap_[it];
-      it++;
-    }
+    memcpy(master + it, costmap_ + it, max_i - min_i);
   }
 }
 
 void CostmapLayer::updateWithOverwrite(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
 {
-  if (!enabled_)
+  if (!enabled_ || max_i <= min_i)
     return;
   unsigned char* master = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
@@ -72,18 +59,13 @@ void CostmapLayer::updateWithOverwrite(costmap_2d::Costmap2D& master_grid, int m
   for (int j = min_j; j < max_j; j++)
   {
     unsigned int it = span*j+min_i;
-    for (int i = min_i; i < max_i; i++)
-    {
-      if (costmap_[it] != NO_INFORMATION)
-        master[it] = costmap_[it];
-      it++;
-    }
+    combineOverwrite(master + it, costmap_ + it, max_i - min_i);
   }
 }
 
 void CostmapLayer::updateWithAddition(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
 {
-  if (!enabled_)
+  if (!enabled_ || max_i <= min_i)
     return;
   unsigned char* master_array = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
@@ -91,28 +73,7 @@ void CostmapLayer::updateWithAddition(costmap_2d::Costmap2D& master_grid, int mi
   for (int j = min_j; j < max_j; j++)
   {
     unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++)
-    {
-      if (costmap_[it] == NO_INFORMATION){
-        it++;
-        continue;
-      }
-
-      unsigned char old_cost = master_array[it];
-      if (old_cost == NO_INFORMATION)
-        master_array[it] = costmap_[it];
-      else 
-      {
-        int sum = old_cost + costmap_[it];
-        if (sum >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
-            master_array[it] = costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1;
-        else
-            master_array[it] = sum;
-      }
-      it++;
-    }
+    combineAddition(master_array + it, costmap_ + it, max_i - min_i);
   }
-
-
 }
 }
@@ -0,0 +1,197 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/layer_combine.h>
+#include <costmap_2d/cost_values.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace costmap_2d
+{
+
+void combineMaxScalar(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    if (layer[i] == NO_INFORMATION)
+      continue;
+
+    unsigned char old_cost = master[i];
+    if (old_cost == NO_INFORMATION || old_cost < layer[i])
+      master[i] = layer[i];
+  }
+}
+
+void combineOverwriteScalar(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    if (layer[i] != NO_INFORMATION)
+      master[i] = layer[i];
+  }
+}
+
+void combineAdditionScalar(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    if (layer[i] == NO_INFORMATION)
+      continue;
+
+    unsigned char old_cost = master[i];
+    if (old_cost == NO_INFORMATION)
+      master[i] = layer[i];
+    else
+    {
+      int sum = old_cost + layer[i];
+      if (sum >= INSCRIBED_INFLATED_OBSTACLE)
+        master[i] = INSCRIBED_INFLATED_OBSTACLE - 1;
+      else
+        master[i] = sum;
+    }
+  }
+}
+
+// The vector kernels work on unsigned bytes with compare-to-NO_INFORMATION masks:
+//   max:      L unknown ? M : max(M unknown ? 0 : M, L)
+//   addition: L unknown ? M : (M unknown ? L : min(adds(M, L), INSCRIBED_INFLATED_OBSTACLE - 1))
+// adds() saturates at 255, which the min() folds onto the same cap as the scalar code.
+#if defined(__AVX2__)
+
+typedef __m256i Block;
+static const size_t BLOCK = 32;
+
+static inline Block load(const unsigned char* p) { return _mm256_loadu_si256(reinterpret_cast<const Block*>(p)); }
+static inline void store(unsigned char* p, Block v) { _mm256_storeu_si256(reinterpret_cast<Block*>(p), v); }
+static inline Block splat(unsigned char c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+static inline Block isEqual(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+static inline Block maxU8(Block a, Block b) { return _mm256_max_epu8(a, b); }
+static inline Block minU8(Block a, Block b) { return _mm256_min_epu8(a, b); }
+static inline Block addsU8(Block a, Block b) { return _mm256_adds_epu8(a, b); }
+static inline Block andNot(Block mask, Block v) { return _mm256_andnot_si256(mask, v); }
+static inline Block select(Block mask, Block a, Block b) { return _mm256_blendv_epi8(b, a, mask); }
+
+#define COSTMAP_2D_COMBINE_VECTORIZED
+
+#elif defined(__SSE2__)
+
+typedef __m128i Block;
+static const size_t BLOCK = 16;
+
+static inline Block load(const unsigned char* p) { return _mm_loadu_si128(reinterpret_cast<const Block*>(p)); }
+static inline void store(unsigned char* p, Block v) { _mm_storeu_si128(reinterpret_cast<Block*>(p), v); }
+static inline Block splat(unsigned char c) { return _mm_set1_epi8(static_cast<char>(c)); }
+static inline Block isEqual(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+static inline Block maxU8(Block a, Block b) { return _mm_max_epu8(a, b); }
+static inline Block minU8(Block a, Block b) { return _mm_min_epu8(a, b); }
+static inline Block addsU8(Block a, Block b) { return _mm_adds_epu8(a, b); }
+static inline Block andNot(Block mask, Block v) { return _mm_andnot_si128(mask, v); }
+static inline Block select(Block mask, Block a, Block b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+#define COSTMAP_2D_COMBINE_VECTORIZED
+
+#endif
+
+#ifdef COSTMAP_2D_COMBINE_VECTORIZED
+
+void combineMax(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  const Block unknown = splat(NO_INFORMATION);
+  size_t i = 0;
+  for (; i + BLOCK <= n; i += BLOCK)
+  {
+    Block m = load(master + i);
+    Block l = load(layer + i);
+    Block known_max = maxU8(andNot(isEqual(m, unknown), m), l);
+    store(master + i, select(isEqual(l, unknown), m, known_max));
+  }
+  combineMaxScalar(master + i, layer + i, n - i);
+}
+
+void combineOverwrite(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  const Block unknown = splat(NO_INFORMATION);
+  size_t i = 0;
+  for (; i + BLOCK <= n; i += BLOCK)
+  {
+    Block m = load(master + i);
+    Block l = load(layer + i);
+    store(master + i, select(isEqual(l, unknown), m, l));
+  }
+  combineOverwriteScalar(master + i, layer + i, n - i);
+}
+
+void combineAddition(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  const Block unknown = splat(NO_INFORMATION);
+  const Block cap = splat(INSCRIBED_INFLATED_OBSTACLE - 1);
+  size_t i = 0;
+  for (; i + BLOCK <= n; i += BLOCK)
+  {
+    Block m = load(master + i);
+    Block l = load(layer + i);
+    Block sum = minU8(addsU8(m, l), cap);
+    Block known = select(isEqual(m, unknown), l, sum);
+    store(master + i, select(isEqual(l, unknown), m, known));
+  }
+  combineAdditionScalar(master + i, layer + i, n - i);
+}
+
+#else
+
+void combineMax(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  combineMaxScalar(master, layer, n);
+}
+
+void combineOverwrite(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  combineOverwriteScalar(master, layer, n);
+}
+
+void combineAddition(unsigned char* master, const unsigned char* layer, size_t n)
+{
+  combineAdditionScalar(master, layer, n);
+}
+
+#endif
+
+}  // namespace costmap_2d
@@ -37,7 +37,10 @@
  *********************************************************************/
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/footprint.h>
+#include <costmap_2d/costmap_layer.h>
+#include <costmap_2d/layer_combine.h>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <algorithm>
 #include <vector>
@@ -47,7 +50,8 @@ using namespace std;
 namespace costmap_2d
 {
 LayeredCostmap::LayeredCostmap(string global_frame, bool rolling_window, bool track_unknown) :
-    costmap_(), global_frame_(global_frame), rolling_window_(rolling_window), initialized_(false), size_locked_(false)
+    costmap_(), global_frame_(global_frame), rolling_window_(rolling_window), initialized_(false), size_locked_(false),
+    fused_composition_(false)
 {
   if (track_unknown)
     costmap_.setDefaultValue(255);
@@ -112,15 +116,23 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   if (xn < x0 || yn < y0)
     return;
 
-  costmap_.resetMap(x0, y0, xn, yn);
-
+  if (fused_composition_)
   {
+    boost::unique_lock < boost::shared_mutex > lock(*(costmap_.getLock()));
+    composeFused(x0, y0, xn, yn);
+    costmap_.incrementRevision();
+  }
+  else
+  {
+    costmap_.resetMap(x0, y0, xn, yn);
+
     boost::unique_lock < boost::shared_mutex > lock(*(costmap_.getLock()));
     for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
         ++plugin)
     {
       (*plugin)->updateCosts(costmap_, x0, y0, xn, yn);
     }
+    costmap_.incrementRevision();
   }
 
   bx0_ = x0;
@@ -132,6 +144,97 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
 
 }
 
+void LayeredCostmap::composeFused(int x0, int y0, int xn, int yn)
+{
+  // consecutive per-cell layers are collected into a run and composed together; the window
+  // reset is folded into the first run unless a custom layer has to see the reset map first
+  bool reset_pending = true;
+  fused_run_.clear();
+  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
+      ++plugin)
+  {
+    CostmapLayer* layer = dynamic_cast<CostmapLayer*>(plugin->get());
+    CostmapLayer::CombineRule rule = layer ? layer->prepareCombine(x0, y0, xn, yn) : CostmapLayer::COMBINE_CUSTOM;
+    if (rule == CostmapLayer::COMBINE_NOTHING)
+      continue;
+
+    if (rule != CostmapLayer::COMBINE_CUSTOM)
+    {
+      FusedLayer fused = { layer->getCharMap(), rule };
+      fused_run_.push_back(fused);
+      continue;
+    }
+
+    composeRun(x0, y0, xn, yn, reset_pending);
+    reset_pending = false;
+    fused_run_.clear();
+    (*plugin)->updateCosts(costmap_, x0, y0, xn, yn);
+  }
+  composeRun(x0, y0, xn, yn, reset_pending);
+  fused_run_.clear();
+}
+
+void LayeredCostmap::composeRun(int x0, int y0, int xn, int yn, bool reset)
+{
+  if (fused_run_.empty() && !reset)
+    return;
+
+  // work through each row in blocks small enough that the master cells stay in cache
+  // while every layer of the run is combined into them
+  const int block = 4096;
+  unsigned char* master = costmap_.getCharMap();
+  unsigned int span = costmap_.getSizeInCellsX();
+  unsigned char default_value = costmap_.getDefaultValue();
+
+  for (int j = y0; j < yn; j++)
+  {
+    for (int i = x0; i < xn; i += block)
+    {
+      size_t n = std::min(block, xn - i);
+      size_t it = static_cast<size_t>(j) * span + i;
+      if (reset)
+        memset(master + it, default_value, n);
+
+      for (vector<FusedLayer>::const_iterator layer = fused_run_.begin(); layer != fused_run_.end(); ++layer)
+      {
+        switch (layer->rule)
+        {
+          case CostmapLayer::COMBINE_TRUE_OVERWRITE:
+            memcpy(master + it, layer->costs + it, n);
+            break;
+          case CostmapLayer::COMBINE_OVERWRITE:
+            combineOverwrite(master + it, layer->costs + it, n);
+            break;
+          case CostmapLayer::COMBINE_MAX:
+            combineMax(master + it, layer->costs + it, n);
+            break;
+          case CostmapLayer::COMBINE_ADDITION:
+            combineAddition(master + it, layer->costs + it, n);
+            break;
+        }
+      }
+    }
+  }
+}
+
+bool LayeredCostmap::dumpLayers(const std::string& prefix, bool compress)
+{
+  bool ok = costmap_.saveBinary(prefix + "master.bin", compress);
+  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
+      ++plugin)
+  {
+    // only layers that are themselves a Costmap2D keep a grid worth dumping
+    Costmap2D* grid = dynamic_cast<Costmap2D*>(plugin->get());
+    if (!grid)
+      continue;
+
+    std::string name = (*plugin)->getName();
+    std::replace(name.begin(), name.end(), '/', '_');
+    ok = grid->saveBinary(prefix + name + ".bin", compress) && ok;
+  }
+  return ok;
+}
+
 bool LayeredCostmap::isCurrent()
 {
   current_ = true;
@@ -37,6 +37,7 @@
 #include <costmap_2d/observation_buffer.h>
 
 #include <pcl/point_types.h>
+#include <cmath>
 #include <pcl_ros/transforms.h>
 #include <pcl/conversions.h>
 #include <pcl/PCLPointCloud2.h>
@@ -55,8 +56,19 @@ ObservationBuffer::ObservationBuffer(string topic_name, double observation_keep_
     tf_(tf), observation_keep_time_(observation_keep_time), expected_update_rate_(expected_update_rate), last_updated_(
         ros::Time::now()), global_frame_(global_frame), sensor_frame_(sensor_frame), topic_name_(topic_name), min_obstacle_height_(
         min_obstacle_height), max_obstacle_height_(max_obstacle_height), obstacle_range_(obstacle_range), raytrace_range_(
-        raytrace_range), tf_tolerance_(tf_tolerance)
+        raytrace_range), tf_tolerance_(tf_tolerance), downsample_resolution_(0.0), downsample_z_resolution_(0.0), downsample_origin_x_(0.0), downsample_origin_y_(
+        0.0), observation_head_(0), observation_count_(0)
 {
+  //size the ring for the number of observations we expect to keep, it grows if that was too few
+  unsigned int slots = 2;
+  if (observation_keep_time > 0.0)
+  {
+    if (expected_update_rate > 0.0)
+      slots = (unsigned int)ceil(observation_keep_time / expected_update_rate) + 2;
+    else
+      slots = 8;
+  }
+  observations_.resize(slots);
 }
 
 ObservationBuffer::~ObservationBuffer()
@@ -76,12 +88,11 @@ bool ObservationBuffer::setGlobalFrame(const std::string new_global_frame)
     return false;
   }
 
-  list<Observation>::iterator obs_it;
-  for (obs_it = observation_list_.begin(); obs_it != observation_list_.end(); ++obs_it)
+  for (unsigned int i = 0; i < observation_count_; ++i)
   {
     try
     {
-      Observation& obs = *obs_it;
+      Observation& obs = observationAt(i);
 
       geometry_msgs::PointStamped origin;
       origin.header.frame_id = global_frame_;
@@ -93,6 +104,8 @@ bool ObservationBuffer::setGlobalFrame(const std::string new_global_frame)
       obs.origin_ = origin.point;
 
       //we also need to transform the cloud of the observation to the new global frame
+      if (!obs.cloud_.unique())
+        obs.cloud_.reset(new pcl::PointCloud<pcl::PointXYZ>(*obs.cloud_));
       pcl_ros::transformPointCloud(new_global_frame, *obs.cloud_, *obs.cloud_, tf_);
 
     }
@@ -116,9 +129,8 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::PointCloud2& cloud)
     pcl::PCLPointCloud2 pcl_pc2;
     pcl_conversions::toPCL(cloud, pcl_pc2);
     // Actually convert the PointCloud2 message into a type we can reason about
-    pcl::PointCloud < pcl::PointXYZ > pcl_cloud;
-    pcl::fromPCLPointCloud2(pcl_pc2, pcl_cloud);
-    bufferCloud (pcl_cloud);
+    pcl::fromPCLPointCloud2(pcl_pc2, input_cloud_);
+    bufferCloud (input_cloud_);
   }
   catch (pcl::PCLException& ex)
   {
@@ -131,8 +143,15 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
 {
   Stamped < tf::Vector3 > global_origin;
 
-  //create a new observation on the list to be populated
-  observation_list_.push_front(Observation());
+  //the new observation goes into the slot in front of the newest one, it only counts once it is populated
+  if (observation_count_ == observations_.size())
+    growObservations();
+  unsigned int slot = (observation_head_ + observations_.size() - 1) % observations_.size();
+  Observation& observation = observations_[slot];
+
+  //reuse the cloud of the slot unless someone still holds on to it
+  if (!observation.cloud_.unique())
+    observation.cloud_.reset(new pcl::PointCloud<pcl::PointXYZ>());
 
   //check whether the origin frame has been set explicitly or whether we should get it from the cloud
   string origin_frame = sensor_frame_ == "" ? cloud.header.frame_id : sensor_frame_;
@@ -142,50 +161,52 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
     //given these observations come from sensors... we'll need to store the origin pt of the sensor
     Stamped < tf::Vector3 > local_origin(tf::Vector3(0, 0, 0), pcl_conversions::fromPCL(cloud.header).stamp, origin_frame);
     tf_.transformPoint(global_frame_, local_origin, global_origin);
-    observation_list_.front().origin_.x = global_origin.getX();
-    observation_list_.front().origin_.y = global_origin.getY();
-    observation_list_.front().origin_.z = global_origin.getZ();
+    observation.origin_.x = global_origin.getX();
+    observation.origin_.y = global_origin.getY();
+    observation.origin_.z = global_origin.getZ();
 
     //make sure to pass on the raytrace/obstacle range of the observation buffer to the observations the costmap will see
-    observation_list_.front().raytrace_range_ = raytrace_range_;
-    observation_list_.front().obstacle_range_ = obstacle_range_;
-
-    pcl::PointCloud < pcl::PointXYZ > global_frame_cloud;
+    observation.raytrace_range_ = raytrace_range_;
+    observation.obstacle_range_ = obstacle_range_;
 
     //transform the point cloud
-    pcl_ros::transformPointCloud(global_frame_, cloud, global_frame_cloud, tf_);
-    global_frame_cloud.header.stamp = cloud.header.stamp;
+    pcl_ros::transformPointCloud(global_frame_, cloud, global_frame_cloud_, tf_);
+    global_frame_cloud_.header.stamp = cloud.header.stamp;
 
     //now we need to remove observations from the cloud that are below or above our height thresholds
-    pcl::PointCloud < pcl::PointXYZ > &observation_cloud = *(observation_list_.front().cloud_);
-    unsigned int cloud_size = global_frame_cloud.points.size();
+    pcl::PointCloud < pcl::PointXYZ > &observation_cloud = *(observation.cloud_);
+    unsigned int cloud_size = global_frame_cloud_.points.size();
     observation_cloud.points.resize(cloud_size);
     unsigned int point_count = 0;
 
     //copy over the points that are within our height bounds
     for (unsigned int i = 0; i < cloud_size; ++i)
     {
-      if (global_frame_cloud.points[i].z <= max_obstacle_height_
-          && global_frame_cloud.points[i].z >= min_obstacle_height_)
+      if (global_frame_cloud_.points[i].z <= max_obstacle_height_
+          && global_frame_cloud_.points[i].z >= min_obstacle_height_)
       {
-        observation_cloud.points[point_count++] = global_frame_cloud.points[i];
+        observation_cloud.points[point_count++] = global_frame_cloud_.points[i];
       }
     }
 
     //resize the cloud for the number of legal points
     observation_cloud.points.resize(point_count);
+    if (downsample_resolution_ > 0.0)
+      downsampleCloud(observation_cloud, observation.origin_);
     observation_cloud.header.stamp = cloud.header.stamp;
-    observation_cloud.header.frame_id = global_frame_cloud.header.frame_id;
+    observation_cloud.header.frame_id = global_frame_cloud_.header.frame_id;
   }
   catch (TransformException& ex)
   {
-    //if an exception occurs, we need to remove the empty observation from the list
-    observation_list_.pop_front();
+    //if an exception occurs, the slot is simply not taken
     ROS_ERROR("TF Exception that should never happen for sensor frame: %s, cloud frame: %s, %s", sensor_frame_.c_str(),
               cloud.header.frame_id.c_str(), ex.what());
     return;
   }
 
+  observation_head_ = slot;
+  ++observation_count_;
+
   //if the update was successful, we want to update the last updated time
   last_updated_ = ros::Time::now();
 
@@ -194,48 +215,124 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
 
 }
 
-//returns a copy of the observations
+void ObservationBuffer::setDownsampling(double resolution, double z_resolution, double origin_x, double origin_y)
+{
+  downsample_resolution_ = resolution;
+  downsample_z_resolution_ = z_resolution;
+  downsample_origin_x_ = origin_x;
+  downsample_origin_y_ = origin_y;
+}
+
+void ObservationBuffer::downsampleCloud(pcl::PointCloud<pcl::PointXYZ>& cloud, const geometry_msgs::Point& origin)
+{
+  const uint64_t empty = ~(uint64_t)0;
+  const uint64_t mask21 = (1 << 21) - 1;
+  unsigned int cloud_size = cloud.points.size();
+
+  //keep the table at most half full
+  unsigned int table_size = 64;
+  while (table_size < 2 * cloud_size)
+    table_size *= 2;
+  downsample_keys_.assign(table_size, empty);
+  downsample_points_.resize(table_size);
+
+  double inv_resolution = 1.0 / downsample_resolution_;
+  double inv_z_resolution = downsample_z_resolution_ > 0.0 ? 1.0 / downsample_z_resolution_ : 0.0;
+  const double max_cell = 1e18;
+  unsigned int point_count = 0;
+
+  for (unsigned int i = 0; i < cloud_size; ++i)
+  {
+    const pcl::PointXYZ& point = cloud.points[i];
+    double fx = floor((point.x - downsample_origin_x_) * inv_resolution);
+    double fy = floor((point.y - downsample_origin_y_) * inv_resolution);
+    double fz = floor((point.z - min_obstacle_height_) * inv_z_resolution);
+
+    //drop NaN and infinite points, and any too far out to have a cell index, before casting
+    if (!(fabs(fx) < max_cell && fabs(fy) < max_cell && fabs(fz) < max_cell))
+      continue;
+
+    int64_t cx = (int64_t)fx;
+    int64_t cy = (int64_t)fy;
+    int64_t cz = (int64_t)fz;
+
+    //21 bits per axis never sets the top bit, so a key can not collide with the empty marker
+    uint64_t key = (((uint64_t)cx & mask21) << 42) | (((uint64_t)cy & mask21) << 21) | ((uint64_t)cz & mask21);
+    unsigned int slot = (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (table_size - 1);
+    while (downsample_keys_[slot] != empty && downsample_keys_[slot] != key)
+      slot = (slot + 1) & (table_size - 1);
+
+    if (downsample_keys_[slot] == empty)
+    {
+      //first point in this cell, compact it to the front of the cloud
+      downsample_keys_[slot] = key;
+      downsample_points_[slot] = point_count;
+      cloud.points[point_count++] = point;
+      continue;
+    }
+
+    //keep whichever point is farther from the sensor
+    pcl::PointXYZ& kept = cloud.points[downsample_points_[slot]];
+    double kept_dist = (kept.x - origin.x) * (kept.x - origin.x) + (kept.y - origin.y) * (kept.y - origin.y)
+        + (kept.z - origin.z) * (kept.z - origin.z);
+    double dist = (point.x - origin.x) * (point.x - origin.x) + (point.y - origin.y) * (point.y - origin.y)
+        + (point.z - origin.z) * (point.z - origin.z);
+    if (dist > kept_dist)
+      kept = point;
+  }
+
+  cloud.points.resize(point_count);
+}
+
+//returns the observations, sharing their clouds with the buffer
 void ObservationBuffer::getObservations(vector<Observation>& observations)
 {
   //first... let's make sure that we don't have any stale observations
   purgeStaleObservations();
 
-  //now we'll just copy the observations for the caller
-  list<Observation>::iterator obs_it;
-  for (obs_it = observation_list_.begin(); obs_it != observation_list_.end(); ++obs_it)
+  //now we'll just hand out the observations to the caller
+  observations.reserve(observations.size() + observation_count_);
+  for (unsigned int i = 0; i < observation_count_; ++i)
   {
-    observations.push_back(*obs_it);
+    observations.push_back(observationAt(i));
   }
 
 }
 
 void ObservationBuffer::purgeStaleObservations()
 {
-  if (!observation_list_.empty())
+  if (observation_count_ > 0)
   {
-    list<Observation>::iterator obs_it = observation_list_.begin();
     //if we're keeping observations for no time... then we'll only keep one observation
     if (observation_keep_time_ == ros::Duration(0.0))
     {
-      observation_list_.erase(++obs_it, observation_list_.end());
+      observation_count_ = 1;
       return;
     }
 
     //otherwise... we'll have to loop through the observations to see which ones are stale
-    for (obs_it = observation_list_.begin(); obs_it != observation_list_.end(); ++obs_it)
+    for (unsigned int i = 0; i < observation_count_; ++i)
     {
-      Observation& obs = *obs_it;
+      Observation& obs = observationAt(i);
       //check if the observation is out of date... and if it is, remove it and those that follow from the list
-      ros::Duration time_diff = last_updated_ - pcl_conversions::fromPCL(obs.cloud_->header).stamp;
       if ((last_updated_ - pcl_conversions::fromPCL(obs.cloud_->header).stamp) > observation_keep_time_)
       {
-        observation_list_.erase(obs_it, observation_list_.end());
+        observation_count_ = i;
         return;
       }
     }
   }
 }
 
+void ObservationBuffer::growObservations()
+{
+  vector<Observation> grown(observations_.size() * 2);
+  for (unsigned int i = 0; i < observation_count_; ++i)
+    grown[i] = observationAt(i);
+  observations_.swap(grown);
+  observation_head_ = 0;
+}
+
 bool ObservationBuffer::isCurrent() const
 {
   if (expected_update_rate_ == ros::Duration(0.0))
@@ -0,0 +1,122 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/robot_pose_cache.h>
+#include <cstring>
+
+namespace costmap_2d
+{
+
+namespace
+{
+boost::uint64_t toBits(double value)
+{
+  boost::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double fromBits(boost::uint64_t bits)
+{
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}  // namespace
+
+RobotPoseCache::RobotPoseCache() :
+    generation_(1), sequence_(0), stored_generation_(0), stamp_(0)
+{
+  for (unsigned int i = 0; i < NUM_FIELDS; ++i)
+    fields_[i].store(0);
+}
+
+void RobotPoseCache::invalidate()
+{
+  generation_.fetch_add(1, boost::memory_order_release);
+}
+
+boost::uint32_t RobotPoseCache::getGeneration() const
+{
+  return generation_.load(boost::memory_order_acquire);
+}
+
+void RobotPoseCache::store(boost::uint32_t generation, const tf::Stamped<tf::Pose>& pose)
+{
+  boost::uint32_t sequence = sequence_.load(boost::memory_order_relaxed);
+  if ((sequence & 1) || !sequence_.compare_exchange_strong(sequence, sequence + 1, boost::memory_order_acquire))
+    return;
+
+  const tf::Vector3& origin = pose.getOrigin();
+  tf::Quaternion rotation = pose.getRotation();
+  fields_[X].store(toBits(origin.x()), boost::memory_order_relaxed);
+  fields_[Y].store(toBits(origin.y()), boost::memory_order_relaxed);
+  fields_[Z].store(toBits(origin.z()), boost::memory_order_relaxed);
+  fields_[QX].store(toBits(rotation.x()), boost::memory_order_relaxed);
+  fields_[QY].store(toBits(rotation.y()), boost::memory_order_relaxed);
+  fields_[QZ].store(toBits(rotation.z()), boost::memory_order_relaxed);
+  fields_[QW].store(toBits(rotation.w()), boost::memory_order_relaxed);
+  stamp_.store(pose.stamp_.toNSec(), boost::memory_order_relaxed);
+  stored_generation_.store(generation, boost::memory_order_relaxed);
+
+  sequence_.store(sequence + 2, boost::memory_order_release);
+}
+
+bool RobotPoseCache::load(tf::Stamped<tf::Pose>& pose) const
+{
+  double values[NUM_FIELDS];
+  boost::uint64_t stamp;
+  boost::uint32_t generation, before, after;
+  do
+  {
+    before = sequence_.load(boost::memory_order_acquire);
+    for (unsigned int i = 0; i < NUM_FIELDS; ++i)
+      values[i] = fromBits(fields_[i].load(boost::memory_order_relaxed));
+    stamp = stamp_.load(boost::memory_order_relaxed);
+    generation = stored_generation_.load(boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+    after = sequence_.load(boost::memory_order_relaxed);
+  }
+  while ((before & 1) || before != after);
+
+  if (generation != getGeneration())
+    return false;
+
+  pose.setOrigin(tf::Vector3(values[X], values[Y], values[Z]));
+  pose.setRotation(tf::Quaternion(values[QX], values[QY], values[QZ], values[QW]));
+  pose.stamp_.fromNSec(stamp);
+  return true;
+}
+
+}  // namespace costmap_2d
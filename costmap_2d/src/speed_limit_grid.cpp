@@ -0,0 +1,143 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/speed_limit_grid.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace costmap_2d
+{
+
+const float SpeedLimitGrid::NO_SPEED_LIMIT = FLT_MAX;
+
+SpeedLimitGrid::SpeedLimitGrid() :
+    speed_size_x_(0), speed_size_y_(0)
+{
+}
+
+SpeedLimitGrid::~SpeedLimitGrid()
+{
+}
+
+void SpeedLimitGrid::resizeSpeedGrid(unsigned int size_x, unsigned int size_y)
+{
+  speed_size_x_ = size_x;
+  speed_size_y_ = size_y;
+  speed_limits_.assign(size_x * size_y, NO_SPEED_LIMIT);
+  publishSpeedLimits();
+}
+
+void SpeedLimitGrid::clearSpeedLimits()
+{
+  std::fill(speed_limits_.begin(), speed_limits_.end(), NO_SPEED_LIMIT);
+  publishSpeedLimits();
+}
+
+void SpeedLimitGrid::sampleSpeedLimits(double resolution, double origin_x, double origin_y,
+                                       const std::vector<float>& src, unsigned int src_size_x,
+                                       unsigned int src_size_y, double src_resolution, double src_origin_x,
+                                       double src_origin_y)
+{
+  // readers keep the previous snapshot until the new limits are complete
+  std::fill(speed_limits_.begin(), speed_limits_.end(), NO_SPEED_LIMIT);
+  if (src.size() < src_size_x * src_size_y || src_resolution <= 0.0)
+  {
+    publishSpeedLimits();
+    return;
+  }
+
+  // the source column of every grid column is the same on each row, so work it out once
+  std::vector<int> src_columns(speed_size_x_);
+  for (unsigned int i = 0; i < speed_size_x_; ++i)
+  {
+    double wx = origin_x + (i + 0.5) * resolution;
+    double sx = floor((wx - src_origin_x) / src_resolution);
+    src_columns[i] = (sx < 0 || sx >= src_size_x) ? -1 : int(sx);
+  }
+
+  for (unsigned int j = 0; j < speed_size_y_; ++j)
+  {
+    double wy = origin_y + (j + 0.5) * resolution;
+    double sy = floor((wy - src_origin_y) / src_resolution);
+    if (sy < 0 || sy >= src_size_y)
+      continue;
+
+    const float* src_row = &src[(unsigned int)sy * src_size_x];
+    float* row = &speed_limits_[j * speed_size_x_];
+    for (unsigned int i = 0; i < speed_size_x_; ++i)
+    {
+      if (src_columns[i] >= 0)
+        row[i] = src_row[src_columns[i]];
+    }
+  }
+  publishSpeedLimits();
+}
+
+float SpeedLimitGrid::getMinSpeedLimit(int min_i, int min_j, int max_i, int max_j) const
+{
+  min_i = std::max(min_i, 0);
+  min_j = std::max(min_j, 0);
+  max_i = std::min(max_i, int(speed_size_x_) - 1);
+  max_j = std::min(max_j, int(speed_size_y_) - 1);
+
+  float limit = NO_SPEED_LIMIT;
+  for (int j = min_j; j <= max_j; ++j)
+  {
+    const float* row = &speed_limits_[j * speed_size_x_];
+    for (int i = min_i; i <= max_i; ++i)
+      limit = std::min(limit, row[i]);
+  }
+  return limit;
+}
+
+SpeedLimitSnapshot SpeedLimitGrid::getSpeedLimitSnapshot() const
+{
+  boost::mutex::scoped_lock lock(snapshot_mutex_);
+  return snapshot_;
+}
+
+void SpeedLimitGrid::publishSpeedLimits()
+{
+  // copy outside the lock, readers only wait for the pointer swap
+  SpeedLimitSnapshot snapshot;
+  snapshot.limits_.reset(new std::vector<float>(speed_limits_));
+  snapshot.size_x_ = speed_size_x_;
+  snapshot.size_y_ = speed_size_y_;
+
+  boost::mutex::scoped_lock lock(snapshot_mutex_);
+  snapshot_ = snapshot;
+}
+
+}  // namespace costmap_2d
@@ -0,0 +1,113 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/worker_pool.h>
+#include <boost/bind.hpp>
+
+namespace costmap_2d
+{
+
+WorkerPool::WorkerPool(unsigned int threads) :
+    parts_(0), next_part_(0), generation_(0), busy_(0), shutdown_(false)
+{
+  for (unsigned int i = 1; i < threads; ++i)
+    workers_.create_thread(boost::bind(&WorkerPool::workerLoop, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_ready_.notify_all();
+  workers_.join_all();
+}
+
+void WorkerPool::run(unsigned int parts, const Job& job)
+{
+  // nothing to share, skip the handshake with the workers
+  if (workers_.size() == 0 || parts <= 1)
+  {
+    for (unsigned int i = 0; i < parts; ++i)
+      job(i);
+    return;
+  }
+
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  job_ = job;
+  parts_ = parts;
+  next_part_ = 0;
+  busy_ = workers_.size();
+  ++generation_;
+  work_ready_.notify_all();
+
+  runParts(lock);
+  while (busy_ > 0)
+    work_done_.wait(lock);
+  job_ = Job();
+}
+
+void WorkerPool::workerLoop()
+{
+  // jobs are only counted once all workers exist, so a worker that starts late still
+  // picks up the first one
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  unsigned int seen = 0;
+  while (true)
+  {
+    while (generation_ == seen && !shutdown_)
+      work_ready_.wait(lock);
+    if (shutdown_)
+      return;
+    seen = generation_;
+
+    runParts(lock);
+    if (--busy_ == 0)
+      work_done_.notify_one();
+  }
+}
+
+void WorkerPool::runParts(boost::unique_lock<boost::mutex>& lock)
+{
+  while (next_part_ < parts_)
+  {
+    unsigned int part = next_part_++;
+    lock.unlock();
+    job_(part);
+    lock.lock();
+  }
+}
+
+}  // namespace costmap_2d
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+#include "costmap_2d/costmap_2d.h"
+
+using namespace costmap_2d;
+
+namespace
+{
+void fillPattern(Costmap2D& map)
+{
+  for (unsigned int j = 0; j < map.getSizeInCellsY(); ++j)
+    for (unsigned int i = 0; i < map.getSizeInCellsX(); ++i)
+      map.setCost(i, j, (i / 7 + j / 3) % 5 == 0 ? 254 : (i * j) % 3);
+}
+
+void expectSameMap(Costmap2D& a, Costmap2D& b)
+{
+  ASSERT_EQ(a.getSizeInCellsX(), b.getSizeInCellsX());
+  ASSERT_EQ(a.getSizeInCellsY(), b.getSizeInCellsY());
+  EXPECT_DOUBLE_EQ(a.getResolution(), b.getResolution());
+  EXPECT_DOUBLE_EQ(a.getOriginX(), b.getOriginX());
+  EXPECT_DOUBLE_EQ(a.getOriginY(), b.getOriginY());
+  for (unsigned int j = 0; j < a.getSizeInCellsY(); ++j)
+    for (unsigned int i = 0; i < a.getSizeInCellsX(); ++i)
+      ASSERT_EQ(a.getCost(i, j), b.getCost(i, j)) << i << ", " << j;
+}
+
+std::string tempName()
+{
+  char name[] = "/tmp/costmap_binary_XXXXXX";
+  int fd = mkstemp(name);
+  if (fd >= 0)
+    close(fd);
+  return name;
+}
+}  // namespace
+
+TEST(binary_map, raw_round_trip)
+{
+  Costmap2D map(123, 45, 0.05, -3.5, 12.25, 0);
+  fillPattern(map);
+
+  std::string file = tempName();
+  ASSERT_TRUE(map.saveBinary(file));
+
+  Costmap2D loaded;
+  ASSERT_TRUE(loaded.loadBinary(file));
+  expectSameMap(map, loaded);
+  remove(file.c_str());
+}
+
+TEST(binary_map, compressed_round_trip)
+{
+  Costmap2D map(600, 400, 0.1, 1.0, -2.0, 0);
+  for (unsigned int i = 100; i < 500; ++i)
+    map.setCost(i, 200, 254);
+  map.setCost(599, 399, 7);
+
+  std::string file = tempName();
+  ASSERT_TRUE(map.saveBinary(file, true));
+
+  Costmap2D loaded(10, 10, 1.0, 0.0, 0.0, 0);
+  ASSERT_TRUE(loaded.loadBinary(file));
+  expectSameMap(map, loaded);
+  remove(file.c_str());
+}
+
+TEST(binary_map, rejects_bad_files)
+{
+  std::string file = tempName();
+  FILE* fp = fopen(file.c_str(), "wb");
+  fputs("P2\n3\n3\n255\n", fp);
+  fclose(fp);
+
+  Costmap2D map(5, 5, 1.0, 0.0, 0.0, 0);
+  EXPECT_FALSE(map.loadBinary(file));
+  EXPECT_FALSE(map.loadBinary(file + ".missing"));
+  EXPECT_EQ(5u, map.getSizeInCellsX());
+  remove(file.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include <boost/shared_ptr.hpp>
+
+#include "costmap_2d/costmap_layer.h"
+#include "costmap_2d/layered_costmap.h"
+
+using namespace costmap_2d;
+
+namespace
+{
+// a layer holding random costs that combines with a fixed rule, either way
+class RandomLayer : public CostmapLayer
+{
+public:
+  RandomLayer(CombineRule rule, unsigned int seed) : rule_(rule), seed_(seed) {}
+
+  virtual void onInitialize()
+  {
+    enabled_ = true;
+    matchSize();
+    srand(seed_);
+    for (unsigned int i = 0; i < getSizeInCellsX() * getSizeInCellsY(); ++i)
+      costmap_[i] = rand() % 3 == 0 ? NO_INFORMATION : rand() % 256;
+  }
+
+  virtual void updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x, double* min_y,
+                            double* max_x, double* max_y)
+  {
+    *min_x = std::min(*min_x, getOriginX());
+    *min_y = std::min(*min_y, getOriginY());
+    *max_x = std::max(*max_x, getOriginX() + getSizeInMetersX());
+    *max_y = std::max(*max_y, getOriginY() + getSizeInMetersY());
+  }
+
+  virtual void updateCosts(Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+  {
+    switch (rule_)
+    {
+      case COMBINE_TRUE_OVERWRITE:
+        updateWithTrueOverwrite(master_grid, min_i, min_j, max_i, max_j);
+        break;
+      case COMBINE_OVERWRITE:
+        updateWithOverwrite(master_grid, min_i, min_j, max_i, max_j);
+        break;
+      case COMBINE_MAX:
+        updateWithMax(master_grid, min_i, min_j, max_i, max_j);
+        break;
+      case COMBINE_ADDITION:
+        updateWithAddition(master_grid, min_i, min_j, max_i, max_j);
+        break;
+      default:
+        break;
+    }
+  }
+
+  virtual CombineRule prepareCombine(int min_i, int min_j, int max_i, int max_j)
+  {
+    return rule_;
+  }
+
+private:
+  CombineRule rule_;
+  unsigned int seed_;
+};
+
+// depends on neighbouring master cells, so it cannot be fused
+class SmearLayer : public Layer
+{
+public:
+  virtual void updateCosts(Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+  {
+    for (int j = min_j; j < max_j; ++j)
+      for (int i = min_i + 1; i < max_i; ++i)
+        if (master_grid.getCost(i - 1, j) == LETHAL_OBSTACLE)
+          master_grid.setCost(i, j, INSCRIBED_INFLATED_OBSTACLE);
+  }
+};
+
+void addLayers(LayeredCostmap& layers, bool smear_first)
+{
+  boost::shared_ptr<Layer> smear(new SmearLayer());
+  if (smear_first)
+    layers.addPlugin(smear);
+
+  CostmapLayer::CombineRule rules[] = { CostmapLayer::COMBINE_MAX, CostmapLayer::COMBINE_TRUE_OVERWRITE,
+                                        CostmapLayer::COMBINE_OVERWRITE, CostmapLayer::COMBINE_MAX,
+                                        CostmapLayer::COMBINE_ADDITION };
+  for (unsigned int i = 0; i < 5; ++i)
+  {
+    boost::shared_ptr<Layer> layer(new RandomLayer(rules[i], i + 1));
+    layers.addPlugin(layer);
+    layer->initialize(&layers, "random", NULL);
+    if (i == 2)
+      layers.addPlugin(smear);
+  }
+}
+
+void expectSameComposition(bool track_unknown, bool smear_first)
+{
+  LayeredCostmap separate("map", false, track_unknown);
+  LayeredCostmap fused("map", false, track_unknown);
+  separate.resizeMap(5000, 70, 0.05, -1.0, 2.0);
+  fused.resizeMap(5000, 70, 0.05, -1.0, 2.0);
+  fused.setFusedComposition(true);
+  addLayers(separate, smear_first);
+  addLayers(fused, smear_first);
+
+  separate.updateMap(0, 0, 0);
+  fused.updateMap(0, 0, 0);
+
+  Costmap2D* a = separate.getCostmap();
+  Costmap2D* b = fused.getCostmap();
+  for (unsigned int j = 0; j < a->getSizeInCellsY(); ++j)
+    for (unsigned int i = 0; i < a->getSizeInCellsX(); ++i)
+      ASSERT_EQ(a->getCost(i, j), b->getCost(i, j)) << i << ", " << j;
+}
+}  // namespace
+
+TEST(fused_composition, matches_separate_passes)
+{
+  expectSameComposition(false, false);
+}
+
+TEST(fused_composition, matches_with_unknown_space)
+{
+  expectSameComposition(true, false);
+}
+
+TEST(fused_composition, custom_layer_first_sees_reset_map)
+{
+  expectSameComposition(false, true);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -36,6 +36,7 @@
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/obstacle_layer.h>
 #include <costmap_2d/inflation_layer.h>
+#include <costmap_2d/voxel_layer.h>
 #include <costmap_2d/observation_buffer.h>
 #include <testing_helper.h>
 #include <set>
@@ -315,6 +316,48 @@ TEST(costmap, testInflation3){
   ASSERT_EQ(countValues(*costmap, INSCRIBED_INFLATED_OBSTACLE), (unsigned int)4);
 }
 
+/**
+ * Test that clearing an obstacle also clears its inflation, even when the
+ * clearing layer only reports the cells that changed
+ */
+TEST(costmap, testClearedObstacleLeavesNoInflation){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1.75, 3);
+
+  VoxelLayer* vlayer = new VoxelLayer();
+  vlayer->initialize(&layers, "voxels", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(vlayer));
+  addInflationLayer(layers, tf);
+  layers.setFootprint(polygon);
+
+  addObservation(vlayer, 5.5, 5.5, 0.5, 0.5, 5.5, 0.5);
+  layers.updateMap(0,0,0);
+
+  Costmap2D* costmap = layers.getCostmap();
+  ASSERT_EQ(countValues(*costmap, LETHAL_OBSTACLE), (unsigned int)1);
+  ASSERT_EQ(countValues(*costmap, INSCRIBED_INFLATED_OBSTACLE), (unsigned int)4);
+
+  // look through the obstacle, only its own cell changes in the voxel layer
+  vlayer->clearStaticObservations(true, true);
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  cloud.points.resize(1);
+  cloud.points[0].x = 9.5;
+  cloud.points[0].y = 5.5;
+  cloud.points[0].z = 0.5;
+  geometry_msgs::Point origin;
+  origin.x = 0.5;
+  origin.y = 5.5;
+  origin.z = 0.5;
+  Observation obs(origin, cloud, 100.0, 100.0);
+  vlayer->addStaticObservation(obs, false, true);
+  layers.updateMap(0,0,0);
+
+  ASSERT_EQ(countValues(*costmap, FREE_SPACE, false), (unsigned int)0);
+}
+
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "inflation_tests");
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#include <ros/console.h>
+#include "costmap_2d/cost_values.h"
+#include "costmap_2d/layer_combine.h"
+
+using namespace costmap_2d;
+
+namespace
+{
+typedef void (*CombineFunction)(unsigned char*, const unsigned char*, size_t);
+
+std::vector<unsigned char> randomCosts(size_t n)
+{
+  std::vector<unsigned char> costs(n);
+  for (size_t i = 0; i < n; ++i)
+    costs[i] = rand() % 256;
+  return costs;
+}
+
+double timeKernel(CombineFunction kernel, std::vector<unsigned char> master, const std::vector<unsigned char>& layer)
+{
+  const int repeats = 20;
+  clock_t start = clock();
+  for (int r = 0; r < repeats; ++r)
+    kernel(master.data(), layer.data(), master.size());
+  return static_cast<double>(clock() - start) / CLOCKS_PER_SEC / repeats;
+}
+}  // namespace
+
+// times the combine kernels against their scalar references on a 2000x2000 grid
+int main(int argc, char** argv)
+{
+  srand(7);
+  std::vector<unsigned char> master = randomCosts(2000 * 2000);
+  std::vector<unsigned char> layer = randomCosts(2000 * 2000);
+
+  const char* names[] = { "max", "overwrite", "addition" };
+  CombineFunction kernels[] = { combineMax, combineOverwrite, combineAddition };
+  CombineFunction scalars[] = { combineMaxScalar, combineOverwriteScalar, combineAdditionScalar };
+  for (int k = 0; k < 3; ++k)
+  {
+    double vector_time = timeKernel(kernels[k], master, layer);
+    double scalar_time = timeKernel(scalars[k], master, layer);
+    ROS_INFO("combine %-9s 2000x2000: %.3f ms, scalar %.3f ms", names[k], vector_time * 1e3, scalar_time * 1e3);
+  }
+  return 0;
+}
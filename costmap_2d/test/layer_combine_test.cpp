@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "costmap_2d/cost_values.h"
+#include "costmap_2d/layer_combine.h"
+
+using namespace costmap_2d;
+
+namespace
+{
+typedef void (*CombineFunction)(unsigned char*, const unsigned char*, size_t);
+
+// mostly the values the kernels treat specially, plus some ordinary costs
+std::vector<unsigned char> randomCosts(size_t n)
+{
+  static const unsigned char special[] = { FREE_SPACE, 1, 126, 127, 128, 200, INSCRIBED_INFLATED_OBSTACLE - 1,
+                                           INSCRIBED_INFLATED_OBSTACLE, LETHAL_OBSTACLE, NO_INFORMATION };
+  std::vector<unsigned char> costs(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (rand() % 2)
+      costs[i] = special[rand() % (sizeof(special) / sizeof(special[0]))];
+    else
+      costs[i] = rand() % 256;
+  }
+  return costs;
+}
+
+void expectSameAsScalar(CombineFunction kernel, CombineFunction scalar)
+{
+  srand(42);
+  // cover every tail length and start offsets that are not vector aligned
+  for (size_t n = 0; n < 200; ++n)
+  {
+    for (size_t offset = 0; offset < 3; ++offset)
+    {
+      std::vector<unsigned char> master = randomCosts(n + offset);
+      std::vector<unsigned char> layer = randomCosts(n + offset);
+      std::vector<unsigned char> expected = master;
+
+      kernel(master.data() + offset, layer.data() + offset, n);
+      scalar(expected.data() + offset, layer.data() + offset, n);
+      ASSERT_TRUE(master == expected) << "n = " << n << ", offset = " << offset;
+    }
+  }
+}
+}  // namespace
+
+TEST(layer_combine, max_matches_scalar)
+{
+  expectSameAsScalar(combineMax, combineMaxScalar);
+}
+
+TEST(layer_combine, overwrite_matches_scalar)
+{
+  expectSameAsScalar(combineOverwrite, combineOverwriteScalar);
+}
+
+TEST(layer_combine, addition_matches_scalar)
+{
+  expectSameAsScalar(combineAddition, combineAdditionScalar);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include "costmap_2d/observation_buffer.h"
+
+using namespace costmap_2d;
+
+static tf::TransformListener* tf_listener;
+
+static void addPoint(pcl::PointCloud<pcl::PointXYZ>& cloud, double x, double y, double z)
+{
+  pcl::PointXYZ point;
+  point.x = x;
+  point.y = y;
+  point.z = z;
+  cloud.points.push_back(point);
+}
+
+// a cloud in the global frame, so the buffer needs no transform
+static pcl::PointCloud<pcl::PointXYZ> makeCloud()
+{
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  cloud.header.frame_id = "map";
+  cloud.header.stamp = pcl_conversions::toPCL(ros::Time::now());
+  return cloud;
+}
+
+static std::vector<Observation> getObservations(ObservationBuffer& buffer)
+{
+  std::vector<Observation> observations;
+  buffer.getObservations(observations);
+  return observations;
+}
+
+TEST(observation_buffer, keeps_only_the_latest_without_keep_time)
+{
+  ObservationBuffer buffer("scan", 0.0, 0.0, 0.0, 2.0, 2.5, 3.0, *tf_listener, "map", "", 0.1);
+  for (int i = 0; i < 5; ++i)
+  {
+    pcl::PointCloud<pcl::PointXYZ> cloud = makeCloud();
+    addPoint(cloud, i, 0.0, 1.0);
+    buffer.bufferCloud(cloud);
+  }
+
+  std::vector<Observation> observations = getObservations(buffer);
+  ASSERT_EQ(1u, observations.size());
+  ASSERT_EQ(1u, observations[0].cloud_->points.size());
+  EXPECT_EQ(4.0, observations[0].cloud_->points[0].x);
+  EXPECT_EQ(2.5, observations[0].obstacle_range_);
+  EXPECT_EQ(3.0, observations[0].raytrace_range_);
+}
+
+TEST(observation_buffer, ring_grows_newest_first)
+{
+  // a keep time without an update rate starts with 8 slots, 20 clouds make the ring grow twice
+  ObservationBuffer buffer("scan", 10.0, 0.0, 0.0, 2.0, 2.5, 3.0, *tf_listener, "map", "", 0.1);
+  for (int i = 0; i < 20; ++i)
+  {
+    pcl::PointCloud<pcl::PointXYZ> cloud = makeCloud();
+    addPoint(cloud, i, 0.0, 1.0);
+    buffer.bufferCloud(cloud);
+  }
+
+  std::vector<Observation> observations = getObservations(buffer);
+  ASSERT_EQ(20u, observations.size());
+  for (int i = 0; i < 20; ++i)
+    EXPECT_EQ(19 - i, observations[i].cloud_->points[0].x);
+}
+
+TEST(observation_buffer, held_clouds_are_not_reused)
+{
+  ObservationBuffer buffer("scan", 0.0, 0.0, 0.0, 2.0, 2.5, 3.0, *tf_listener, "map", "", 0.1);
+  pcl::PointCloud<pcl::PointXYZ> cloud = makeCloud();
+  addPoint(cloud, 1.0, 0.0, 1.0);
+  buffer.bufferCloud(cloud);
+  std::vector<Observation> held = getObservations(buffer);
+
+  // the slots go round twice while the caller still shares the first cloud
+  for (int i = 2; i < 6; ++i)
+  {
+    cloud = makeCloud();
+    addPoint(cloud, i, 0.0, 1.0);
+    buffer.bufferCloud(cloud);
+  }
+  ASSERT_EQ(1u, held[0].cloud_->points.size());
+  EXPECT_EQ(1.0, held[0].cloud_->points[0].x);
+
+  std::vector<Observation> observations = getObservations(buffer);
+  ASSERT_EQ(1u, observations.size());
+  EXPECT_EQ(5.0, observations[0].cloud_->points[0].x);
+  EXPECT_NE(held[0].cloud_.get(), observations[0].cloud_.get());
+}
+
+TEST(observation_buffer, downsampling_keeps_the_farthest_point_per_cell)
+{
+  ObservationBuffer buffer("scan", 0.0, 0.0, 0.0, 2.0, 2.5, 3.0, *tf_listener, "map", "", 0.1);
+  buffer.setDownsampling(0.5, 1.0, 0.0, 0.0);
+
+  // the sensor is at the origin of the global frame
+  pcl::PointCloud<pcl::PointXYZ> cloud = makeCloud();
+  addPoint(cloud, 1.1, 1.1, 0.5);
+  addPoint(cloud, 1.4, 1.3, 0.5);  // same cell and band, farther
+  addPoint(cloud, 1.2, 1.2, 0.6);  // same cell and band, nearer
+  addPoint(cloud, 1.2, 1.2, 1.5);  // same cell, next band
+  addPoint(cloud, -0.1, 1.2, 0.5);  // the cell below zero, not the one at zero
+  addPoint(cloud, 0.1, 1.2, 0.5);
+  addPoint(cloud, 1.2, 1.2, 3.0);  // above the maximum height
+  buffer.bufferCloud(cloud);
+
+  std::vector<Observation> observations = getObservations(buffer);
+  ASSERT_EQ(1u, observations.size());
+  const pcl::PointCloud<pcl::PointXYZ>& kept = *observations[0].cloud_;
+  ASSERT_EQ(4u, kept.points.size());
+
+  // the first point of each cell decides the order
+  EXPECT_FLOAT_EQ(1.4, kept.points[0].x);
+  EXPECT_FLOAT_EQ(1.3, kept.points[0].y);
+  EXPECT_FLOAT_EQ(1.5, kept.points[1].z);
+  EXPECT_FLOAT_EQ(-0.1, kept.points[2].x);
+  EXPECT_FLOAT_EQ(0.1, kept.points[3].x);
+}
+
+TEST(observation_buffer, downsampling_drops_points_without_a_cell)
+{
+  ObservationBuffer buffer("scan", 0.0, 0.0, 0.0, 2.0, 2.5, 3.0, *tf_listener, "map", "", 0.1);
+  buffer.setDownsampling(0.5, 0.0, 0.0, 0.0);
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  pcl::PointCloud<pcl::PointXYZ> cloud = makeCloud();
+  addPoint(cloud, nan, 1.0, 0.5);
+  addPoint(cloud, 1.0, nan, 0.5);
+  addPoint(cloud, inf, 1.0, 0.5);
+  addPoint(cloud, 1.0, -inf, 0.5);
+  addPoint(cloud, 1e30, 1.0, 0.5);
+  addPoint(cloud, 1.0, 1.0, 0.5);
+  buffer.bufferCloud(cloud);
+
+  std::vector<Observation> observations = getObservations(buffer);
+  ASSERT_EQ(1u, observations.size());
+  ASSERT_EQ(1u, observations[0].cloud_->points.size());
+  EXPECT_EQ(1.0, observations[0].cloud_->points[0].x);
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "observation_buffer_tests");
+  testing::InitGoogleTest(&argc, argv);
+  tf::TransformListener tf;
+  tf_listener = &tf;
+  return RUN_ALL_TESTS();
+}
@@ -244,6 +244,33 @@ TEST(costmap, testMultipleAdditions){
 
 }
 
+/**
+ * An obstacle layer that leaves the master grid alone, to check that fused composition
+ * goes through the updateCosts() of a subclass rather than ObstacleLayer's own combine
+ */
+class QuietObstacleLayer : public ObstacleLayer
+{
+public:
+  virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+  {
+  }
+};
+
+TEST(costmap, testSubclassOverridingUpdateCosts){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+
+  QuietObstacleLayer* olayer = new QuietObstacleLayer();
+  olayer->initialize(&layers, "obstacles", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(olayer));
+  ASSERT_EQ(olayer->prepareCombine(0, 0, 1, 1), CostmapLayer::COMBINE_CUSTOM);
+
+  addObservation(olayer, 5.0, 5.0);
+  layers.updateMap(0,0,0);
+
+  ASSERT_EQ(countValues(*(layers.getCostmap()), costmap_2d::LETHAL_OBSTACLE), 0);
+}
+
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "obstacle_tests");
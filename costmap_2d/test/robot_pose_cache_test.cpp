@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "costmap_2d/robot_pose_cache.h"
+
+using namespace costmap_2d;
+
+static tf::Stamped<tf::Pose> makePose(double x, double y, double yaw, double stamp)
+{
+  tf::Stamped<tf::Pose> pose;
+  pose.setOrigin(tf::Vector3(x, y, 0.0));
+  pose.setRotation(tf::createQuaternionFromYaw(yaw));
+  pose.stamp_ = ros::Time(stamp);
+  return pose;
+}
+
+TEST(robot_pose_cache, serves_pose_until_invalidated)
+{
+  RobotPoseCache cache;
+  tf::Stamped<tf::Pose> pose;
+  EXPECT_FALSE(cache.load(pose));
+
+  cache.store(cache.getGeneration(), makePose(1.0, 2.0, 0.5, 10.25));
+  ASSERT_TRUE(cache.load(pose));
+  EXPECT_DOUBLE_EQ(1.0, pose.getOrigin().x());
+  EXPECT_DOUBLE_EQ(2.0, pose.getOrigin().y());
+  EXPECT_NEAR(0.5, tf::getYaw(pose.getRotation()), 1e-9);
+  EXPECT_DOUBLE_EQ(10.25, pose.stamp_.toSec());
+
+  cache.invalidate();
+  EXPECT_FALSE(cache.load(pose));
+}
+
+TEST(robot_pose_cache, drops_pose_looked_up_before_invalidation)
+{
+  RobotPoseCache cache;
+  boost::uint32_t generation = cache.getGeneration();
+  // new transforms arrive while the pose is being looked up
+  cache.invalidate();
+  cache.store(generation, makePose(1.0, 2.0, 0.0, 1.0));
+
+  tf::Stamped<tf::Pose> pose;
+  EXPECT_FALSE(cache.load(pose));
+}
+
+static void storePoses(RobotPoseCache* cache, double value, int count)
+{
+  for (int i = 0; i < count; ++i)
+    cache->store(cache->getGeneration(), makePose(value, value, 0.0, value));
+}
+
+TEST(robot_pose_cache, readers_never_see_half_a_store)
+{
+  RobotPoseCache cache;
+  boost::thread_group writers;
+  writers.create_thread(boost::bind(&storePoses, &cache, 1.0, 20000));
+  writers.create_thread(boost::bind(&storePoses, &cache, 2.0, 20000));
+
+  tf::Stamped<tf::Pose> pose;
+  for (int i = 0; i < 20000; ++i)
+  {
+    if (cache.load(pose))
+    {
+      ASSERT_EQ(pose.getOrigin().x(), pose.getOrigin().y());
+      ASSERT_EQ(pose.getOrigin().x(), pose.stamp_.toSec());
+    }
+  }
+  writers.join_all();
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
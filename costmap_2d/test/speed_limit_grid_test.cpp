@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "costmap_2d/speed_limit_grid.h"
+
+using namespace costmap_2d;
+
+TEST(speed_limit_grid, starts_without_limits)
+{
+  SpeedLimitGrid grid;
+  grid.resizeSpeedGrid(10, 5);
+  EXPECT_EQ(10u, grid.getSpeedGridSizeX());
+  EXPECT_EQ(5u, grid.getSpeedGridSizeY());
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimit(9, 4));
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getMinSpeedLimit(0, 0, 9, 4));
+}
+
+TEST(speed_limit_grid, samples_source_with_other_resolution_and_origin)
+{
+  // a 4x2 source at 1m/cell starting at (1, 0), one limit per column
+  std::vector<float> src(8);
+  for (unsigned int i = 0; i < 8; ++i)
+    src[i] = 0.1f * (i % 4 + 1);
+
+  SpeedLimitGrid grid;
+  grid.resizeSpeedGrid(12, 6);
+  grid.sampleSpeedLimits(0.5, 0.0, 0.0, src, 4, 2, 1.0, 1.0, 0.0);
+
+  // left of the source there is no limit
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimit(0, 0));
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimit(1, 0));
+  EXPECT_FLOAT_EQ(0.1f, grid.getSpeedLimit(2, 0));
+  EXPECT_FLOAT_EQ(0.1f, grid.getSpeedLimit(3, 3));
+  EXPECT_FLOAT_EQ(0.4f, grid.getSpeedLimit(9, 1));
+  // right of and above the source
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimit(10, 0));
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimit(5, 4));
+
+  EXPECT_FLOAT_EQ(0.2f, grid.getMinSpeedLimit(4, 0, 9, 3));
+  EXPECT_FLOAT_EQ(0.1f, grid.getMinSpeedLimit(-5, -5, 20, 20));
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getMinSpeedLimit(0, 4, 11, 5));
+}
+
+TEST(speed_limit_grid, resampling_follows_a_moving_origin)
+{
+  std::vector<float> src(100, 1.0f);
+  src[5 * 10 + 5] = 0.25f;
+
+  SpeedLimitGrid grid;
+  grid.resizeSpeedGrid(4, 4);
+  grid.sampleSpeedLimits(1.0, 3.0, 3.0, src, 10, 10, 1.0, 0.0, 0.0);
+  EXPECT_FLOAT_EQ(0.25f, grid.getSpeedLimit(2, 2));
+
+  grid.sampleSpeedLimits(1.0, 4.0, 5.0, src, 10, 10, 1.0, 0.0, 0.0);
+  EXPECT_FLOAT_EQ(1.0f, grid.getSpeedLimit(2, 2));
+  EXPECT_FLOAT_EQ(0.25f, grid.getSpeedLimit(1, 0));
+
+  grid.clearSpeedLimits();
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimit(1, 0));
+}
+
+TEST(speed_limit_grid, snapshots_outlive_changes_to_the_grid)
+{
+  std::vector<float> src(100, 0.5f);
+
+  SpeedLimitGrid grid;
+  EXPECT_EQ(0u, grid.getSpeedLimitSnapshot().getSizeX());
+
+  grid.resizeSpeedGrid(4, 4);
+  grid.sampleSpeedLimits(1.0, 0.0, 0.0, src, 10, 10, 1.0, 0.0, 0.0);
+  SpeedLimitSnapshot snapshot = grid.getSpeedLimitSnapshot();
+  ASSERT_EQ(4u, snapshot.getSizeX());
+  ASSERT_EQ(4u, snapshot.getSizeY());
+  EXPECT_FLOAT_EQ(0.5f, snapshot.getSpeedLimit(3, 3));
+
+  // a reader holding the old snapshot neither sees the reallocation nor the cleared cells
+  grid.resizeSpeedGrid(20, 20);
+  EXPECT_EQ(4u, snapshot.getSizeX());
+  EXPECT_FLOAT_EQ(0.5f, snapshot.getSpeedLimit(3, 3));
+  EXPECT_EQ(20u, grid.getSpeedLimitSnapshot().getSizeX());
+  EXPECT_EQ(SpeedLimitGrid::NO_SPEED_LIMIT, grid.getSpeedLimitSnapshot().getSpeedLimit(3, 3));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "costmap_2d/cost_values.h"
+#include "costmap_2d/tile_grid.h"
+
+using namespace costmap_2d;
+
+TEST(tile_grid, reads_background_until_written)
+{
+  TileGrid<unsigned char> grid;
+  grid.resize(1000, 300, NO_INFORMATION);
+  EXPECT_EQ(16u, grid.getSizeInTilesX());
+  EXPECT_EQ(5u, grid.getSizeInTilesY());
+  EXPECT_EQ(NO_INFORMATION, grid.get(999, 299));
+
+  // writing the background does not allocate anything
+  grid.set(10, 10, NO_INFORMATION);
+  EXPECT_EQ(0u, grid.getAllocatedTiles());
+
+  grid.set(999, 299, LETHAL_OBSTACLE);
+  grid.set(0, 0, FREE_SPACE);
+  grid.set(63, 63, 17);
+  EXPECT_EQ(2u, grid.getAllocatedTiles());
+  EXPECT_EQ(LETHAL_OBSTACLE, grid.get(999, 299));
+  EXPECT_EQ(FREE_SPACE, grid.get(0, 0));
+  EXPECT_EQ(17, grid.get(63, 63));
+  EXPECT_EQ(NO_INFORMATION, grid.get(64, 63));
+  EXPECT_EQ(NO_INFORMATION, grid.get(998, 299));
+
+  const unsigned char* tile = grid.getTile(0, 0);
+  ASSERT_TRUE(tile != NULL);
+  EXPECT_EQ(17, tile[63 * TileGrid<unsigned char>::TILE_SIZE + 63]);
+  EXPECT_TRUE(grid.getTile(1, 0) == NULL);
+}
+
+TEST(tile_grid, reset_clears_and_reuses_tiles)
+{
+  TileGrid<bool> grid;
+  grid.resize(200, 200, false);
+  for (unsigned int i = 0; i < 200; ++i)
+    grid.set(i, i, true);
+  EXPECT_EQ(4u, grid.getAllocatedTiles());
+
+  grid.reset();
+  EXPECT_EQ(0u, grid.getAllocatedTiles());
+  for (unsigned int i = 0; i < 200; ++i)
+    EXPECT_FALSE(grid.get(i, i));
+
+  // a reused tile must not keep values from before the reset
+  grid.set(5, 6, true);
+  EXPECT_TRUE(grid.get(5, 6));
+  EXPECT_FALSE(grid.get(5, 5));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
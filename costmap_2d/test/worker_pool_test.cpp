@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <boost/bind.hpp>
+#include <vector>
+
+#include "costmap_2d/worker_pool.h"
+
+using namespace costmap_2d;
+
+static void countPart(std::vector<int>* calls, unsigned int part)
+{
+  (*calls)[part]++;
+}
+
+TEST(worker_pool, runs_every_part_once)
+{
+  WorkerPool pool(4);
+  EXPECT_EQ(4u, pool.getThreads());
+
+  // the same pool serves many jobs, with more and with fewer parts than threads
+  unsigned int parts[] = { 1, 3, 4, 17, 0, 2 };
+  for (unsigned int round = 0; round < 50; ++round)
+  {
+    unsigned int count = parts[round % 6];
+    std::vector<int> calls(count, 0);
+    pool.run(count, boost::bind(&countPart, &calls, _1));
+    for (unsigned int i = 0; i < count; ++i)
+      EXPECT_EQ(1, calls[i]);
+  }
+}
+
+TEST(worker_pool, single_thread_runs_on_the_caller)
+{
+  WorkerPool pool(1);
+  EXPECT_EQ(1u, pool.getThreads());
+
+  std::vector<int> calls(5, 0);
+  pool.run(5, boost::bind(&countPart, &calls, _1));
+  for (unsigned int i = 0; i < 5; ++i)
+    EXPECT_EQ(1, calls[i]);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
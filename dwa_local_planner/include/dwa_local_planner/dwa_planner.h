@@ -49,6 +49,7 @@
 
 //for obstacle data access
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/speed_limit_grid.h>
 
 #include <base_local_planner/trajectory.h>
 #include <base_local_planner/local_planner_limits.h>
@@ -142,6 +143,14 @@ namespace dwa_local_planner {
        */
       bool setPlan(const std::vector<geometry_msgs::PoseStamped>& orig_global_plan);
 
+      /**
+       * @brief Use per-cell speed limits laid out like the planner's costmap, e.g. from a
+       * costmap_2d::SpeedZoneLayer. Samples above the limit at the robot are dropped before
+       * they are rolled out, trajectories crossing a slower cell are rejected while scoring
+       * obstacles. Pass NULL to stop using limits.
+       */
+      void setSpeedLimitGrid(const costmap_2d::SpeedLimitGrid* speed_limits);
+
     private:
 
       base_local_planner::LocalPlannerUtil *planner_util_;
@@ -151,6 +160,7 @@ namespace dwa_local_planner {
       Eigen::Vector3f vsamples_;
 
       double sim_period_;///< @brief The number of seconds to use to compute max/min vels for dwa
+      double sim_time_; ///< @brief The number of seconds each trajectory is rolled out for
       base_local_planner::Trajectory result_traj_;
 
       double forward_point_distance_;
@@ -162,9 +172,16 @@ namespace dwa_local_planner {
       pcl_ros::Publisher<base_local_planner::MapGridCostPoint> traj_cloud_pub_;
       bool publish_cost_grid_pc_; ///< @brief Whether or not to build and publish a PointCloud
       bool publish_traj_pc_;
+      int traj_pc_max_trajectories_; ///< @brief Only the cheapest this many trajectories go into the cloud, 0 for all
+      double traj_pc_publish_period_; ///< @brief Minimum time between two clouds, 0 to publish every cycle
+      ros::Time last_traj_pc_publish_;
 
       double cheat_factor_;
 
+      bool egocentric_scoring_; ///< @brief Score in grids resampled around the robot instead of in the costmap
+
+      const costmap_2d::SpeedLimitGrid* speed_limits_;
+
       base_local_planner::MapGridVisualizer map_viz_; ///< @brief The map grid visualizer for outputting the potential field generated by the cost function
 
       // see constructor body for explanations
@@ -114,7 +114,11 @@ namespace dwa_local_planner {
        */
       bool isGoalReached();
 
-
+      /**
+       * @brief  Cap max_trans_vel and max_rot_vel by the given limit on every cycle
+       * @return True, the limit is always honored
+       */
+      bool setSpeedLimit(const boost::shared_ptr<const nav_core::SpeedLimit>& speed_limit);
 
       bool isInitialized() {
         return initialized_;
@@ -43,6 +43,7 @@
 #include <queue>
 
 #include <angles/angles.h>
+#include <costmap_2d/footprint.h>
 
 #include <ros/ros.h>
 
@@ -54,6 +55,7 @@ namespace dwa_local_planner {
 
     boost::mutex::scoped_lock l(configuration_mutex_);
 
+    sim_time_ = config.sim_time;
     generator_.setParameters(
         config.sim_time,
         config.sim_granularity,
@@ -115,6 +117,7 @@ namespace dwa_local_planner {
 
   DWAPlanner::DWAPlanner(std::string name, base_local_planner::LocalPlannerUtil *planner_util) :
       planner_util_(planner_util),
+      speed_limits_(NULL),
       obstacle_costs_(planner_util->getCostmap()),
       path_costs_(planner_util->getCostmap()),
       goal_costs_(planner_util->getCostmap(), 0.0, 0.0, true),
@@ -161,9 +164,14 @@ namespace dwa_local_planner {
     traj_cloud_->header.frame_id = frame_id;
     traj_cloud_pub_.advertise(private_nh, "trajectory_cloud", 1);
     private_nh.param("publish_traj_pc", publish_traj_pc_, false);
-
-    // set up all the cost functions that will be applied in order
-    // (any function returning negative values will abort scoring, so the order can improve performance)
+    private_nh.param("traj_pc_max_trajectories", traj_pc_max_trajectories_, 0);
+    double traj_pc_publish_rate;
+    private_nh.param("traj_pc_publish_rate", traj_pc_publish_rate, 0.0);
+    traj_pc_publish_period_ = traj_pc_publish_rate > 0.0 ? 1.0 / traj_pc_publish_rate : 0.0;
+
+    // set up all the cost functions that will be applied
+    // (any function returning negative values will abort scoring, so the scored sampling planner
+    // reorders them by measured cost and rejection rate; this list is just the initial order)
     std::vector<base_local_planner::TrajectoryCostFunction*> critics;
     critics.push_back(&oscillation_costs_); // discards oscillating motions (assisgns cost -1)
     critics.push_back(&obstacle_costs_); // discards trajectories that move into obstacles
@@ -173,12 +181,29 @@ namespace dwa_local_planner {
     critics.push_back(&goal_costs_); // prefers trajectories that go towards (local) goal, based on wave propagation
 
     // trajectory generators
+    // samples the oscillation critic would reject are dropped before they are rolled out
+    generator_.setOscillationHistory(&oscillation_costs_.getHistory());
+    // optionally sample on a fixed velocity lattice so that the samples are only rebuilt when the
+    // window moves; off by default since it changes which velocities are tried: samples snap to
+    // the lattice and the edges of the window are not sampled unless they fall on it
+    bool use_velocity_lattice;
+    private_nh.param("use_velocity_lattice", use_velocity_lattice, false);
+    generator_.setUseVelocityLattice(use_velocity_lattice);
+    // with dwa a rollout only depends on its sample, so its shape can be simulated once and then
+    // moved to the robot pose; that only pays off when the samples repeat, as on the lattice
+    bool cache_rollouts;
+    private_nh.param("cache_rollouts", cache_rollouts, use_velocity_lattice);
+    generator_.setRolloutCache(cache_rollouts);
     std::vector<base_local_planner::TrajectorySampleGenerator*> generator_list;
     generator_list.push_back(&generator_);
 
     scored_sampling_planner_ = base_local_planner::SimpleScoredSamplingPlanner(generator_list, critics);
 
     private_nh.param("cheat_factor", cheat_factor_, 1.0);
+
+    // resample the costmap and the distance grids around the robot each cycle, so scoring a
+    // point does not need its costmap cell (costs along obstacle edges can move by a cell)
+    private_nh.param("egocentric_scoring", egocentric_scoring_, false);
   }
 
   // used for visualization only, total_costs are not really total costs
@@ -201,6 +226,12 @@ namespace dwa_local_planner {
     return true;
   }
 
+  void DWAPlanner::setSpeedLimitGrid(const costmap_2d::SpeedLimitGrid* speed_limits) {
+    boost::mutex::scoped_lock l(configuration_mutex_);
+    speed_limits_ = speed_limits;
+    obstacle_costs_.setSpeedLimitGrid(speed_limits);
+  }
+
   bool DWAPlanner::setPlan(const std::vector<geometry_msgs::PoseStamped>& orig_global_plan) {
     oscillation_costs_.resetOscillationFlags();
     return planner_util_->setPlan(orig_global_plan);
@@ -240,12 +271,10 @@ namespace dwa_local_planner {
   void DWAPlanner::updatePlanAndLocalCosts(
       tf::Stamped<tf::Pose> global_pose,
       const std::vector<geometry_msgs::PoseStamped>& new_plan) {
-    global_plan_.resize(new_plan.size());
-    for (unsigned int i = 0; i < new_plan.size(); ++i) {
-      global_plan_[i] = new_plan[i];
-    }
+    global_plan_ = new_plan;
 
-    // costs for going away from path
+    // costs for going away from path (the critics only propagate again when the poses
+    // or the costmap changed)
     path_costs_.setTargetPoses(global_plan_);
 
     // costs for not going towards the local goal as much as possible
@@ -306,6 +335,46 @@ namespace dwa_local_planner {
     Eigen::Vector3f goal(goal_pose.pose.position.x, goal_pose.pose.position.y, tf::getYaw(goal_pose.pose.orientation));
     base_local_planner::LocalPlannerLimits limits = planner_util_->getCurrentLimits();
 
+    // samples faster than the zone the robot is in would be rejected anyway, so narrow the
+    // window before they are generated and rolled out
+    costmap_2d::Costmap2D* costmap = planner_util_->getCostmap();
+    unsigned int cell_x, cell_y;
+    costmap_2d::SpeedLimitSnapshot zones;
+    if (speed_limits_ != NULL) {
+      zones = speed_limits_->getSpeedLimitSnapshot();
+    }
+    if (zones.getSizeX() == costmap->getSizeInCellsX() &&
+        zones.getSizeY() == costmap->getSizeInCellsY() &&
+        costmap->worldToMap(pos[0], pos[1], cell_x, cell_y)) {
+      double zone_limit = zones.getSpeedLimit(cell_x, cell_y);
+      if (limits.max_trans_vel < 0 || zone_limit < limits.max_trans_vel) {
+        limits.max_trans_vel = zone_limit;
+        limits.max_vel_x = std::min(limits.max_vel_x, zone_limit);
+        limits.min_vel_x = std::max(limits.min_vel_x, -zone_limit);
+        limits.max_vel_y = std::min(limits.max_vel_y, zone_limit);
+        limits.min_vel_y = std::max(limits.min_vel_y, -zone_limit);
+      }
+    }
+
+    if (egocentric_scoring_) {
+      // the grids have to hold every footprint along the fastest trajectory and the shifted scoring points
+      double inscribed_radius, circumscribed_radius;
+      costmap_2d::calculateMinAndMaxDistances(footprint_spec, inscribed_radius, circumscribed_radius);
+      double max_speed = std::max(fabs(limits.max_vel_x), fabs(limits.min_vel_x)) +
+          std::max(fabs(limits.max_vel_y), fabs(limits.min_vel_y));
+      double reach = max_speed * sim_time_ + circumscribed_radius + forward_point_distance_ + costmap->getResolution();
+      obstacle_costs_.setEgocentric(true, reach);
+      obstacle_costs_.setRobotPose(pos[0], pos[1], pos[2]);
+      path_costs_.setEgocentric(true, reach);
+      path_costs_.setRobotPose(pos[0], pos[1], pos[2]);
+      goal_costs_.setEgocentric(true, reach);
+      goal_costs_.setRobotPose(pos[0], pos[1], pos[2]);
+      goal_front_costs_.setEgocentric(true, reach);
+      goal_front_costs_.setRobotPose(pos[0], pos[1], pos[2]);
+      alignment_costs_.setEgocentric(true, reach);
+      alignment_costs_.setRobotPose(pos[0], pos[1], pos[2]);
+    }
+
     // prepare cost functions and generators for this run
     generator_.initialise(pos,
         vel,
@@ -314,12 +383,21 @@ namespace dwa_local_planner {
         vsamples_);
 
     result_traj_.cost_ = -7;
+    // only collect the explored trajectories when someone will see them, copying them all
+    // can take as long as the search itself
+    ros::Time now = ros::Time::now();
+    bool publish_traj_pc = publish_traj_pc_ && traj_cloud_pub_.getNumSubscribers() > 0 &&
+        (traj_pc_publish_period_ <= 0.0 || last_traj_pc_publish_.isZero() ||
+         (now - last_traj_pc_publish_).toSec() >= traj_pc_publish_period_);
+
     // find best trajectory by sampling and scoring the samples
     std::vector<base_local_planner::Trajectory> all_explored;
-    scored_sampling_planner_.findBestTrajectory(result_traj_, &all_explored);
+    scored_sampling_planner_.findBestTrajectory(result_traj_, publish_traj_pc ? &all_explored : NULL,
+                                                std::max(0, traj_pc_max_trajectories_));
 
-    if(publish_traj_pc_)
+    if(publish_traj_pc)
     {
+        last_traj_pc_publish_ = now;
         base_local_planner::MapGridCostPoint pt;
         traj_cloud_->points.clear();
         traj_cloud_->width = 0;
@@ -45,6 +45,7 @@
 
 #include <base_local_planner/goal_functions.h>
 #include <nav_msgs/Path.h>
+#include <costmap_2d/layer.h>
 
 //register this planner as a BaseLocalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(dwa_local_planner::DWAPlannerROS, nav_core::BaseLocalPlanner)
@@ -112,10 +113,27 @@ namespace dwa_local_planner {
       //create the actual planner that we'll use.. it'll configure itself from the parameter server
       dp_ = boost::shared_ptr<DWAPlanner>(new DWAPlanner(name, &planner_util_));
 
+      // pick up per-cell speed limits if one of the costmap layers provides them
+      std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap_ros_->getLayeredCostmap()->getPlugins();
+      for (std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator plugin = plugins->begin();
+          plugin != plugins->end(); ++plugin) {
+        costmap_2d::SpeedLimitGrid* speed_limits = dynamic_cast<costmap_2d::SpeedLimitGrid*>(plugin->get());
+        if (speed_limits != NULL) {
+          ROS_INFO("Using speed limits from costmap layer %s", (*plugin)->getName().c_str());
+          dp_->setSpeedLimitGrid(speed_limits);
+          break;
+        }
+      }
+
       if( private_nh.getParam( "odom_topic", odom_topic_ ))
       {
         odom_helper_.setOdomTopic( odom_topic_ );
       }
+
+      // smooth the odometry the velocity window starts from, off by default
+      double odom_average_window;
+      private_nh.param("odom_average_window", odom_average_window, 0.0);
+      odom_helper_.setAverageWindow(odom_average_window);
       
       initialized_ = true;
 
@@ -140,6 +158,11 @@ namespace dwa_local_planner {
     return dp_->setPlan(orig_global_plan);
   }
 
+  bool DWAPlannerROS::setSpeedLimit(const boost::shared_ptr<const nav_core::SpeedLimit>& speed_limit) {
+    planner_util_.setSpeedLimit(speed_limit);
+    return true;
+  }
+
   bool DWAPlannerROS::isGoalReached() {
     if (! isInitialized()) {
       ROS_ERROR("This planner has not been initialized, please call initialize() before using this planner");
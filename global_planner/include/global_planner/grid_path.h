@@ -42,10 +42,30 @@
 
 namespace global_planner {
 
+/**
+ * @class GridPath
+ * @brief Follows the steepest descent of the potential from cell to cell.
+ *
+ * Each step moves to the lowest neighbour that has not been visited yet, so plateaus cannot trap the
+ * traceback in a loop, and the walk gives up once the step budget is spent.
+ */
 class GridPath : public Traceback {
     public:
         GridPath(PotentialCalculator* p_calc): Traceback(p_calc){}
+        void setSize(int xs, int ys);
         bool getPath(float* potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path);
+    private:
+        /**
+         * @brief Adds a cell index to the visited set
+         * @return False if the cell had already been visited
+         */
+        bool markVisited(int index);
+        bool isVisited(int index);
+        void clearVisited();
+
+        int offsets_[8]; /**< index offsets of the eight neighbours */
+        std::vector<int> visited_; /**< open addressing hash set of visited indices, -1 marks a free slot */
+        std::vector<int> visited_slots_; /**< occupied slots of visited_, so clearing costs only the path length */
 };
 
 } //end namespace global_planner
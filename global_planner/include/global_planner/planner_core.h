@@ -176,6 +176,10 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
         bool worldToMap(double wx, double wy, double& mx, double& my);
         void clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my);
         void publishPotential(float* potential);
+        /**
+         * @brief Creates the expander chosen by use_sweeping_ and use_dijkstra_ for the current costmap size
+         */
+        Expander* createExpander();
 
         double planner_window_x_, planner_window_y_, default_tolerance_;
         std::string tf_prefix_;
@@ -184,11 +188,17 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
 
         PotentialCalculator* p_calc_;
         Expander* planner_;
+        bool use_quadratic_, use_dijkstra_, use_sweeping_;
+        int sweeping_threads_;
         Traceback* path_maker_;
+        std::vector<std::pair<float, float> > path_buffer_; /**< reused by getPlanFromPotential to avoid reallocating */
 
         bool publish_potential_;
         ros::Publisher potential_pub_;
         int publish_scale_;
+        double potential_publish_period_; /**< minimum time between two potential grids, 0 to publish every plan */
+        int potential_max_cells_; /**< the potential is downsampled to read at most this many cells, 0 for no limit */
+        ros::Time last_potential_publish_;
 
         void outlineMap(unsigned char* costarr, int nx, int ny, unsigned char value);
         unsigned char* cost_array_;
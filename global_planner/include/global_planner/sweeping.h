@@ -0,0 +1,127 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _SWEEPING_H
+#define _SWEEPING_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <costmap_2d/worker_pool.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class SweepingExpansion
+ * @brief Computes the potential with the Fast Sweeping Method instead of a priority-driven wavefront.
+ *
+ * The grid is relaxed with alternating-direction Gauss-Seidel sweeps until no cell improves. Every cell
+ * is visited in memory order, so the whole field is computed without a heap or priority buffers. With
+ * more than one thread the interior rows are split into bands that are swept concurrently in two
+ * (even/odd) phases, so neighbouring bands are never written at the same time. The threads are
+ * kept in a pool between sweeps and plans.
+ */
+class SweepingExpansion : public Expander {
+    public:
+        SweepingExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        ~SweepingExpansion();
+
+        /**
+         * @brief Sweeps the whole grid until it converges or @a cycles sweep iterations have run
+         * @return True if the potential at (end_x, end_y) was reached
+         */
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Sets or resets the size of the map
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny); /**< sets or resets the size of the map */
+
+        void setPreciseStart(bool precise){ precise_ = precise; }
+
+        /**
+         * @brief Selects the quadratic (QuadraticCalculator) or simple (PotentialCalculator) local update
+         */
+        void setQuadratic(bool quadratic){ quadratic_ = quadratic; }
+
+        /**
+         * @brief Sets the number of threads used to sweep row bands in parallel (1 sweeps serially)
+         */
+        void setThreads(int threads);
+
+    private:
+        float getCost(unsigned char* costs, int n) {
+            float c = costs[n];
+            if (c < lethal_cost_ - 1 || (unknown_ && c==255)) {
+                c = c * factor_ + neutral_cost_;
+                if (c >= lethal_cost_)
+                    c = lethal_cost_ - 1;
+                return c;
+            }
+            return lethal_cost_;
+        }
+
+        /**
+         * @brief Runs the four alternating-direction sweeps over one band of rows
+         * @param band Index of the band in band_begin_
+         */
+        void sweepBand(float* potential, int band);
+
+        /**
+         * @brief Sweeps the i-th band of one parity, the job handed to the worker pool
+         */
+        void sweepParityBand(float* potential, int parity, unsigned int i) {
+            sweepBand(potential, parity + 2 * i);
+        }
+
+        template<bool quadratic>
+        bool sweep(float* potential, float* vertical, int row_begin, int row_end, bool forward_x, bool forward_y);
+
+        void resizeBands();
+
+        float* travel_; /**< per-cell traversal cost, lethal_cost_ for cells that are never updated */
+        float* scratch_; /**< one row of vertical neighbour minima per concurrently swept band */
+        bool precise_, quadratic_;
+        int threads_;
+        costmap_2d::WorkerPool* pool_; /**< sweeps the bands, NULL while sweeping serially */
+
+        std::vector<int> band_begin_; /**< first row of each band, plus one past the last interior row */
+        std::vector<char> band_changed_;
+};
+
+} //end namespace global_planner
+#endif
@@ -44,7 +44,7 @@ namespace global_planner {
 
 class Traceback {
     public:
-        Traceback(PotentialCalculator* p_calc) : p_calc_(p_calc) {}
+        Traceback(PotentialCalculator* p_calc) : max_steps_(0), p_calc_(p_calc) {}
 
         virtual bool getPath(float* potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path) = 0;
         virtual void setSize(int xs, int ys) {
@@ -57,8 +57,16 @@ class Traceback {
         void setLethalCost(unsigned char lethal_cost) {
             lethal_cost_ = lethal_cost;
         }
+        /**
+         * @brief Sets the number of steps after which getPath gives up
+         * @param max_steps The step budget, or 0 to derive one from the map size
+         */
+        void setMaxSteps(int max_steps) {
+            max_steps_ = max_steps;
+        }
     protected:
         int xs_, ys_;
+        int max_steps_;
         unsigned char lethal_cost_;
         PotentialCalculator* p_calc_;
 };
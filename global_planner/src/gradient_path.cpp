@@ -76,8 +76,11 @@ bool GradientPath::getPath(float* potential, double start_x, double start_y, dou
     memset(gradx_, 0, ns * sizeof(float));
     memset(grady_, 0, ns * sizeof(float));
 
+    int max_steps = max_steps_ > 0 ? max_steps_ : ns * 4;
+    path.reserve(path.size() + std::min(max_steps, 8 * (xs_ + ys_)));
+
     int c = 0;
-    while (c++<ns*4) {
+    while (c++<max_steps) {
         // check if near goal
         double nx = stc % xs_ + dx, ny = stc / xs_ + dy;
 
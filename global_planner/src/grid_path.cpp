@@ -36,41 +36,107 @@
  *         David V. Lu!!
  *********************************************************************/
 #include <global_planner/grid_path.h>
+#include <global_planner/planner_core.h>
 #include <algorithm>
 #include <stdio.h>
 namespace global_planner {
 
+// initial size of the visited set, it grows when the path gets longer
+#define VISITED_INITIAL_SIZE 1024
+
+void GridPath::setSize(int xs, int ys) {
+    Traceback::setSize(xs, ys);
+    int k = 0;
+    for (int yd = -1; yd <= 1; yd++)
+        for (int xd = -1; xd <= 1; xd++)
+            if (xd != 0 || yd != 0)
+                offsets_[k++] = xd + yd * xs;
+    if (visited_.empty())
+        visited_.assign(VISITED_INITIAL_SIZE, -1);
+}
+
+bool GridPath::isVisited(int index) {
+    unsigned int mask = visited_.size() - 1;
+    for (unsigned int slot = (index * 2654435761u) & mask; visited_[slot] != -1; slot = (slot + 1) & mask)
+        if (visited_[slot] == index)
+            return true;
+    return false;
+}
+
+bool GridPath::markVisited(int index) {
+    // keep the load factor at or below one half
+    if (2 * (visited_slots_.size() + 1) > visited_.size()) {
+        std::vector<int> indices;
+        indices.reserve(visited_slots_.size());
+        for (unsigned int i = 0; i < visited_slots_.size(); i++)
+            indices.push_back(visited_[visited_slots_[i]]);
+        visited_.assign(visited_.size() * 2, -1);
+        visited_slots_.clear();
+        for (unsigned int i = 0; i < indices.size(); i++)
+            markVisited(indices[i]);
+    }
+
+    unsigned int mask = visited_.size() - 1;
+    unsigned int slot = (index * 2654435761u) & mask;
+    for (; visited_[slot] != -1; slot = (slot + 1) & mask)
+        if (visited_[slot] == index)
+            return false;
+    visited_[slot] = index;
+    visited_slots_.push_back(slot);
+    return true;
+}
+
+void GridPath::clearVisited() {
+    for (unsigned int i = 0; i < visited_slots_.size(); i++)
+        visited_[visited_slots_[i]] = -1;
+    visited_slots_.clear();
+}
+
 bool GridPath::getPath(float* potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path) {
     std::pair<float, float> current;
     current.first = end_x;
     current.second = end_y;
 
     int start_index = getIndex(start_x, start_y);
+    int index = getIndex(current.first, current.second);
+    int max_steps = max_steps_ > 0 ? max_steps_ : xs_ * ys_;
 
+    clearVisited();
+    markVisited(index);
+    path.reserve(path.size() + std::min(max_steps, 4 * (xs_ + ys_)));
     path.push_back(current);
-    while (getIndex(current.first, current.second) != start_index) {
-        float min_val = 1e10;
-        int min_x = 0, min_y = 0;
-        for (int xd = -1; xd <= 1; xd++) {
-            for (int yd = -1; yd <= 1; yd++) {
-                if (xd == 0 && yd == 0)
-                    continue;
-                int x = current.first + xd, y = current.second + yd;
-                int index = getIndex(x, y);
-                if (potential[index] < min_val) {
-                    min_val = potential[index];
-                    min_x = x;
-                    min_y = y;
-                }
+
+    for (int step = 0; index != start_index; step++) {
+        if (step >= max_steps)
+            return false;
+
+        // the outermost cells have no complete neighbourhood
+        int x = index % xs_, y = index / xs_;
+        if (x <= 0 || x >= xs_ - 1 || y <= 0 || y >= ys_ - 1)
+            return false;
+
+        float min_val = POT_HIGH;
+        int min_index = -1;
+        for (int k = 0; k < 8; k++) {
+            int n = index + offsets_[k];
+            if (potential[n] < min_val && !isVisited(n)) {
+                min_val = potential[n];
+                min_index = n;
             }
         }
-        if (min_x == 0 && min_y == 0)
+        if (min_index < 0)
             return false;
-        current.first = min_x;
-        current.second = min_y;
-        path.push_back(current);
 
+        index = min_index;
+        markVisited(index);
+        current.first = index % xs_;
+        current.second = index / xs_;
+        path.push_back(current);
     }
+
+    // finish on the exact start position rather than the corner of its cell
+    path.back().first = start_x;
+    path.back().second = start_y;
     return true;
 }
 
@@ -43,9 +43,12 @@
 
 #include <global_planner/dijkstra.h>
 #include <global_planner/astar.h>
+#include <global_planner/sweeping.h>
 #include <global_planner/grid_path.h>
 #include <global_planner/gradient_path.h>
 #include <global_planner/quadratic_calculator.h>
+#include <algorithm>
+#include <cmath>
 
 //register this planner as a BaseGlobalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(global_planner::GlobalPlanner, nav_core::BaseGlobalPlanner)
@@ -95,24 +98,17 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         else
             convert_offset_ = 0.0;
 
-        bool use_quadratic;
-        private_nh.param("use_quadratic", use_quadratic, true);
-        if (use_quadratic)
+        private_nh.param("use_quadratic", use_quadratic_, true);
+        if (use_quadratic_)
             p_calc_ = new QuadraticCalculator(cx, cy);
         else
             p_calc_ = new PotentialCalculator(cx, cy);
 
-        bool use_dijkstra;
-        private_nh.param("use_dijkstra", use_dijkstra, true);
-        if (use_dijkstra)
-        {
-            DijkstraExpansion* de = new DijkstraExpansion(p_calc_, cx, cy);
-            if(!old_navfn_behavior_)
-                de->setPreciseStart(true);
-            planner_ = de;
-        }
-        else
-            planner_ = new AStarExpansion(p_calc_, cx, cy);
+        //use_sweeping can also be changed through dynamic reconfigure
+        private_nh.param("use_dijkstra", use_dijkstra_, true);
+        private_nh.param("use_sweeping", use_sweeping_, false);
+        private_nh.param("sweeping_threads", sweeping_threads_, 1);
+        planner_ = createExpander();
 
         bool use_grid_path;
         private_nh.param("use_grid_path", use_grid_path, false);
@@ -121,6 +117,10 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         else
             path_maker_ = new GradientPath(p_calc_);
 
+        int max_traceback_steps;
+        private_nh.param("max_traceback_steps", max_traceback_steps, 0);
+        path_maker_->setMaxSteps(max_traceback_steps);
+
         plan_pub_ = private_nh.advertise<nav_msgs::Path>("plan", 1);
         potential_pub_ = private_nh.advertise<nav_msgs::OccupancyGrid>("potential", 1);
 
@@ -131,6 +131,11 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         private_nh.param("default_tolerance", default_tolerance_, 0.0);
         private_nh.param("publish_scale", publish_scale_, 100);
 
+        double potential_publish_rate;
+        private_nh.param("potential_publish_rate", potential_publish_rate, 0.0);
+        potential_publish_period_ = potential_publish_rate > 0.0 ? 1.0 / potential_publish_rate : 0.0;
+        private_nh.param("potential_max_cells", potential_max_cells_, 0);
+
         double costmap_pub_freq;
         private_nh.param("planner_costmap_publish_frequency", costmap_pub_freq, 0.0);
 
@@ -151,7 +156,37 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
 
 }
 
+Expander* GlobalPlanner::createExpander() {
+    unsigned int cx = costmap_->getSizeInCellsX(), cy = costmap_->getSizeInCellsY();
+    if (use_sweeping_)
+    {
+        SweepingExpansion* se = new SweepingExpansion(p_calc_, cx, cy);
+        se->setQuadratic(use_quadratic_);
+        se->setThreads(sweeping_threads_);
+        if(!old_navfn_behavior_)
+            se->setPreciseStart(true);
+        return se;
+    }
+    else if (use_dijkstra_)
+    {
+        DijkstraExpansion* de = new DijkstraExpansion(p_calc_, cx, cy);
+        if(!old_navfn_behavior_)
+            de->setPreciseStart(true);
+        return de;
+    }
+    else
+        return new AStarExpansion(p_calc_, cx, cy);
+}
+
 void GlobalPlanner::reconfigureCB(global_planner::GlobalPlannerConfig& config, uint32_t level) {
+    if (config.use_sweeping != use_sweeping_) {
+        //makePlan may be using the current expander
+        boost::mutex::scoped_lock lock(mutex_);
+        use_sweeping_ = config.use_sweeping;
+        delete planner_;
+        planner_ = createExpander();
+        planner_->setHasUnknown(allow_unknown_);
+    }
     planner_->setLethalCost(config.lethal_cost);
     path_maker_->setLethalCost(config.lethal_cost);
     planner_->setNeutralCost(config.neutral_cost);
@@ -347,7 +382,8 @@ bool GlobalPlanner::getPlanFromPotential(double start_x, double start_y, double
     //clear the plan, just in case
     plan.clear();
 
-    std::vector<std::pair<float, float> > path;
+    std::vector<std::pair<float, float> >& path = path_buffer_;
+    path.clear();
 
     if (!path_maker_->getPath(potential_array_, start_x, start_y, goal_x, goal_y, path)) {
         ROS_ERROR("NO PATH!");
@@ -381,42 +417,76 @@ bool GlobalPlanner::getPlanFromPotential(double start_x, double start_y, double
 
 void GlobalPlanner::publishPotential(float* potential)
 {
+    if (potential_pub_.getNumSubscribers() == 0)
+        return;
+
+    ros::Time now = ros::Time::now();
+    if (potential_publish_period_ > 0.0 && !last_potential_publish_.isZero()
+            && (now - last_potential_publish_).toSec() < potential_publish_period_)
+        return;
+    last_potential_publish_ = now;
+
     int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
     double resolution = costmap_->getResolution();
+
+    // only every step-th cell in each direction is read, so that at most potential_max_cells_ are
+    int step = 1;
+    if (potential_max_cells_ > 0) {
+        step = std::max(1, (int) sqrt((double) nx * ny / potential_max_cells_));
+        while ((double) ((nx + step - 1) / step) * ((ny + step - 1) / step) > potential_max_cells_)
+            step++;
+    }
+    int sx = (nx + step - 1) / step, sy = (ny + step - 1) / step;
+
+    // find the part the expansion reached, only that is published
+    int min_i = sx, min_j = sy, max_i = -1, max_j = -1;
+    float max = 0.0;
+    for (int j = 0; j < sy; j++) {
+        float* row = potential + j * step * nx;
+        for (int i = 0; i < sx; i++) {
+            float p = row[i * step];
+            if (p < POT_HIGH) {
+                if (p > max)
+                    max = p;
+                min_i = std::min(min_i, i);
+                max_i = std::max(max_i, i);
+                min_j = std::min(min_j, j);
+                max_j = std::max(max_j, j);
+            }
+        }
+    }
+    if (max_i < 0)
+        return;
+
     nav_msgs::OccupancyGrid grid;
-    // Publish Whole Grid
     grid.header.frame_id = frame_id_;
-    grid.header.stamp = ros::Time::now();
-    grid.info.resolution = resolution;
+    grid.header.stamp = now;
+    grid.info.resolution = resolution * step;
 
-    grid.info.width = nx;
-    grid.info.height = ny;
+    grid.info.width = max_i - min_i + 1;
+    grid.info.height = max_j - min_j + 1;
 
+    // each published cell is centered on the costmap cell it was sampled from
     double wx, wy;
-    costmap_->mapToWorld(0, 0, wx, wy);
-    grid.info.origin.position.x = wx - resolution / 2;
-    grid.info.origin.position.y = wy - resolution / 2;
+    costmap_->mapToWorld(min_i * step, min_j * step, wx, wy);
+    grid.info.origin.position.x = wx - resolution * step / 2;
+    grid.info.origin.position.y = wy - resolution * step / 2;
     grid.info.origin.position.z = 0.0;
     grid.info.origin.orientation.w = 1.0;
 
-    grid.data.resize(nx * ny);
-
-    float max = 0.0;
-    for (unsigned int i = 0; i < grid.data.size(); i++) {
-        float potential = potential_array_[i];
-        if (potential < POT_HIGH) {
-            if (potential > max) {
-                max = potential;
-            }
+    grid.data.resize(grid.info.width * grid.info.height);
+
+    float scale = max > 0.0 ? publish_scale_ / max : 0.0;
+    for (int j = min_j, k = 0; j <= max_j; j++) {
+        float* row = potential + j * step * nx;
+        for (int i = min_i; i <= max_i; i++, k++) {
+            float p = row[i * step];
+            if (p >= POT_HIGH)
+                grid.data[k] = -1;
+            else
+                grid.data[k] = p * scale;
         }
     }
-
-    for (unsigned int i = 0; i < grid.data.size(); i++) {
-        if (potential_array_[i] >= POT_HIGH) {
-            grid.data[i] = -1;
-        } else 
-            grid.data[i] = potential_array_[i] * publish_scale_ / max;
-    }
     potential_pub_.publish(grid);
 }
 
@@ -0,0 +1,236 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/sweeping.h>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <math.h>
+#include <string.h>
+
+// bands narrower than this are not worth a thread of their own
+#define MIN_BAND_ROWS 16
+// improvements smaller than this do not count as a change when testing for convergence
+#define SWEEP_EPSILON 1.0e-3
+
+namespace global_planner {
+
+SweepingExpansion::SweepingExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), travel_(NULL), scratch_(NULL), precise_(false), quadratic_(true), threads_(1),
+        pool_(NULL) {
+    setSize(nx, ny);
+}
+
+SweepingExpansion::~SweepingExpansion() {
+    if (travel_)
+        delete[] travel_;
+    if (scratch_)
+        delete[] scratch_;
+    if (pool_)
+        delete pool_;
+}
+
+//
+// Set/Reset map size
+//
+void SweepingExpansion::setSize(int xs, int ys) {
+    Expander::setSize(xs, ys);
+    if (travel_)
+        delete[] travel_;
+    travel_ = new float[ns_];
+    resizeBands();
+}
+
+void SweepingExpansion::setThreads(int threads) {
+    threads = std::max(1, threads);
+    if (threads != threads_) {
+        // the workers are started once here, not for every sweep
+        if (pool_)
+            delete pool_;
+        pool_ = threads > 1 ? new costmap_2d::WorkerPool(threads) : NULL;
+    }
+    threads_ = threads;
+    resizeBands();
+}
+
+//
+// Split the interior rows [1, ny-1) into an even number of bands,
+//   two per thread, so that even and odd bands can be swept in turn
+//
+void SweepingExpansion::resizeBands() {
+    int rows = std::max(0, ny_ - 2);
+    int bands = 2 * threads_;
+    while (bands > 2 && rows / bands < MIN_BAND_ROWS)
+        bands -= 2;
+    if (threads_ == 1 || rows / bands < MIN_BAND_ROWS)
+        bands = 1;
+
+    band_begin_.resize(bands + 1);
+    for (int b = 0; b <= bands; b++)
+        band_begin_[b] = 1 + (int)((long)rows * b / bands);
+    band_changed_.assign(bands, 0);
+
+    if (scratch_)
+        delete[] scratch_;
+    scratch_ = new float[std::max(1, (bands + 1) / 2) * nx_];
+}
+
+//
+// main propagation function
+// Fast Sweeping Method: Gauss-Seidel sweeps in the four diagonal orderings,
+//   repeated until no cell improves or <cycles> iterations have run
+//
+
+bool SweepingExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                            double end_y, int cycles, float* potential) {
+    cells_visited_ = 0;
+    std::fill(potential, potential + ns_, POT_HIGH);
+
+    // per-cell costs are looked up once instead of on every sweep
+    for (int i = 0; i < ns_; i++)
+        travel_[i] = getCost(costs, i);
+
+    // set goal
+    int k = toIndex(start_x, start_y);
+
+    if(precise_)
+    {
+        double dx = start_x - (int)start_x, dy = start_y - (int)start_y;
+        dx = floorf(dx * 100 + 0.5) / 100;
+        dy = floorf(dy * 100 + 0.5) / 100;
+        potential[k] = neutral_cost_ * 2 * dx * dy;
+        potential[k+1] = neutral_cost_ * 2 * (1-dx)*dy;
+        potential[k+nx_] = neutral_cost_*2*dx*(1-dy);
+        potential[k+nx_+1] = neutral_cost_*2*(1-dx)*(1-dy);
+    }else{
+        potential[k] = 0;
+    }
+
+    int bands = band_changed_.size();
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        bool changed = false;
+        if (bands == 1) {
+            sweepBand(potential, 0);
+            changed = band_changed_[0];
+        } else {
+            // even bands, then odd bands; bands of one parity never share a row boundary
+            for (int parity = 0; parity < 2; parity++)
+                pool_->run((bands - parity + 1) / 2,
+                           boost::bind(&SweepingExpansion::sweepParityBand, this, potential, parity, _1));
+            for (int b = 0; b < bands; b++)
+                changed = changed || band_changed_[b];
+        }
+        cells_visited_ += 4 * (nx_ - 2) * (ny_ - 2);
+
+        if (!changed)
+            break;
+    }
+
+    return potential[toIndex(end_x, end_y)] < POT_HIGH;
+}
+
+void SweepingExpansion::sweepBand(float* potential, int band) {
+    int row_begin = band_begin_[band], row_end = band_begin_[band + 1];
+    float* vertical = scratch_ + (band / 2) * nx_;
+    bool changed = false;
+
+    for (int dir = 0; dir < 4; dir++) {
+        bool forward_x = (dir & 1) == 0, forward_y = (dir & 2) == 0;
+        if (quadratic_)
+            changed |= sweep<true>(potential, vertical, row_begin, row_end, forward_x, forward_y);
+        else
+            changed |= sweep<false>(potential, vertical, row_begin, row_end, forward_x, forward_y);
+    }
+    band_changed_[band] = changed;
+}
+
+//
+// One sweep over rows [row_begin, row_end)
+// The vertical neighbours of a row do not change while the row is swept,
+//   so their minimum is computed for the whole row in a branch-free loop first;
+//   only the horizontal dependency is resolved cell by cell
+// The local update is the same as QuadraticCalculator/PotentialCalculator
+//
+
+template<bool quadratic>
+bool SweepingExpansion::sweep(float* potential, float* vertical, int row_begin, int row_end, bool forward_x,
+                              bool forward_y) {
+    bool changed = false;
+    int step = forward_x ? 1 : -1;
+
+    for (int r = row_begin; r < row_end; r++) {
+        int y = forward_y ? r : row_begin + row_end - 1 - r;
+        float* pot = potential + y * nx_;
+        const float* up = pot - nx_;
+        const float* down = pot + nx_;
+        const float* travel = travel_ + y * nx_;
+
+        for (int x = 0; x < nx_; x++)
+            vertical[x] = std::min(up[x], down[x]);
+
+        int x = forward_x ? 1 : nx_ - 2;
+        for (int i = 1; i < nx_ - 1; i++, x += step) {
+            float hf = travel[x];
+            if (hf >= lethal_cost_)    // don't propagate into obstacles
+                continue;
+
+            float ta = vertical[x];
+            float tc = std::min(pot[x - 1], pot[x + 1]);
+            float v;
+            if (quadratic) {
+                float dc = tc - ta;
+                if (dc < 0) {
+                    dc = -dc;
+                    ta = tc;
+                }
+                if (dc >= hf)
+                    v = ta + hf;
+                else {
+                    float d = dc / hf;
+                    v = ta + hf * (-0.2301 * d * d + 0.5307 * d + 0.7040);
+                }
+            } else {
+                v = std::min(ta, tc) + hf;
+            }
+
+            if (v < pot[x]) {
+                if (pot[x] - v > SWEEP_EPSILON)
+                    changed = true;
+                pot[x] = v;
+            }
+        }
+    }
+    return changed;
+}
+
+} //end namespace global_planner
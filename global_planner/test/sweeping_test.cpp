@@ -0,0 +1,87 @@
+/*
+ * sweeping_test.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <global_planner/dijkstra.h>
+#include <global_planner/quadratic_calculator.h>
+#include <global_planner/sweeping.h>
+
+namespace global_planner {
+
+static const int NX = 120, NY = 100;
+
+// a map with a lethal outline like the planner draws, a wall with a gap and a patch of higher costs
+static std::vector<unsigned char> makeCosts() {
+    std::vector<unsigned char> costs(NX * NY, 0);
+    for (int y = 0; y < NY; y++) {
+        for (int x = 0; x < NX; x++) {
+            if (x == 0 || y == 0 || x == NX - 1 || y == NY - 1)
+                costs[x + NX * y] = 254;
+            else if (x == 60 && y < 70)
+                costs[x + NX * y] = 254;
+            else if (x > 20 && x < 40 && y > 30 && y < 60)
+                costs[x + NX * y] = 120;
+        }
+    }
+    return costs;
+}
+
+TEST(SweepingExpansion, matches_dijkstra) {
+    std::vector<unsigned char> costs = makeCosts();
+    QuadraticCalculator calc(NX, NY);
+    std::vector<float> dijkstra_potential(NX * NY), sweeping_potential(NX * NY);
+
+    // the planner sizes the expanders before each plan, dijkstra only allocates its buffers then
+    DijkstraExpansion dijkstra(&calc, NX, NY);
+    dijkstra.setSize(NX, NY);
+    SweepingExpansion sweeping(&calc, NX, NY);
+    ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 10, 10, 100, 20, NX * NY * 2, &dijkstra_potential[0]));
+    ASSERT_TRUE(sweeping.calculatePotentials(&costs[0], 10, 10, 100, 20, NX * NY * 2, &sweeping_potential[0]));
+
+    // dijkstra stops once it reaches the end; its thresholded wavefront may settle a cell before its
+    // best neighbour, so the sweep, which iterates to the fixed point, can only be a little lower
+    int reached = 0;
+    for (int i = 0; i < NX * NY; i++) {
+        if (dijkstra_potential[i] >= POT_HIGH)
+            continue;
+        reached++;
+        ASSERT_LT(sweeping_potential[i], POT_HIGH);
+        EXPECT_LE(sweeping_potential[i], dijkstra_potential[i] + 0.01) << "cell " << i;
+        EXPECT_GE(sweeping_potential[i], 0.95 * dijkstra_potential[i]) << "cell " << i;
+    }
+    EXPECT_GT(reached, NX * NY / 2);
+
+    // the same for cells that cannot be reached at all
+    EXPECT_GE(sweeping_potential[60 + NX * 30], POT_HIGH);
+}
+
+TEST(SweepingExpansion, threads_give_the_same_potential) {
+    std::vector<unsigned char> costs = makeCosts();
+    QuadraticCalculator calc(NX, NY);
+    std::vector<float> serial_potential(NX * NY), parallel_potential(NX * NY);
+
+    SweepingExpansion sweeping(&calc, NX, NY);
+    ASSERT_TRUE(sweeping.calculatePotentials(&costs[0], 10, 10, 100, 20, NX * NY, &serial_potential[0]));
+
+    // plan twice with the same pool
+    sweeping.setThreads(3);
+    for (int run = 0; run < 2; run++) {
+        ASSERT_TRUE(sweeping.calculatePotentials(&costs[0], 10, 10, 100, 20, NX * NY, &parallel_potential[0]));
+        for (int i = 0; i < NX * NY; i++) {
+            if (serial_potential[i] >= POT_HIGH)
+                EXPECT_GE(parallel_potential[i], POT_HIGH);
+            else
+                EXPECT_NEAR(serial_potential[i], parallel_potential[i], 1e-3 * serial_potential[i] + 0.1);
+        }
+    }
+}
+
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
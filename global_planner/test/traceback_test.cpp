@@ -0,0 +1,85 @@
+/*
+ * traceback_test.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <global_planner/grid_path.h>
+#include <global_planner/planner_core.h>
+#include <global_planner/potential_calculator.h>
+
+namespace global_planner {
+
+static const int NX = 40, NY = 30;
+
+// the potential of a wavefront started at (sx, sy), with an unreached outline like the planner's
+static std::vector<float> makePotential(int sx, int sy) {
+    std::vector<float> potential(NX * NY, POT_HIGH);
+    for (int y = 1; y < NY - 1; y++)
+        for (int x = 1; x < NX - 1; x++)
+            potential[x + NX * y] = std::sqrt((float)((x - sx) * (x - sx) + (y - sy) * (y - sy)));
+    return potential;
+}
+
+TEST(GridPath, descends_to_the_start) {
+    PotentialCalculator calc(NX, NY);
+    GridPath path_maker(&calc);
+    path_maker.setSize(NX, NY);
+    std::vector<float> potential = makePotential(5, 5);
+
+    std::vector<std::pair<float, float> > path;
+    ASSERT_TRUE(path_maker.getPath(&potential[0], 5.3, 5.7, 30, 20, path));
+    ASSERT_EQ(26u, path.size());
+    EXPECT_EQ(30.0f, path.front().first);
+    EXPECT_EQ(20.0f, path.front().second);
+    EXPECT_FLOAT_EQ(5.3f, path.back().first);
+    EXPECT_FLOAT_EQ(5.7f, path.back().second);
+}
+
+TEST(GridPath, gives_up_after_max_steps) {
+    PotentialCalculator calc(NX, NY);
+    GridPath path_maker(&calc);
+    path_maker.setSize(NX, NY);
+    path_maker.setMaxSteps(10);
+    std::vector<float> potential = makePotential(5, 5);
+
+    std::vector<std::pair<float, float> > path;
+    EXPECT_FALSE(path_maker.getPath(&potential[0], 5, 5, 30, 20, path));
+    EXPECT_EQ(11u, path.size());
+
+    // a budget that covers the path is enough
+    path.clear();
+    path_maker.setMaxSteps(25);
+    EXPECT_TRUE(path_maker.getPath(&potential[0], 5, 5, 30, 20, path));
+}
+
+TEST(GridPath, does_not_loop_on_a_plateau) {
+    PotentialCalculator calc(NX, NY);
+    GridPath path_maker(&calc);
+    path_maker.setSize(NX, NY);
+
+    // nothing descends towards the start, the walk can only wander over unvisited cells
+    std::vector<float> potential(NX * NY, 1.0f);
+    std::vector<std::pair<float, float> > path;
+    EXPECT_FALSE(path_maker.getPath(&potential[0], 5, 5, 30, 20, path));
+    EXPECT_LE(path.size(), (unsigned int)(NX * NY));
+
+    // every cell of the path is distinct
+    for (unsigned int i = 0; i < path.size(); i++)
+        for (unsigned int j = i + 1; j < path.size(); j++)
+            ASSERT_FALSE(path[i] == path[j]) << "cell visited twice at " << i << " and " << j;
+
+    // the visited set is cleared between calls
+    std::vector<float> descent = makePotential(5, 5);
+    path.clear();
+    EXPECT_TRUE(path_maker.getPath(&descent[0], 5, 5, 30, 20, path));
+}
+
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
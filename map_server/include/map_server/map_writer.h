@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2008, Willow Garage, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef MAP_SERVER_MAP_WRITER_H
+#define MAP_SERVER_MAP_WRITER_H
+
+#include <string>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include "nav_msgs/OccupancyGrid.h"
+
+namespace map_server
+{
+
+class WorkerPool;
+
+/**
+ * @brief Writes occupancy grids as PGM images and updates tiles of them in place.
+ *
+ * The conversion is split over a fixed set of threads that is started once, so
+ * writing the map again, e.g. every few seconds while mapping, does not start
+ * new threads each time. Failures are reported with ROS_ERROR.
+ */
+class MapWriter
+{
+  public:
+    /**
+     * @param threads The number of threads converting the map, including the caller
+     * @param tile_size The side of the square tiles writeTiles() works on, in cells
+     */
+    MapWriter(unsigned int threads, unsigned int tile_size);
+    ~MapWriter();
+
+    /**
+     * @brief Writes the whole map to mapdatafile, replacing it
+     * @return false if the file could not be written completely
+     */
+    bool writeImage(const std::string& mapdatafile, const nav_msgs::OccupancyGrid& map);
+
+    /**
+     * @brief Rewrites the given tiles of an image that writeImage() last wrote for a
+     * map of the same size, in place
+     * @param tiles Tile indices, row major with tiles of tile_size cells starting at cell (0, 0)
+     * @return false if a tile could not be written
+     */
+    bool writeTiles(const std::string& mapdatafile, const nav_msgs::OccupancyGrid& map,
+                    const std::vector<unsigned int>& tiles);
+
+    unsigned int getTileSize() const
+    {
+      return tile_size_;
+    }
+
+  private:
+    /**
+     * @brief Converts image rows [y0, y1) into out, image row 0 is the top row of the map
+     */
+    void convertRows(const nav_msgs::OccupancyGrid* map, unsigned int y0, unsigned int y1, unsigned char* out);
+
+    /**
+     * @brief Converts the band-th group of BAND_ROWS rows starting at image row y
+     */
+    void convertBand(const nav_msgs::OccupancyGrid* map, unsigned int y, unsigned int y_end, unsigned char* out,
+                     unsigned int band);
+
+    /**
+     * @brief Writes every threads-th tile of tiles, starting at first, and records in
+     * failed[first] whether a write fell short
+     */
+    void writeTileShare(int fd, const nav_msgs::OccupancyGrid* map, const std::vector<unsigned int>* tiles,
+                        std::vector<char>* failed, unsigned int first);
+
+    unsigned int threads_, tile_size_;
+    long header_size_;
+    unsigned char pixel_[256]; ///< PGM value for each occupancy value
+    boost::scoped_ptr<WorkerPool> pool_;
+};
+
+}
+
+#endif
@@ -29,26 +29,41 @@
  */
 
 #include <cstdio>
+#include <cstring>
+#include <vector>
+#include <set>
+#include <boost/thread.hpp>
 #include "ros/ros.h"
 #include "ros/console.h"
 #include "nav_msgs/GetMap.h"
+#include "map_msgs/OccupancyGridUpdate.h"
+#include "map_server/map_writer.h"
 #include "tf/LinearMath/Matrix3x3.h"
 #include "geometry_msgs/Quaternion.h"
 
 using namespace std;
- 
+
 /**
  * @brief Map generation node.
+ *
+ * The PGM is written by a map_server::MapWriter, which converts it on several
+ * threads. In follow mode the node keeps the map in memory, applies
+ * OccupancyGridUpdate messages to it, and periodically rewrites only the tiles
+ * that changed in place in the PGM, so a long mapping session can be saved
+ * incrementally.
  */
 class MapGenerator 
 {
 
   public:
-    MapGenerator(const std::string& mapname) : mapname_(mapname), saved_map_(false)
+    MapGenerator(const std::string& mapname, bool follow, unsigned int tile_size, unsigned int threads) :
+        mapname_(mapname), saved_map_(false), follow_(follow), writer_(threads, tile_size), data_(NULL)
     {
       ros::NodeHandle n;
       ROS_INFO("Waiting for the map");
       map_sub_ = n.subscribe("map", 1, &MapGenerator::mapCallback, this);
+      if (follow_)
+        update_sub_ = n.subscribe("map_updates", 100, &MapGenerator::updateCallback, this);
     }
 
     void mapCallback(const nav_msgs::OccupancyGridConstPtr& map)
@@ -58,33 +73,20 @@ class MapGenerator
                map->info.height,
                map->info.resolution);
 
+      map_ = map;
+      if (follow_)
+      {
+        //keep a copy that updates can be applied to
+        nav_msgs::OccupancyGrid* copy = new nav_msgs::OccupancyGrid(*map);
+        map_.reset(copy);
+        data_ = &copy->data[0];
+      }
+      dirty_tiles_.clear();
 
       std::string mapdatafile = mapname_ + ".pgm";
       ROS_INFO("Writing map occupancy data to %s", mapdatafile.c_str());
-      FILE* out = fopen(mapdatafile.c_str(), "w");
-      if (!out)
-      {
-        ROS_ERROR("Couldn't save map file to %s", mapdatafile.c_str());
+      if (!writer_.writeImage(mapdatafile, *map_))
         return;
-      }
-
-      fprintf(out, "P5\n# CREATOR: Map_generator.cpp %.3f m/pix\n%d %d\n255\n",
-              map->info.resolution, map->info.width, map->info.height);
-      for(unsigned int y = 0; y < map->info.height; y++) {
-        for(unsigned int x = 0; x < map->info.width; x++) {
-          unsigned int i = x + (map->info.height - y - 1) * map->info.width;
-          if (map->data[i] == 0) { //occ [0,0.1)
-            fputc(254, out);
-          } else if (map->data[i] == +100) { //occ (0.65,1]
-            fputc(000, out);
-          } else { //occ [0.1,0.65]
-            fputc(205, out);
-          }
-        }
-      }
-
-      fclose(out);
-
 
       std::string mapmetadatafile = mapname_ + ".yaml";
       ROS_INFO("Writing map occupancy data to %s", mapmetadatafile.c_str());
@@ -115,20 +117,73 @@ free_thresh: 0.196
       saved_map_ = true;
     }
 
+    void updateCallback(const map_msgs::OccupancyGridUpdateConstPtr& update)
+    {
+      if (!map_)
+        return;
+
+      unsigned int width = map_->info.width, height = map_->info.height;
+      if (update->x < 0 || update->y < 0 || update->x + update->width > width || update->y + update->height > height)
+      {
+        ROS_WARN("Dropping a map update that does not fit into the %d X %d map", width, height);
+        return;
+      }
+      if (update->width == 0 || update->height == 0)
+        return;
+
+      for (unsigned int y = 0; y < update->height; y++)
+        memcpy(data_ + (update->y + y) * width + update->x, &update->data[y * update->width], update->width);
+
+      unsigned int tile_size = writer_.getTileSize();
+      unsigned int tiles_x = (width + tile_size - 1) / tile_size;
+      for (unsigned int ty = update->y / tile_size; ty <= (update->y + update->height - 1) / tile_size; ty++)
+        for (unsigned int tx = update->x / tile_size; tx <= (update->x + update->width - 1) / tile_size; tx++)
+          dirty_tiles_.insert(ty * tiles_x + tx);
+    }
+
+    /**
+     * @brief Rewrites the tiles touched by updates since the last save in place
+     */
+    void saveDirtyTiles()
+    {
+      if (dirty_tiles_.empty() || !saved_map_)
+        return;
+
+      std::string mapdatafile = mapname_ + ".pgm";
+      std::vector<unsigned int> tiles(dirty_tiles_.begin(), dirty_tiles_.end());
+      //keep the tiles dirty so that the next save tries them again
+      if (!writer_.writeTiles(mapdatafile, *map_, tiles))
+        return;
+
+      dirty_tiles_.clear();
+      ROS_DEBUG("Updated %d tiles of %s", (int)tiles.size(), mapdatafile.c_str());
+    }
+
     std::string mapname_;
-    ros::Subscriber map_sub_;
+    ros::Subscriber map_sub_, update_sub_;
     bool saved_map_;
 
+  private:
+    bool follow_;
+    map_server::MapWriter writer_;
+    nav_msgs::OccupancyGridConstPtr map_;
+    int8_t* data_; ///< writable data of map_ in follow mode
+    std::set<unsigned int> dirty_tiles_;
+
 };
 
 #define USAGE "Usage: \n" \
               "  map_saver -h\n"\
-              "  map_saver [-f <mapname>] [ROS remapping args]"
+              "  map_saver [-f <mapname>] [-j <threads>] [--follow [-i <seconds>] [-t <tile size>]] [ROS remapping args]"
 
 int main(int argc, char** argv) 
 {
   ros::init(argc, argv, "map_saver");
   std::string mapname = "map";
+  bool follow = false;
+  double interval = 5.0;
+  unsigned int tile_size = 256;
+  unsigned int threads = boost::thread::hardware_concurrency();
 
   for(int i=1; i<argc; i++)
   {
@@ -137,15 +192,35 @@ int main(int argc, char** argv)
       puts(USAGE);
       return 0;
     }
-    else if(!strcmp(argv[i], "-f"))
+    else if(!strcmp(argv[i], "--follow"))
     {
-      if(++i < argc)
-        mapname = argv[i];
-      else
+      follow = true;
+    }
+    else if(!strcmp(argv[i], "-f") || !strcmp(argv[i], "-j") || !strcmp(argv[i], "-i") || !strcmp(argv[i], "-t"))
+    {
+      if(i + 1 >= argc)
       {
         puts(USAGE);
         return 1;
       }
+      const char* option = argv[i++];
+      if(!strcmp(option, "-f"))
+        mapname = argv[i];
+      else if(!strcmp(option, "-i"))
+        interval = atof(argv[i]);
+      else
+      {
+        int value = atoi(argv[i]);
+        if(value <= 0)
+        {
+          ROS_ERROR("%s must be a positive number, got %s", option, argv[i]);
+          return 1;
+        }
+        if(!strcmp(option, "-j"))
+          threads = value;
+        else
+          tile_size = value;
+      }
     }
     else
     {
@@ -154,10 +229,28 @@ int main(int argc, char** argv)
     }
   }
   
-  MapGenerator mg(mapname);
+  MapGenerator mg(mapname, follow, tile_size, threads);
 
-  while(!mg.saved_map_)
+  if(!follow)
+  {
+    while(!mg.saved_map_)
+      ros::spinOnce();
+    return 0;
+  }
+
+  //keep applying updates and save the changed tiles every interval until shut down
+  ros::WallTime last_save = ros::WallTime::now();
+  while(ros::ok())
+  {
     ros::spinOnce();
+    if((ros::WallTime::now() - last_save).toSec() >= interval)
+    {
+      mg.saveDirtyTiles();
+      last_save = ros::WallTime::now();
+    }
+    ros::WallDuration(0.01).sleep();
+  }
+  mg.saveDirtyTiles();
 
   return 0;
 }
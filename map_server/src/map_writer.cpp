@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2008, Willow Garage, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include "ros/console.h"
+#include "map_server/map_writer.h"
+
+// rows converted by one thread before its band is written out
+#define BAND_ROWS 64
+
+namespace map_server
+{
+
+/**
+ * @brief A fixed set of threads that run the parts of one job at a time, like
+ * costmap_2d::WorkerPool. run() returns once every part is done.
+ */
+class WorkerPool
+{
+  public:
+    typedef boost::function<void(unsigned int)> Job;
+
+    explicit WorkerPool(unsigned int threads) :
+        parts_(0), next_part_(0), generation_(0), busy_(0), shutdown_(false)
+    {
+      for (unsigned int i = 1; i < threads; i++)
+        workers_.create_thread(boost::bind(&WorkerPool::workerLoop, this));
+    }
+
+    ~WorkerPool()
+    {
+      {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        shutdown_ = true;
+      }
+      work_ready_.notify_all();
+      workers_.join_all();
+    }
+
+    /**
+     * @brief Calls job(i) for every i in [0, parts) and waits until all calls returned
+     */
+    void run(unsigned int parts, const Job& job)
+    {
+      if (workers_.size() == 0 || parts <= 1)
+      {
+        for (unsigned int i = 0; i < parts; i++)
+          job(i);
+        return;
+      }
+
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      job_ = job;
+      parts_ = parts;
+      next_part_ = 0;
+      busy_ = workers_.size();
+      ++generation_;
+      work_ready_.notify_all();
+
+      runParts(lock);
+      while (busy_ > 0)
+        work_done_.wait(lock);
+      job_ = Job();
+    }
+
+  private:
+    void workerLoop()
+    {
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      unsigned int seen = 0;
+      while (true)
+      {
+        while (generation_ == seen && !shutdown_)
+          work_ready_.wait(lock);
+        if (shutdown_)
+          return;
+        seen = generation_;
+
+        runParts(lock);
+        if (--busy_ == 0)
+          work_done_.notify_one();
+      }
+    }
+
+    void runParts(boost::unique_lock<boost::mutex>& lock)
+    {
+      while (next_part_ < parts_)
+      {
+        unsigned int part = next_part_++;
+        lock.unlock();
+        job_(part);
+        lock.lock();
+      }
+    }
+
+    boost::thread_group workers_;
+    boost::mutex mutex_;
+    boost::condition_variable work_ready_, work_done_;
+    Job job_;
+    unsigned int parts_, next_part_, generation_, busy_;
+    bool shutdown_;
+};
+
+MapWriter::MapWriter(unsigned int threads, unsigned int tile_size) :
+    threads_(std::max(threads, 1u)), tile_size_(tile_size > 0 ? tile_size : 256), header_size_(0),
+    pool_(new WorkerPool(threads_))
+{
+  for (int v = -128; v < 128; v++)
+  {
+    if (v == 0) //occ [0,0.1)
+      pixel_[(unsigned char)v] = 254;
+    else if (v == +100) //occ (0.65,1]
+      pixel_[(unsigned char)v] = 000;
+    else //occ [0.1,0.65]
+      pixel_[(unsigned char)v] = 205;
+  }
+}
+
+MapWriter::~MapWriter()
+{
+}
+
+bool MapWriter::writeImage(const std::string& mapdatafile, const nav_msgs::OccupancyGrid& map)
+{
+  unsigned int width = map.info.width, height = map.info.height;
+  FILE* out = fopen(mapdatafile.c_str(), "w");
+  if (!out)
+  {
+    ROS_ERROR("Couldn't save map file to %s", mapdatafile.c_str());
+    return false;
+  }
+
+  int header_size = fprintf(out, "P5\n# CREATOR: Map_generator.cpp %.3f m/pix\n%d %d\n255\n",
+                            map.info.resolution, width, height);
+  bool ok = header_size > 0;
+  header_size_ = header_size;
+
+  //the threads convert one band each, then the whole group is written in order
+  unsigned int group_rows = BAND_ROWS * threads_;
+  std::vector<unsigned char> buffer((size_t)group_rows * width);
+  for (unsigned int y = 0; ok && y < height; y += group_rows)
+  {
+    unsigned int group_end = std::min(height, y + group_rows);
+    pool_->run((group_end - y + BAND_ROWS - 1) / BAND_ROWS,
+               boost::bind(&MapWriter::convertBand, this, &map, y, group_end, &buffer[0], _1));
+
+    size_t size = (size_t)(group_end - y) * width;
+    ok = fwrite(&buffer[0], 1, size, out) == size;
+  }
+
+  if (fclose(out) != 0)
+    ok = false;
+  if (!ok)
+    ROS_ERROR("Failed to write the map to %s", mapdatafile.c_str());
+  return ok;
+}
+
+bool MapWriter::writeTiles(const std::string& mapdatafile, const nav_msgs::OccupancyGrid& map,
+                           const std::vector<unsigned int>& tiles)
+{
+  int fd = open(mapdatafile.c_str(), O_WRONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR("Couldn't update map file %s", mapdatafile.c_str());
+    return false;
+  }
+
+  std::vector<char> failed(threads_, 0);
+  pool_->run(threads_, boost::bind(&MapWriter::writeTileShare, this, fd, &map, &tiles, &failed, _1));
+
+  bool ok = std::find(failed.begin(), failed.end(), 1) == failed.end();
+  if (close(fd) != 0)
+    ok = false;
+  if (!ok)
+    ROS_ERROR("Failed to update the tiles of map file %s", mapdatafile.c_str());
+  return ok;
+}
+
+void MapWriter::convertRows(const nav_msgs::OccupancyGrid* map, unsigned int y0, unsigned int y1,
+                            unsigned char* out)
+{
+  unsigned int width = map->info.width, height = map->info.height;
+  const int8_t* data = &map->data[0];
+  for (unsigned int y = y0; y < y1; y++)
+  {
+    const int8_t* row = data + (height - y - 1) * width;
+    for (unsigned int x = 0; x < width; x++)
+      *out++ = pixel_[(unsigned char)row[x]];
+  }
+}
+
+void MapWriter::convertBand(const nav_msgs::OccupancyGrid* map, unsigned int y, unsigned int y_end,
+                            unsigned char* out, unsigned int band)
+{
+  unsigned int y0 = y + band * BAND_ROWS;
+  convertRows(map, y0, std::min(y_end, y0 + BAND_ROWS), out + (size_t)band * BAND_ROWS * map->info.width);
+}
+
+void MapWriter::writeTileShare(int fd, const nav_msgs::OccupancyGrid* map, const std::vector<unsigned int>* tiles,
+                               std::vector<char>* failed, unsigned int first)
+{
+  unsigned int width = map->info.width, height = map->info.height;
+  unsigned int tiles_x = (width + tile_size_ - 1) / tile_size_;
+  const int8_t* data = &map->data[0];
+  std::vector<unsigned char> row(tile_size_);
+
+  for (unsigned int t = first; t < tiles->size(); t += threads_)
+  {
+    unsigned int x0 = ((*tiles)[t] % tiles_x) * tile_size_, y0 = ((*tiles)[t] / tiles_x) * tile_size_;
+    unsigned int x1 = std::min(width, x0 + tile_size_), y1 = std::min(height, y0 + tile_size_);
+    for (unsigned int y = y0; y < y1; y++)
+    {
+      const int8_t* cells = data + y * width;
+      for (unsigned int x = x0; x < x1; x++)
+        row[x - x0] = pixel_[(unsigned char)cells[x]];
+
+      off_t offset = header_size_ + (off_t)(height - y - 1) * width + x0;
+      if (pwrite(fd, &row[0], x1 - x0, offset) != (ssize_t)(x1 - x0))
+        (*failed)[first] = 1;
+    }
+  }
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * map_writer_test.cpp
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "map_server/image_loader.h"
+#include "map_server/map_writer.h"
+
+static const unsigned int WIDTH = 150, HEIGHT = 100, TILE = 32;
+
+// free, occupied and unknown stripes
+static nav_msgs::OccupancyGrid makeMap()
+{
+  nav_msgs::OccupancyGrid map;
+  map.info.resolution = 0.05;
+  map.info.width = WIDTH;
+  map.info.height = HEIGHT;
+  map.data.resize(WIDTH * HEIGHT);
+  static const int8_t values[3] = { 0, 100, -1 };
+  for (unsigned int y = 0; y < HEIGHT; y++)
+    for (unsigned int x = 0; x < WIDTH; x++)
+      map.data[y * WIDTH + x] = values[(x / 7 + y / 5) % 3];
+  return map;
+}
+
+// turns free cells occupied and everything else free
+static void flip(nav_msgs::OccupancyGrid& map, unsigned int x, unsigned int y)
+{
+  int8_t& cell = map.data[y * WIDTH + x];
+  cell = cell == 0 ? 100 : 0;
+}
+
+static void expectSavedMap(const nav_msgs::OccupancyGrid& expected, const std::string& file)
+{
+  nav_msgs::GetMap::Response resp;
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  // the thresholds map_saver writes into the yaml file
+  map_server::loadMapFromFile(&resp, file.c_str(), 0.05, false, 0.65, 0.196, origin);
+  ASSERT_EQ(WIDTH, resp.map.info.width);
+  ASSERT_EQ(HEIGHT, resp.map.info.height);
+  for (unsigned int i = 0; i < WIDTH * HEIGHT; i++)
+    ASSERT_EQ(expected.data[i], resp.map.data[i]) << "at cell " << i % WIDTH << ", " << i / WIDTH;
+}
+
+TEST(MapWriter, rewrites_dirty_tiles_in_place)
+{
+  std::string file = "map_writer_test.pgm";
+  nav_msgs::OccupancyGrid map = makeMap();
+  map_server::MapWriter writer(3, TILE);
+  ASSERT_TRUE(writer.writeImage(file, map));
+  expectSavedMap(map, file);
+
+  // 5 x 4 tiles, the last column and row of them cut short by the map
+  flip(map, 10, 5);
+  flip(map, 149, 40);
+  flip(map, 70, 99);
+  flip(map, 71, 99);
+  std::vector<unsigned int> tiles;
+  tiles.push_back(0);
+  tiles.push_back(1 * 5 + 4);
+  tiles.push_back(3 * 5 + 2);
+  ASSERT_TRUE(writer.writeTiles(file, map, tiles));
+  expectSavedMap(map, file);
+
+  // a change outside the given tiles is not written
+  nav_msgs::OccupancyGrid saved = map;
+  flip(map, 100, 70);
+  tiles.resize(1);
+  ASSERT_TRUE(writer.writeTiles(file, map, tiles));
+  expectSavedMap(saved, file);
+
+  remove(file.c_str());
+}
+
+TEST(MapWriter, reports_failed_writes)
+{
+  nav_msgs::OccupancyGrid map = makeMap();
+  map_server::MapWriter writer(2, TILE);
+  EXPECT_FALSE(writer.writeImage("/dev/full", map));
+  EXPECT_FALSE(writer.writeImage("no_such_directory/map.pgm", map));
+  EXPECT_FALSE(writer.writeTiles("no_such_directory/map.pgm", map, std::vector<unsigned int>(1, 0)));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -48,6 +48,8 @@
 #include <nav_core/base_local_planner.h>
 #include <nav_core/base_global_planner.h>
 #include <nav_core/recovery_behavior.h>
+#include <base_local_planner/oscillation_history.h>
+#include <base_local_planner/path_validity_checker.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <costmap_2d/costmap_2d_ros.h>
 #include <costmap_2d/costmap_2d.h>
@@ -156,6 +158,18 @@ namespace move_base {
        */
       void resetState();
 
+      /**
+       * @brief  Access to state_, which plannerCostmapUpdated reads from the costmap update thread
+       */
+      void setState(MoveBaseState state);
+      MoveBaseState getState();
+
+      /**
+       * @brief  Re-checks the current plan where the planner's costmap changed, and asks for
+       * a new plan as soon as it is blocked
+       */
+      void plannerCostmapUpdated(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn);
+
       void goalCB(const geometry_msgs::PoseStamped::ConstPtr& goal);
 
       void planThread();
@@ -192,10 +206,13 @@ namespace move_base {
       double oscillation_timeout_, oscillation_distance_;
 
       MoveBaseState state_;
+      boost::mutex state_mutex_;
       RecoveryTrigger recovery_trigger_;
 
       ros::Time last_valid_plan_, last_valid_control_, last_oscillation_reset_;
-      geometry_msgs::PoseStamped oscillation_pose_;
+      base_local_planner::OscillationHistory oscillation_history_;
+      base_local_planner::PathValidityChecker plan_checker_;
+      bool check_plan_validity_;
       pluginlib::ClassLoader<nav_core::BaseGlobalPlanner> bgp_loader_;
       pluginlib::ClassLoader<nav_core::BaseLocalPlanner> blp_loader_;
       pluginlib::ClassLoader<nav_core::RecoveryBehavior> recovery_loader_;
@@ -222,6 +239,9 @@ namespace move_base {
       move_base::MoveBaseConfig default_config_;
       bool setup_, p_freq_change_, c_freq_change_;
       bool new_global_plan_;
+
+      boost::shared_ptr<nav_core::SpeedLimit> speed_limit_; ///< @brief Shared with the local planner and recovery behaviors
+      bool speed_limit_honored_; ///< @brief Whether the current local planner reads speed_limit_
   };
 };
 #endif
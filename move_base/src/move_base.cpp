@@ -53,7 +53,8 @@ namespace move_base {
     blp_loader_("nav_core", "nav_core::BaseLocalPlanner"), 
     recovery_loader_("nav_core", "nav_core::RecoveryBehavior"),
     planner_plan_(NULL), latest_plan_(NULL), controller_plan_(NULL),
-    runPlanner_(false), setup_(false), p_freq_change_(false), c_freq_change_(false), new_global_plan_(false) {
+    runPlanner_(false), setup_(false), p_freq_change_(false), c_freq_change_(false), new_global_plan_(false),
+    speed_limit_(new nav_core::SpeedLimit()), speed_limit_honored_(false) {
 
     as_ = new MoveBaseActionServer(ros::NodeHandle(), "move_base", boost::bind(&MoveBase::executeCb, this, _1), false);
 
@@ -158,6 +159,7 @@ namespace move_base {
       tc_ = blp_loader_.createInstance(local_planner);
       ROS_INFO("Created local_planner %s", local_planner.c_str());
       tc_->initialize(blp_loader_.getName(local_planner), &tf_, controller_costmap_ros_);
+      speed_limit_honored_ = tc_->setSpeedLimit(speed_limit_);
     } catch (const pluginlib::PluginlibException& ex)
     {
       ROS_FATAL("Failed to create the %s planner, are you sure it is properly registered and that the containing library is built? Exception: %s", local_planner.c_str(), ex.what());
@@ -174,6 +176,12 @@ namespace move_base {
     //advertise a service for clearing the costmaps
     clear_costmaps_srv_ = private_nh.advertiseService("clear_costmaps", &MoveBase::clearCostmapsService, this);
 
+    //re-check the current plan after each update of the planner's costmap, so that a blocked
+    //plan gets replaced right away instead of at the next planning cycle
+    private_nh.param("check_plan_validity", check_plan_validity_, false);
+    if(check_plan_validity_)
+      planner_costmap_ros_->setUpdateCallback(boost::bind(&MoveBase::plannerCostmapUpdated, this, _1, _2, _3, _4));
+
     //if we shutdown our costmaps when we're deactivated... we'll do that now
     if(shutdown_costmaps_){
       ROS_DEBUG_NAMED("move_base","Stopping costmaps initially");
@@ -187,7 +195,7 @@ namespace move_base {
     }
 
     //initially, we'll need to make a plan
-    state_ = PLANNING;
+    setState(PLANNING);
 
     //we'll start executing recovery behaviors at the beginning of our list
     recovery_index_ = 0;
@@ -306,6 +314,10 @@ namespace move_base {
         controller_plan_->clear();
         resetState();
         tc_->initialize(blp_loader_.getName(config.base_local_planner), &tf_, controller_costmap_ros_);
+        bool honored = tc_->setSpeedLimit(speed_limit_);
+        if(!honored && speed_limit_honored_)
+          ROS_WARN("The new local planner ignores speed limits, recovery behaviors that slow the robot down through them will have no effect.");
+        speed_limit_honored_ = honored;
       } catch (const pluginlib::PluginlibException& ex)
       {
         ROS_FATAL("Failed to create the %s planner, are you sure it is properly registered and that the containing library is built? Exception: %s", config.base_local_planner.c_str(), ex.what());
@@ -327,62 +339,15 @@ namespace move_base {
   }
 
   void MoveBase::clearCostmapWindows(double size_x, double size_y){
-    tf::Stamped<tf::Pose> global_pose;
-
-    //clear the planner's costmap
-    planner_costmap_ros_->getRobotPose(global_pose);
-
-    std::vector<geometry_msgs::Point> clear_poly;
-    double x = global_pose.getOrigin().x();
-    double y = global_pose.getOrigin().y();
-    geometry_msgs::Point pt;
-
-    pt.x = x - size_x / 2;
-    pt.y = y - size_x / 2;
-    clear_poly.push_back(pt);
-
-    pt.x = x + size_x / 2;
-    pt.y = y - size_x / 2;
-    clear_poly.push_back(pt);
-
-    pt.x = x + size_x / 2;
-    pt.y = y + size_x / 2;
-    clear_poly.push_back(pt);
-
-    pt.x = x - size_x / 2;
-    pt.y = y + size_x / 2;
-    clear_poly.push_back(pt);
-
-    planner_costmap_ros_->getCostmap()->setConvexPolygonCost(clear_poly, costmap_2d::FREE_SPACE);
-
-    //clear the controller's costmap
-    controller_costmap_ros_->getRobotPose(global_pose);
-
-    clear_poly.clear();
-    x = global_pose.getOrigin().x();
-    y = global_pose.getOrigin().y();
-
-    pt.x = x - size_x / 2;
-    pt.y = y - size_x / 2;
-    clear_poly.push_back(pt);
-
-    pt.x = x + size_x / 2;
-    pt.y = y - size_x / 2;
-    clear_poly.push_back(pt);
-
-    pt.x = x + size_x / 2;
-    pt.y = y + size_x / 2;
-    clear_poly.push_back(pt);
-
-    pt.x = x - size_x / 2;
-    pt.y = y + size_x / 2;
-    clear_poly.push_back(pt);
-
-    controller_costmap_ros_->getCostmap()->setConvexPolygonCost(clear_poly, costmap_2d::FREE_SPACE);
+    //mark the window around the robot free in both master grids, the layers keep what they
+    //have seen and the next update that covers the window brings it back
+    planner_costmap_ros_->clearMasterWindow(size_x, size_y);
+    controller_costmap_ros_->clearMasterWindow(size_x, size_y);
   }
 
   bool MoveBase::clearCostmapsService(std_srvs::Empty::Request &req, std_srvs::Empty::Response &resp){
-    //clear the costmaps
+    //clear the costmaps one after the other, resetting a static layer waits for its map
+    //by spinning, which must not happen on two threads at once
     planner_costmap_ros_->resetLayers();
     controller_costmap_ros_->resetLayers();
     return true;
@@ -485,8 +450,10 @@ namespace move_base {
     if(as_ != NULL)
       delete as_;
 
-    if(planner_costmap_ros_ != NULL)
+    if(planner_costmap_ros_ != NULL){
+      planner_costmap_ros_->setUpdateCallback(costmap_2d::Costmap2DROS::UpdateCallback());
       delete planner_costmap_ros_;
+    }
 
     if(controller_costmap_ros_ != NULL)
       delete controller_costmap_ros_;
@@ -638,20 +605,20 @@ namespace move_base {
 
         //make sure we only start the controller if we still haven't reached the goal
         if(runPlanner_)
-          state_ = CONTROLLING;
+          setState(CONTROLLING);
         if(planner_frequency_ <= 0)
           runPlanner_ = false;
         lock.unlock();
       }
       //if we didn't get a plan and we are in the planning state (the robot isn't moving)
-      else if(state_==PLANNING){
+      else if(getState() == PLANNING){
         ROS_DEBUG_NAMED("move_base_plan_thread","No Plan...");
         ros::Time attempt_end = last_valid_plan_ + ros::Duration(planner_patience_);
 
         //check if we've tried to make a plan for over our time limit
         if(ros::Time::now() > attempt_end){
           //we'll move into our obstacle clearing mode
-          state_ = CLEARING;
+          setState(CLEARING);
           publishZeroVelocity();
           recovery_trigger_ = PLANNING_R;
         }
@@ -720,7 +687,7 @@ namespace move_base {
 
           //we'll make sure that we reset our state for the next execution cycle
           recovery_index_ = 0;
-          state_ = PLANNING;
+          setState(PLANNING);
 
           //we have a new goal so make sure the planner is awake
           lock.lock();
@@ -757,7 +724,7 @@ namespace move_base {
 
         //we want to go back to the planning state for the next execution cycle
         recovery_index_ = 0;
-        state_ = PLANNING;
+        setState(PLANNING);
 
         //we have a new goal so make sure the planner is awake
         lock.lock();
@@ -793,7 +760,7 @@ namespace move_base {
 
       r.sleep();
       //make sure to sleep for the remainder of our cycle time
-      if(r.cycleTime() > ros::Duration(1 / controller_frequency_) && state_ == CONTROLLING)
+      if(r.cycleTime() > ros::Duration(1 / controller_frequency_) && getState() == CONTROLLING)
         ROS_WARN("Control loop missed its desired rate of %.4fHz... the loop actually took %.4f seconds", controller_frequency_, r.cycleTime().toSec());
     }
 
@@ -829,11 +796,17 @@ namespace move_base {
     feedback.base_position = current_position;
     as_->publishFeedback(feedback);
 
+    Eigen::Vector3f current_pos(global_pose.getOrigin().x(), global_pose.getOrigin().y(),
+        tf::getYaw(global_pose.getRotation()));
+
+    if(check_plan_validity_)
+      plan_checker_.updateProgress(current_pos[0], current_pos[1]);
+
     //check to see if we've moved far enough to reset our oscillation timeout
-    if(distance(current_position, oscillation_pose_) >= oscillation_distance_)
+    if(oscillation_history_.progressDistance(current_pos) >= oscillation_distance_)
     {
       last_oscillation_reset_ = ros::Time::now();
-      oscillation_pose_ = current_position;
+      oscillation_history_.setProgressPose(current_pos);
 
       //if our last recovery was caused by oscillation, we want to reset the recovery index 
       if(recovery_trigger_ == OSCILLATION_R)
@@ -877,13 +850,16 @@ namespace move_base {
         return true;
       }
 
+      if(check_plan_validity_)
+        plan_checker_.setPlan(*controller_plan_, *planner_costmap_ros_->getCostmap());
+
       //make sure to reset recovery_index_ since we were able to find a valid plan
       if(recovery_trigger_ == PLANNING_R)
         recovery_index_ = 0;
     }
 
     //the move_base state machine, handles the control logic for navigation
-    switch(state_){
+    switch(getState()){
       //if we are in a planning state, then we'll attempt to make a plan
       case PLANNING:
         {
@@ -916,8 +892,11 @@ namespace move_base {
         if(oscillation_timeout_ > 0.0 &&
             last_oscillation_reset_ + ros::Duration(oscillation_timeout_) < ros::Time::now())
         {
+          ROS_DEBUG_NAMED("move_base", "Oscillation detected, direction changes over the last %u commands: x %u, y %u, theta %u",
+                          oscillation_history_.size(), oscillation_history_.reversals(0),
+                          oscillation_history_.reversals(1), oscillation_history_.reversals(2));
           publishZeroVelocity();
-          state_ = CLEARING;
+          setState(CLEARING);
           recovery_trigger_ = OSCILLATION_R;
         }
         
@@ -928,6 +907,8 @@ namespace move_base {
           ROS_DEBUG_NAMED( "move_base", "Got a valid command from the local planner: %.3lf, %.3lf, %.3lf",
                            cmd_vel.linear.x, cmd_vel.linear.y, cmd_vel.angular.z );
           last_valid_control_ = ros::Time::now();
+          oscillation_history_.push(current_pos,
+              Eigen::Vector3f(cmd_vel.linear.x, cmd_vel.linear.y, cmd_vel.angular.z));
           //make sure that we send the velocity command to the base
           vel_pub_.publish(cmd_vel);
           if(recovery_trigger_ == CONTROLLING_R)
@@ -941,13 +922,13 @@ namespace move_base {
           if(ros::Time::now() > attempt_end){
             //we'll move into our obstacle clearing mode
             publishZeroVelocity();
-            state_ = CLEARING;
+            setState(CLEARING);
             recovery_trigger_ = CONTROLLING_R;
           }
           else{
             //otherwise, if we can't find a valid control, we'll go back to planning
             last_valid_plan_ = ros::Time::now();
-            state_ = PLANNING;
+            setState(PLANNING);
             publishZeroVelocity();
 
             //enable the planner thread in case it isn't running on a clock
@@ -974,7 +955,7 @@ namespace move_base {
 
           //we'll check if the recovery behavior actually worked
           ROS_DEBUG_NAMED("move_base_recovery","Going back to planning state");
-          state_ = PLANNING;
+          setState(PLANNING);
 
           //update the index of the next recovery behavior that we'll try
           recovery_index_++;
@@ -1080,6 +1061,9 @@ namespace move_base {
 
             //initialize the recovery behavior with its name
             behavior->initialize(behavior_list[i]["name"], &tf_, planner_costmap_ros_, controller_costmap_ros_);
+            //only hand out the speed limit if the local planner actually reads it
+            if(speed_limit_honored_)
+              behavior->setSpeedLimit(speed_limit_);
             recovery_behaviors_.push_back(behavior);
           }
           catch(pluginlib::PluginlibException& ex){
@@ -1140,8 +1124,33 @@ namespace move_base {
     return;
   }
 
+  void MoveBase::plannerCostmapUpdated(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn){
+    if(getState() != CONTROLLING || !plan_checker_.hasPlan())
+      return;
+
+    int blocked;
+    {
+      costmap_2d::Costmap2D* costmap = planner_costmap_ros_->getCostmap();
+      boost::shared_lock< boost::shared_mutex > lock(*(costmap->getLock()));
+      blocked = plan_checker_.checkWindow(*costmap, x0, xn, y0, yn);
+    }
+    if(blocked < 0)
+      return;
+
+    ROS_DEBUG_NAMED("move_base", "The plan is blocked at pose %d, asking for a new one", blocked);
+    //the next plan handed to the controller re-arms the checker
+    plan_checker_.clear();
+
+    boost::unique_lock<boost::mutex> lock(planner_mutex_);
+    if(getState() == CONTROLLING){
+      runPlanner_ = true;
+      planner_cond_.notify_one();
+    }
+  }
+
   void MoveBase::resetState(){
-    state_ = PLANNING;
+    plan_checker_.clear();
+    setState(PLANNING);
     recovery_index_ = 0;
     recovery_trigger_ = PLANNING_R;
     publishZeroVelocity();
@@ -1153,4 +1162,14 @@ namespace move_base {
       controller_costmap_ros_->stop();
     }
   }
+
+  void MoveBase::setState(MoveBaseState state){
+    boost::mutex::scoped_lock lock(state_mutex_);
+    state_ = state;
+  }
+
+  MoveBaseState MoveBase::getState(){
+    boost::mutex::scoped_lock lock(state_mutex_);
+    return state_;
+  }
 };
@@ -59,6 +59,9 @@ namespace move_slow_and_clear
       /// Run the behavior
       void runBehavior();
 
+      /// Limit the speed through the local planner's speed limit instead of dynamic_reconfigure
+      void setSpeedLimit(const boost::shared_ptr<nav_core::SpeedLimit>& speed_limit);
+
     private:
       void setRobotSpeed(double trans_speed, double rot_speed);
       void distanceCheck(const ros::TimerEvent& e);
@@ -78,6 +81,7 @@ namespace move_slow_and_clear
       boost::mutex mutex_;
       bool limit_set_;
       ros::ServiceClient planner_dynamic_reconfigure_service_;
+      boost::shared_ptr<nav_core::SpeedLimit> speed_limit_;
   };
 };
 
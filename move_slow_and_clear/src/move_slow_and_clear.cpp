@@ -130,7 +130,8 @@ namespace move_slow_and_clear
     boost::mutex::scoped_lock l(mutex_);
 
     //get the old maximum speed for the robot... we'll want to set it back
-    if(!limit_set_)
+    //(not needed with a speed limit, clearing it restores the configured speeds)
+    if(!limit_set_ && !speed_limit_)
     {
       if(!planner_nh_.getParam("max_trans_vel", old_trans_speed_))
       {
@@ -165,11 +166,24 @@ namespace move_slow_and_clear
     return (x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1);
   }
 
+  void MoveSlowAndClear::setSpeedLimit(const boost::shared_ptr<nav_core::SpeedLimit>& speed_limit)
+  {
+    speed_limit_ = speed_limit;
+  }
+
   void MoveSlowAndClear::distanceCheck(const ros::TimerEvent& e)
   {
     if(limited_distance_ * limited_distance_ <= getSqDistance())
     {
       ROS_INFO("Moved far enough, removing speed limit.");
+      if(speed_limit_)
+      {
+        //setting the limit is cheap and non-blocking, so there is no need for a separate thread
+        removeSpeedLimit();
+        distance_check_timer_.stop();
+        return;
+      }
+
       //have to do this because a system call within a timer cb does not seem to play nice
       if(remove_limit_thread_)
       {
@@ -185,12 +199,24 @@ namespace move_slow_and_clear
   void MoveSlowAndClear::removeSpeedLimit()
   {
     boost::mutex::scoped_lock l(mutex_);
-    setRobotSpeed(old_trans_speed_, old_rot_speed_);
+    if(speed_limit_)
+    {
+      speed_limit_->clear(nav_core::SpeedLimit::RECOVERY);
+      ROS_INFO("Recovery removed its speed limit");
+    }
+    else
+      setRobotSpeed(old_trans_speed_, old_rot_speed_);
     limit_set_ = false;
   }
 
   void MoveSlowAndClear::setRobotSpeed(double trans_speed, double rot_speed)
   {
+    if(speed_limit_)
+    {
+      speed_limit_->set(nav_core::SpeedLimit::RECOVERY, trans_speed, rot_speed);
+      ROS_INFO("Recovery limiting speed to trans vel: %.2f, rot vel: %.2f", trans_speed, rot_speed);
+      return;
+    }
 
     {
       dynamic_reconfigure::Reconfigure vel_reconfigure;
@@ -41,6 +41,8 @@
 #include <geometry_msgs/Twist.h>
 #include <costmap_2d/costmap_2d_ros.h>
 #include <tf/transform_listener.h>
+#include <nav_core/speed_limit.h>
+#include <boost/shared_ptr.hpp>
 
 namespace nav_core {
   /**
@@ -77,6 +79,16 @@ namespace nav_core {
        */
       virtual void initialize(std::string name, tf::TransformListener* tf, costmap_2d::Costmap2DROS* costmap_ros) = 0;
 
+      /**
+       * @brief  Give the planner a speed limit that it reads on every cycle, so that limit sources
+       * can slow the robot down without reconfiguring the planner
+       * @param speed_limit The shared limit, may be set from any thread
+       * @return True if the planner honors the limit, false if it ignores it (the default)
+       */
+      virtual bool setSpeedLimit(const boost::shared_ptr<const SpeedLimit>& speed_limit){
+        return false;
+      }
+
       /**
        * @brief  Virtual destructor for the interface
        */
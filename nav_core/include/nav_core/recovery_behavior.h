@@ -38,6 +38,8 @@
 #define NAV_CORE_RECOVERY_BEHAVIOR_H_
 #include <costmap_2d/costmap_2d_ros.h>
 #include <tf/transform_listener.h>
+#include <nav_core/speed_limit.h>
+#include <boost/shared_ptr.hpp>
 
 namespace nav_core {
   /**
@@ -59,6 +61,13 @@ namespace nav_core {
        */
       virtual void runBehavior() = 0;
 
+      /**
+       * @brief  Called after initialize() with the speed limit the local planner honors.
+       * Behaviors that slow the robot down can set it instead of reconfiguring the planner.
+       * @param speed_limit The shared limit
+       */
+      virtual void setSpeedLimit(const boost::shared_ptr<SpeedLimit>& speed_limit) {}
+
       /**
        * @brief  Virtual destructor for the interface
        */
@@ -0,0 +1,128 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2009, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef NAV_CORE_SPEED_LIMIT_H_
+#define NAV_CORE_SPEED_LIMIT_H_
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace nav_core {
+  /**
+   * @class SpeedLimit
+   * @brief A cap on the robot's translational and rotational speed that several sources
+   * (recovery behaviors, speed zones, ...) can set from any thread without locking.
+   * Local planners read the combined limit every cycle; it is the minimum over all sources.
+   */
+  class SpeedLimit{
+    public:
+      enum Source {
+        RECOVERY = 0,
+        SPEED_ZONE,
+        EXTERNAL,
+        NUM_SOURCES
+      };
+
+      SpeedLimit(){
+        for(unsigned int i = 0; i < NUM_SOURCES; ++i)
+          limits_[i].store(pack(unlimited(), unlimited()));
+      }
+
+      /**
+       * @brief  Set the limit imposed by one source, replacing its previous one
+       * @param max_trans_vel The maximum translational speed, or a value <= 0 for no limit
+       * @param max_rot_vel The maximum rotational speed, or a value <= 0 for no limit
+       */
+      void set(Source source, double max_trans_vel, double max_rot_vel){
+        limits_[source].store(pack(max_trans_vel > 0 ? max_trans_vel : unlimited(),
+                                   max_rot_vel > 0 ? max_rot_vel : unlimited()), boost::memory_order_release);
+      }
+
+      /**
+       * @brief  Remove the limit imposed by one source
+       */
+      void clear(Source source){
+        set(source, 0.0, 0.0);
+      }
+
+      /**
+       * @brief  Get the combined limit of all sources
+       * @param max_trans_vel Set to the translational limit, left alone if there is none
+       * @param max_rot_vel Set to the rotational limit, left alone if there is none
+       * @return True if any source currently limits the speed
+       */
+      bool get(double& max_trans_vel, double& max_rot_vel) const {
+        float trans = unlimited(), rot = unlimited();
+        for(unsigned int i = 0; i < NUM_SOURCES; ++i){
+          float source_trans, source_rot;
+          unpack(limits_[i].load(boost::memory_order_acquire), source_trans, source_rot);
+          trans = std::min(trans, source_trans);
+          rot = std::min(rot, source_rot);
+        }
+        if(trans != unlimited())
+          max_trans_vel = trans;
+        if(rot != unlimited())
+          max_rot_vel = rot;
+        return trans != unlimited() || rot != unlimited();
+      }
+
+    private:
+      static float unlimited(){
+        return std::numeric_limits<float>::max();
+      }
+
+      // both limits of a source live in one word so that readers never see half an update
+      static boost::uint64_t pack(float trans, float rot){
+        boost::uint32_t words[2];
+        std::memcpy(&words[0], &trans, sizeof(float));
+        std::memcpy(&words[1], &rot, sizeof(float));
+        return (static_cast<boost::uint64_t>(words[0]) << 32) | words[1];
+      }
+
+      static void unpack(boost::uint64_t packed, float& trans, float& rot){
+        boost::uint32_t words[2] = { static_cast<boost::uint32_t>(packed >> 32), static_cast<boost::uint32_t>(packed) };
+        std::memcpy(&trans, &words[0], sizeof(float));
+        std::memcpy(&rot, &words[1], sizeof(float));
+      }
+
+      SpeedLimit(const SpeedLimit&);
+      SpeedLimit& operator=(const SpeedLimit&);
+
+      boost::atomic<boost::uint64_t> limits_[NUM_SOURCES];
+  };
+};
+#endif
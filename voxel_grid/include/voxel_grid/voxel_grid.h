@@ -108,6 +108,24 @@ namespace voxel_grid {
         return !bitsBelowThreshold(marked_bits, marked_threshold);
       }
 
+      /**
+       * @brief  Same as markVoxelInMap, but several threads may mark at once, as long as
+       * nothing clears voxels meanwhile: the column word is or-ed atomically, so the
+       * result for a column does not depend on the order of the marks
+       */
+      inline bool markVoxelInMapAtomic(unsigned int x, unsigned int y, unsigned int z, unsigned int marked_threshold){
+        if(x >= size_x_ || y >= size_y_ || z >= size_z_){
+          ROS_DEBUG("Error, voxel out of bounds.\n");
+          return false;
+        }
+
+        uint32_t full_mask = ((uint32_t)1<<z<<16) | (1<<z);
+        uint32_t col = __sync_or_and_fetch(&data_[y * size_x_ + x], full_mask);
+
+        unsigned int marked_bits = col>>16;
+        return !bitsBelowThreshold(marked_bits, marked_threshold);
+      }
+
       inline void clearVoxel(unsigned int x, unsigned int y, unsigned int z){
         if(x >= size_x_ || y >= size_y_ || z >= size_z_){
           ROS_DEBUG("Error, voxel out of bounds.\n");
@@ -122,6 +140,11 @@ namespace voxel_grid {
         data_[index] = 0;
       }
 
+      inline void resetVoxelColumn(unsigned int index){
+        ROS_ASSERT(index < size_x_ * size_y_);
+        data_[index] = ~((uint32_t)0)>>16; //every voxel back to unknown, as after reset()
+      }
+
       inline void clearVoxelInMap(unsigned int x, unsigned int y, unsigned int z){
         if(x >= size_x_ || y >= size_y_ || z >= size_z_){
           ROS_DEBUG("Error, voxel out of bounds.\n");
@@ -152,12 +175,23 @@ namespace voxel_grid {
       }
 
       static inline unsigned int numBits(unsigned int n){
-        unsigned int bit_count;
-        for(bit_count = 0; n; ++bit_count){
-          n &= n - 1; //clear the least significant bit set
-        }
-        return bit_count;
+        return bit_count_[n & 0xff] + bit_count_[(n >> 8) & 0xff] + bit_count_[(n >> 16) & 0xff] + bit_count_[n >> 24];
+      }
 
+      /**
+       * @brief  The state of the column at a cell index, using a table lookup for the bit counts
+       * instead of walking the bits, so it is cheap enough to call on every dirty column
+       */
+      inline VoxelStatus getColumnStatus(unsigned int index, unsigned int unknown_threshold, unsigned int marked_threshold){
+        uint32_t col = data_[index];
+        unsigned int marked_bits = col>>16;
+        unsigned int unknown_bits = uint16_t(col>>16) ^ uint16_t(col);
+
+        if(bit_count_[marked_bits & 0xff] + bit_count_[marked_bits >> 8] > marked_threshold)
+          return MARKED;
+        if(bit_count_[unknown_bits & 0xff] + bit_count_[unknown_bits >> 8] > unknown_threshold)
+          return UNKNOWN;
+        return FREE;
       }
 
       static VoxelStatus getVoxel(unsigned int x, unsigned int y, unsigned int z,
@@ -188,6 +222,14 @@ namespace voxel_grid {
           unsigned int unknown_threshold, unsigned int mark_threshold, 
           unsigned char free_cost = 0, unsigned char unknown_cost = 255, unsigned int max_length = UINT_MAX);
 
+      /**
+       * @brief  Clears the voxels along a line and sets the bit of every column it passes in
+       * dirty_columns (one bit per cell index, 32 to a word), so the caller can project only
+       * those columns into its 2D map once it is done with all of its lines
+       */
+      void clearVoxelLineInMask(double x0, double y0, double z0, double x1, double y1, double z1, uint32_t *dirty_columns,
+          unsigned int max_length = UINT_MAX);
+
       VoxelStatus getVoxel(unsigned int x, unsigned int y, unsigned int z);
       VoxelStatus getVoxelColumn(unsigned int x, unsigned int y,
           unsigned int unknown_threshold = 0, unsigned int marked_threshold = 0); //Are there any obstacles at that (x, y) location in the grid?
@@ -284,6 +326,8 @@ namespace voxel_grid {
         return x > y ? x : y;
       }
 
+      static const unsigned char bit_count_[256];
+
       unsigned int size_x_, size_y_, size_z_;
       uint32_t *data_;
       unsigned char *costmap;
@@ -309,6 +353,18 @@ namespace voxel_grid {
           uint32_t* data_;
       };
 
+      class ClearVoxelInMask {
+        public:
+          ClearVoxelInMask(uint32_t* data, uint32_t* dirty_columns): data_(data), dirty_columns_(dirty_columns){}
+          inline void operator()(unsigned int offset, unsigned int z_mask){
+            data_[offset] &= ~(z_mask); //clear unknown and clear cell
+            dirty_columns_[offset >> 5] |= (uint32_t)1 << (offset & 31);
+          }
+        private:
+          uint32_t* data_;
+          uint32_t* dirty_columns_;
+      };
+
       class ClearVoxelInMap {
         public:
           ClearVoxelInMap(uint32_t* data, unsigned char *costmap,
@@ -39,6 +39,17 @@
 #include <ros/console.h>
 
 namespace voxel_grid {
+  //number of set bits in every byte value
+  const unsigned char VoxelGrid::bit_count_[256] = {
+#define B2(n) n, n + 1, n + 1, n + 2
+#define B4(n) B2(n), B2(n + 1), B2(n + 1), B2(n + 2)
+#define B6(n) B4(n), B4(n + 1), B4(n + 1), B4(n + 2)
+    B6(0), B6(1), B6(1), B6(2)
+#undef B6
+#undef B4
+#undef B2
+  };
+
   VoxelGrid::VoxelGrid(unsigned int size_x, unsigned int size_y, unsigned int size_z)
   {
     size_x_ = size_x; 
@@ -140,6 +151,18 @@ namespace voxel_grid {
     raytraceLine(cvm, x0, y0, z0, x1, y1, z1, max_length);
   }
 
+  void VoxelGrid::clearVoxelLineInMask(double x0, double y0, double z0, double x1, double y1, double z1, uint32_t *dirty_columns,
+      unsigned int max_length){
+    if(x0 >= size_x_ || y0 >= size_y_ || z0 >= size_z_ || x1>=size_x_ || y1>=size_y_ || z1>=size_z_){
+      ROS_DEBUG("Error, line endpoint out of bounds. (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f),  size: (%d, %d, %d)", x0, y0, z0, x1, y1, z1, 
+          size_x_, size_y_, size_z_);
+      return;
+    }
+
+    ClearVoxelInMask cvm(data_, dirty_columns);
+    raytraceLine(cvm, x0, y0, z0, x1, y1, z1, max_length);
+  }
+
   VoxelStatus VoxelGrid::getVoxel(unsigned int x, unsigned int y, unsigned int z)
   {
     if(x >= size_x_ || y >= size_y_ || z >= size_z_){
@@ -36,6 +36,8 @@
 *********************************************************************/
 #include <voxel_grid/voxel_grid.h>
 #include <gtest/gtest.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 TEST(voxel_grid, basicMarkingAndClearing){
   int size_x = 50, size_y = 10, size_z = 16;
@@ -129,6 +131,65 @@ TEST(voxel_grid, basicMarkingAndClearing){
 
 }
 
+static void markStripes(voxel_grid::VoxelGrid* vg, unsigned int first, unsigned int step, unsigned int* marked){
+  //every thread marks a different height in every column
+  for(unsigned int z = first; z < vg->sizeZ(); z += step){
+    for(unsigned int y = 0; y < vg->sizeY(); ++y){
+      for(unsigned int x = 0; x < vg->sizeX(); ++x){
+        if(vg->markVoxelInMapAtomic(x, y, z, 3))
+          ++*marked;
+      }
+    }
+  }
+}
+
+TEST(voxel_grid, concurrentMarking){
+  voxel_grid::VoxelGrid vg(64, 64, 16);
+  unsigned int marked[4] = {0, 0, 0, 0};
+  boost::thread_group workers;
+  for(unsigned int t = 0; t < 4; ++t)
+    workers.create_thread(boost::bind(&markStripes, &vg, t, 4, &marked[t]));
+  workers.join_all();
+
+  //no mark may get lost, and the last of the 16 marks in a column always sees it above the threshold
+  for(unsigned int y = 0; y < vg.sizeY(); ++y){
+    for(unsigned int x = 0; x < vg.sizeX(); ++x){
+      for(unsigned int z = 0; z < vg.sizeZ(); ++z)
+        ASSERT_EQ(voxel_grid::MARKED, vg.getVoxel(x, y, z));
+    }
+  }
+  EXPECT_GE(marked[0] + marked[1] + marked[2] + marked[3], vg.sizeX() * vg.sizeY());
+}
+
+TEST(voxel_grid, clearingMarksDirtyColumns){
+  voxel_grid::VoxelGrid vg(40, 10, 16);
+  for(unsigned int z = 0; z < vg.sizeZ(); ++z)
+    vg.markVoxel(20, 5, z);
+  EXPECT_EQ(voxel_grid::MARKED, vg.getColumnStatus(5 * 40 + 20, 0, 0));
+
+  std::vector<uint32_t> dirty((vg.sizeX() * vg.sizeY() + 31) / 32, 0);
+  vg.clearVoxelLineInMask(0.5, 5.5, 3.5, 30.5, 5.5, 3.5, &dirty[0]);
+
+  //exactly the columns along the line are dirty
+  for(unsigned int y = 0; y < vg.sizeY(); ++y){
+    for(unsigned int x = 0; x < vg.sizeX(); ++x){
+      unsigned int index = y * vg.sizeX() + x;
+      bool is_dirty = (dirty[index >> 5] >> (index & 31)) & 1;
+      EXPECT_EQ(y == 5 && x <= 30, is_dirty);
+    }
+  }
+
+  //the table lookup agrees with the column query for the thresholds the layers use
+  for(unsigned int unknown_threshold = 0; unknown_threshold <= 16; unknown_threshold += 4){
+    for(unsigned int marked_threshold = 0; marked_threshold <= 16; marked_threshold += 4){
+      for(unsigned int x = 0; x < vg.sizeX(); ++x)
+        EXPECT_EQ(vg.getVoxelColumn(x, 5, unknown_threshold, marked_threshold),
+            vg.getColumnStatus(5 * vg.sizeX() + x, unknown_threshold, marked_threshold));
+    }
+  }
+  EXPECT_EQ(12u, voxel_grid::VoxelGrid::numBits(0x8000ff0e));
+}
+
 int main(int argc, char** argv){
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();